@@ -0,0 +1,489 @@
+/*
+ *  Exact undetected error probability from the weight distribution.
+ *
+ *  The shortened code of CW_BITS bits has 2^(CW_BITS - CRC) codewords, but its
+ *  dual has only 2^CRC, so the weight distribution is computed exactly:
+ *
+ *    1) The dual codewords are enumerated in Gray-code order over the CRC rows
+ *       of the parity-check matrix, so each one costs an XOR of one row and a
+ *       popcount of ROW_WORDS words. Work items of 2^ANALYZE_GRAY_BITS codewords
+ *       are handed out to worker threads.
+ *    2) The weight distribution A_i of the code follows from the MacWilliams
+ *       identity, A_i = 2^-CRC * sum_w B_w * K_i(w), with the Krawtchouk
+ *       polynomials K_i evaluated in exact big integer arithmetic.
+ *    3) P_ud(p) = sum_i A_i * p^i * (1-p)^(n-i) for a binary symmetric channel.
+ *
+ *  NOTE : Every term of P_ud is positive, so the sum stays accurate at low BER,
+ *         unlike the dual form 2^-CRC * sum_w B_w * (1-2p)^w - (1-p)^n.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "analyze.h"
+
+#define NUM_DUAL_HIST 4         // interleaved histograms, so equal weights in a row do not serialize
+
+typedef struct {
+    uint64_t rows[CRC][ROW_WORDS];  // row j: bit j of the syndrome of every codeword bit
+    uint64_t numItem;
+    uint64_t nextItem;              // shared work counter (atomic)
+} AnalyzeContext;
+
+typedef struct {
+    AnalyzeContext *context;
+    uint64_t dualWeight[NUM_DUAL_HIST][CW_BITS + 1];
+} __attribute__((aligned(64))) AnalyzeWorker;
+
+/*
+ *  Function to get analysis settings from program input arguments.
+ */
+void getAnalyzeConfig(int argc, char *argv[], AnalyzeConfig *config)
+{
+    config->berFrom = ANALYZE_BER_FROM;
+    config->berTo = ANALYZE_BER_TO;
+    config->numPoint = ANALYZE_POINTS;
+    config->numWeight = ANALYZE_WEIGHTS;
+    config->numThreads = 1;
+
+    for (int argIdx = 2; argIdx < argc; ++argIdx) {
+        if (strcmp(argv[argIdx], "--ber-from") == 0) {
+            config->berFrom = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--ber-to") == 0) {
+            config->berTo = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--points") == 0) {
+            config->numPoint = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--weights") == 0) {
+            config->numWeight = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else {
+            exitUnknownOption(argv, argIdx);
+        }
+    }
+
+    if (config->berFrom <= 0.0 || config->berTo > 0.5 || config->berFrom > config->berTo) {
+        printf("Bit error rates must satisfy 0 < from <= to <= 0.5: %g, %g\n", config->berFrom, config->berTo);
+        exit(EXIT_FAILURE);
+    }
+    if (config->numPoint == 0) {
+        config->numPoint = 1;
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+}
+
+/*
+ *  Functions of big integer arithmetic (modulo 2^(64 * BIG_LIMBS)).
+ */
+static void setBigInt(BigInt *value, int64_t small)
+{
+    for (int limbIdx = 0; limbIdx < BIG_LIMBS; ++limbIdx) {
+        value->limb[limbIdx] = small < 0 ? ~(uint64_t)0 : 0;
+    }
+    value->limb[0] = (uint64_t)small;
+}
+
+static bool isBigNegative(const BigInt *value)
+{
+    return value->limb[BIG_LIMBS - 1] >> 63;
+}
+
+static void addBigInt(BigInt *dst, const BigInt *src)
+{
+    unsigned __int128 carry = 0;
+
+    for (int limbIdx = 0; limbIdx < BIG_LIMBS; ++limbIdx) {
+        carry += (unsigned __int128)dst->limb[limbIdx] + src->limb[limbIdx];
+        dst->limb[limbIdx] = (uint64_t)carry;
+        carry >>= 64;
+    }
+}
+
+static void negateBigInt(BigInt *value)
+{
+    BigInt one;
+
+    for (int limbIdx = 0; limbIdx < BIG_LIMBS; ++limbIdx) {
+        value->limb[limbIdx] = ~value->limb[limbIdx];
+    }
+    setBigInt(&one, 1);
+    addBigInt(value, &one);
+}
+
+static void mulBigInt(BigInt *value, uint64_t factor)
+{
+    unsigned __int128 carry = 0;
+
+    for (int limbIdx = 0; limbIdx < BIG_LIMBS; ++limbIdx) {
+        carry += (unsigned __int128)value->limb[limbIdx] * factor;
+        value->limb[limbIdx] = (uint64_t)carry;
+        carry >>= 64;
+    }
+}
+
+/*
+ *  Function to divide a big integer by a positive divisor.
+ *
+ *  NOTE : Only exact divisions are used, so the sign is handled by negation.
+ */
+static void divBigInt(BigInt *value, uint64_t divisor)
+{
+    bool negative = isBigNegative(value);
+    unsigned __int128 remainder = 0;
+
+    if (negative) {
+        negateBigInt(value);
+    }
+    for (int limbIdx = BIG_LIMBS - 1; limbIdx >= 0; --limbIdx) {
+        remainder = (remainder << 64) | value->limb[limbIdx];
+        value->limb[limbIdx] = (uint64_t)(remainder / divisor);
+        remainder %= divisor;
+    }
+    if (negative) {
+        negateBigInt(value);
+    }
+}
+
+static bool isBigEqual(const BigInt *value1, const BigInt *value2)
+{
+    return memcmp(value1->limb, value2->limb, sizeof(value1->limb)) == 0;
+}
+
+/*
+ *  Function to convert a non-negative big integer to double.
+ */
+static double getBigDouble(const BigInt *value)
+{
+    double result = 0.0;
+
+    for (int limbIdx = BIG_LIMBS - 1; limbIdx >= 0; --limbIdx) {
+        result = result * 18446744073709551616.0 + (double)value->limb[limbIdx];
+    }
+
+    return result;
+}
+
+/*
+ *  Function to print a non-negative big integer in decimal.
+ */
+static void printBigInt(const BigInt *value, int width)
+{
+    char digits[BIG_LIMBS * 20 + 1];
+    int numDigit = 0;
+    BigInt rest = *value;
+    BigInt zero;
+
+    setBigInt(&zero, 0);
+    do {
+        // The lowest 19 digits are the remainder of a division by 10^19.
+        BigInt quotient = rest;
+        divBigInt(&quotient, 10000000000000000000ull);
+
+        BigInt product = quotient;
+        mulBigInt(&product, 10000000000000000000ull);
+        negateBigInt(&product);
+        addBigInt(&rest, &product);
+
+        uint64_t chunk = rest.limb[0];
+        rest = quotient;
+        for (int digitIdx = 0; digitIdx < 19 && (chunk > 0 || !isBigEqual(&rest, &zero)); ++digitIdx) {
+            digits[numDigit++] = (char)('0' + chunk % 10);
+            chunk /= 10;
+        }
+    } while (!isBigEqual(&rest, &zero));
+
+    if (numDigit == 0) {
+        digits[numDigit++] = '0';
+    }
+    printf("%*s", width > numDigit ? width - numDigit : 0, "");
+    while (numDigit > 0) {
+        putchar(digits[--numDigit]);
+    }
+}
+
+/*
+ *  Function to enumerate the dual codewords of a work item in Gray-code order.
+ */
+static inline __attribute__((always_inline)) void countDualItem(const AnalyzeContext *context, uint64_t itemIdx,
+    uint64_t (*dualWeight)[CW_BITS + 1])
+{
+    uint64_t codeword[ROW_WORDS] = {0};
+    uint64_t first = itemIdx << ANALYZE_GRAY_BITS;
+
+    // The first codeword is the sum of the rows of the high message bits.
+    for (unsigned int rowIdx = ANALYZE_GRAY_BITS; rowIdx < CRC; ++rowIdx) {
+        if ((first >> rowIdx) & 1) {
+            for (unsigned int wordIdx = 0; wordIdx < ROW_WORDS; ++wordIdx) {
+                codeword[wordIdx] ^= context->rows[rowIdx][wordIdx];
+            }
+        }
+    }
+
+    for (uint64_t grayIdx = 0; grayIdx < ((uint64_t)1 << ANALYZE_GRAY_BITS); ++grayIdx) {
+        unsigned int weight = 0;
+
+        // The next codeword in Gray order differs by the row of the lowest set bit of grayIdx.
+        if (grayIdx > 0) {
+            const uint64_t *row = context->rows[__builtin_ctzll(grayIdx)];
+
+            for (unsigned int wordIdx = 0; wordIdx < ROW_WORDS; ++wordIdx) {
+                codeword[wordIdx] ^= row[wordIdx];
+            }
+        }
+        for (unsigned int wordIdx = 0; wordIdx < ROW_WORDS; ++wordIdx) {
+            weight += __builtin_popcountll(codeword[wordIdx]);
+        }
+        dualWeight[grayIdx % NUM_DUAL_HIST][weight]++;
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("popcnt")))
+static void countDualItemPopcnt(const AnalyzeContext *context, uint64_t itemIdx, uint64_t (*dualWeight)[CW_BITS + 1])
+{
+    countDualItem(context, itemIdx, dualWeight);
+}
+#endif
+
+static void countDualItemPortable(const AnalyzeContext *context, uint64_t itemIdx, uint64_t (*dualWeight)[CW_BITS + 1])
+{
+    countDualItem(context, itemIdx, dualWeight);
+}
+
+/*
+ *  Worker thread function. Work items are taken from the shared counter.
+ */
+static void *analyzeWorker(void *arg)
+{
+    AnalyzeWorker *worker = (AnalyzeWorker *)arg;
+    AnalyzeContext *context = worker->context;
+#if defined(__x86_64__)
+    bool usePopcnt = __builtin_cpu_supports("popcnt");
+#else
+    bool usePopcnt = false;
+#endif
+
+    while (true) {
+        uint64_t itemIdx = __atomic_fetch_add(&context->nextItem, 1, __ATOMIC_RELAXED);
+        if (itemIdx >= context->numItem) {
+            break;
+        }
+
+#if defined(__x86_64__)
+        if (usePopcnt) {
+            countDualItemPopcnt(context, itemIdx, worker->dualWeight);
+            continue;
+        }
+#endif
+        (void)usePopcnt;
+        countDualItemPortable(context, itemIdx, worker->dualWeight);
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to count the dual codewords of each weight.
+ *
+ *  NOTE : Bit j of the syndrome of a codeword bit is its coefficient in row j
+ *         of the parity-check matrix, and the dual code is the row space.
+ */
+void countDualWeights(const SyndromeTable *table, unsigned int numThreads, uint64_t *dualWeight)
+{
+    AnalyzeContext *context = (AnalyzeContext *)calloc(1, sizeof(AnalyzeContext));
+    AnalyzeWorker *workers = (AnalyzeWorker *)aligned_alloc(64, numThreads * sizeof(AnalyzeWorker));
+    pthread_t *threads = (pthread_t *)calloc(numThreads, sizeof(pthread_t));
+
+    if (context == NULL || workers == NULL || threads == NULL) {
+        printf("Unable to allocate %u workers\n", numThreads);
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int rowIdx = 0; rowIdx < CRC; ++rowIdx) {
+        for (unsigned int pos = 0; pos < CW_BITS; ++pos) {
+            if ((table->bitSyndrome[pos] >> rowIdx) & 1) {
+                context->rows[rowIdx][pos / 64] |= (uint64_t)1 << (pos % 64);
+            }
+        }
+    }
+    context->numItem = (uint64_t)1 << (CRC - ANALYZE_GRAY_BITS);
+
+    for (unsigned int threadIdx = 0; threadIdx < numThreads; ++threadIdx) {
+        memset(&workers[threadIdx], 0, sizeof(AnalyzeWorker));
+        workers[threadIdx].context = context;
+
+        if (pthread_create(&threads[threadIdx], NULL, analyzeWorker, &workers[threadIdx]) != 0) {
+            printf("Unable to create thread %u\n", threadIdx);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memset(dualWeight, 0, (CW_BITS + 1) * sizeof(uint64_t));
+    for (unsigned int threadIdx = 0; threadIdx < numThreads; ++threadIdx) {
+        pthread_join(threads[threadIdx], NULL);
+
+        for (unsigned int histIdx = 0; histIdx < NUM_DUAL_HIST; ++histIdx) {
+            for (unsigned int weight = 0; weight <= CW_BITS; ++weight) {
+                dualWeight[weight] += workers[threadIdx].dualWeight[histIdx][weight];
+            }
+        }
+    }
+
+    free(threads);
+    free(workers);
+    free(context);
+}
+
+/*
+ *  Function to get the weight distribution of the code from that of its dual (MacWilliams identity).
+ *
+ *  NOTE : K_0(w) = 1, K_1(w) = n - 2w, and (i+1) K_{i+1}(w) = (n - 2w) K_i(w) - (n - i + 1) K_{i-1}(w).
+ *         The division is exact, so every K_i(w) is an exact integer.
+ */
+void getCodeWeights(const uint64_t *dualWeight, BigInt *codeWeight)
+{
+    const int n = CW_BITS;
+
+    for (int weight = 0; weight <= n; ++weight) {
+        setBigInt(&codeWeight[weight], 0);
+    }
+
+    for (int dual = 0; dual <= n; ++dual) {
+        BigInt prev, curr;
+
+        if (dualWeight[dual] == 0) {
+            continue;
+        }
+
+        setBigInt(&prev, 0);
+        setBigInt(&curr, 1);
+        for (int weight = 0; weight <= n; ++weight) {
+            BigInt term = curr;
+            BigInt next = curr;
+            BigInt prevTerm = prev;
+
+            mulBigInt(&term, dualWeight[dual]);
+            addBigInt(&codeWeight[weight], &term);
+
+            // K_{weight+1} from K_weight and K_{weight-1}, with the signs of the factors applied by negation.
+            mulBigInt(&next, (uint64_t)(n - 2 * dual >= 0 ? n - 2 * dual : 2 * dual - n));
+            if (n - 2 * dual < 0) {
+                negateBigInt(&next);
+            }
+            mulBigInt(&prevTerm, (uint64_t)(n - weight + 1));
+            negateBigInt(&prevTerm);
+            addBigInt(&next, &prevTerm);
+            divBigInt(&next, (uint64_t)(weight + 1));
+
+            prev = curr;
+            curr = next;
+        }
+    }
+
+    // The sum is 2^CRC times the distribution.
+    for (int weight = 0; weight <= n; ++weight) {
+        divBigInt(&codeWeight[weight], (uint64_t)1 << CRC);
+    }
+}
+
+/*
+ *  Function to get the probability of an undetected error over a binary symmetric channel.
+ */
+double getUndetectedProb(const BigInt *codeWeight, double ber)
+{
+    double prob = 0.0;
+
+    for (int weight = 1; weight <= CW_BITS; ++weight) {
+        double count = getBigDouble(&codeWeight[weight]);
+
+        if (count > 0.0) {
+            prob += exp(log(count) + weight * log(ber) + (CW_BITS - weight) * log1p(-ber));
+        }
+    }
+
+    return prob;
+}
+
+/*
+ *  Function to compute the weight distributions and print P_ud over a range of bit error rates.
+ */
+void analyze(const AnalyzeConfig *config)
+{
+    WeightDist *dist = (WeightDist *)calloc(1, sizeof(WeightDist));
+    struct timespec startTime, endTime;
+    BigInt total, expected;
+    unsigned int minDistance = 0;
+
+    if (dist == NULL) {
+        printf("Unable to allocate the weight distribution\n");
+        exit(EXIT_FAILURE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    countDualWeights(&synTable, config->numThreads, dist->dualWeight);
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    getCodeWeights(dist->dualWeight, dist->codeWeight);
+
+    // The code has 2^(n - CRC) codewords, which checks the whole transform.
+    setBigInt(&total, 0);
+    setBigInt(&expected, 1);
+    for (int weight = 0; weight <= CW_BITS; ++weight) {
+        addBigInt(&total, &dist->codeWeight[weight]);
+    }
+    for (int bitIdx = 0; bitIdx < CW_BITS - CRC; ++bitIdx) {
+        mulBigInt(&expected, 2);
+    }
+    if (!isBigEqual(&total, &expected) || dist->dualWeight[0] != 1) {
+        printf("Weight distribution does not sum to 2^%d codewords\n", CW_BITS - CRC);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("##### Weight Distribution #####\n");
+    printf("Polynomial : 0x%08X, Codeword : %d bits, Threads : %u\n", GEN_POLY, CW_BITS, config->numThreads);
+    printf("Dual code  : 2^%d codewords enumerated in %.1f s\n", CRC,
+        (double)(endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) * 1e-9);
+    printf("%-8s %60s %14s\n", "Weight", "Undetected", "Ratio");
+    for (unsigned int weight = 1, numPrinted = 0; weight <= CW_BITS && numPrinted < config->numWeight; ++weight) {
+        double count = getBigDouble(&dist->codeWeight[weight]);
+
+        if (count == 0.0) {
+            continue;
+        }
+        if (minDistance == 0) {
+            minDistance = weight;
+        }
+
+        // Ratio to all C(n, weight) patterns of the weight.
+        double logPatterns = lgamma(CW_BITS + 1.0) - lgamma(weight + 1.0) - lgamma(CW_BITS - weight + 1.0);
+        printf("%-8u ", weight);
+        printBigInt(&dist->codeWeight[weight], 60);
+        printf(" %14.6e\n", exp(log(count) - logPatterns));
+        numPrinted++;
+    }
+    printf("Minimum Hamming distance   : %u\n", minDistance);
+
+    printf("##### Undetected Error Probability #####\n");
+    printf("%-14s %14s\n", "BER", "P_ud");
+    for (unsigned int pointIdx = 0; pointIdx < config->numPoint; ++pointIdx) {
+        double ber = config->numPoint == 1 ? config->berFrom :
+            exp(log(config->berFrom) + log(config->berTo / config->berFrom) * pointIdx / (config->numPoint - 1));
+
+        printf("%-14.6e %14.6e\n", ber, getUndetectedProb(dist->codeWeight, ber));
+    }
+
+    free(dist);
+}
@@ -0,0 +1,47 @@
+#ifndef __ANALYZE_H__
+#define __ANALYZE_H__
+
+#define ANALYZE_BER_FROM 1e-8       // default lowest bit error rate
+#define ANALYZE_BER_TO 1e-1         // default highest bit error rate
+#define ANALYZE_POINTS 8            // default number of bit error rates (log-spaced)
+#define ANALYZE_WEIGHTS 8           // default number of non-zero weights printed
+#define ANALYZE_GRAY_BITS 20        // dual message bits enumerated in Gray order per work item
+#define BIG_LIMBS 10                // 64-bit limbs of an exact count (2^(CW_BITS + 64) fits)
+#define ROW_WORDS ((CW_BITS + 63) / 64)
+
+/*
+ *  Analysis settings given by program input arguments.
+ */
+typedef struct {
+    double berFrom;             // lowest bit error rate                  (--ber-from P)
+    double berTo;               // highest bit error rate                 (--ber-to P)
+    unsigned int numPoint;      // number of bit error rates, log-spaced  (--points N)
+    unsigned int numWeight;     // number of non-zero weights printed     (--weights N)
+    unsigned int numThreads;    // number of worker threads               (--threads N)
+} AnalyzeConfig;
+
+/*
+ *  Signed integer of BIG_LIMBS 64-bit limbs in two's complement, least significant limb first.
+ */
+typedef struct {
+    uint64_t limb[BIG_LIMBS];
+} BigInt;
+
+/*
+ *  Weight distributions of the code and its dual.
+ *
+ *  NOTE : The dual code is spanned by the CRC rows of the parity-check matrix
+ *         (bit j of every bit syndrome), so it has only 2^CRC codewords.
+ */
+typedef struct {
+    uint64_t dualWeight[CW_BITS + 1];   // dual codewords of each weight
+    BigInt codeWeight[CW_BITS + 1];     // codewords (undetected errors) of each weight
+} WeightDist;
+
+void getAnalyzeConfig(int argc, char *argv[], AnalyzeConfig *config);
+void analyze(const AnalyzeConfig *config);
+void countDualWeights(const SyndromeTable *table, unsigned int numThreads, uint64_t *dualWeight);
+void getCodeWeights(const uint64_t *dualWeight, BigInt *codeWeight);
+double getUndetectedProb(const BigInt *codeWeight, double ber);
+
+#endif
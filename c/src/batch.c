@@ -0,0 +1,208 @@
+/*
+ *  Batched CRC calculation of many independent DATA_SIZE lines.
+ *
+ *  A memory controller checks many fixed-size lines at once, and a single CRC over
+ *  one line is bound by the latency of its dependency chain. Two batch methods
+ *  remove that chain:
+ *
+ *    1) Matrix     : the CRC of a line is affine in its bits, so each checksum bit
+ *                    is the parity of (line AND mask) XOR a constant, the same
+ *                    form as CRC_COEFF_TABLE in the table-based RTL.
+ *                    Masks are applied 256 bits at a time with AVX2.
+ *    2) Interleave : 4 lines are folded with carry-less multiplies at once, so the
+ *                    multiplies of different lines overlap (updateCRCBatchClmul()).
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "fold.h"
+#include "syndrome.h"
+#include "batch.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_X86_AVX2 1
+#else
+#define HAVE_X86_AVX2 0
+#endif
+
+CoeffMatrix coeffMatrix;
+
+static bool useAVX2 = false;
+static bool useCLMUL = false;
+
+/*
+ *  Function to generate the coefficient matrix from the syndrome table.
+ *
+ *  NOTE : The syndrome of a data bit is the change of the CRC when the bit flips,
+ *         so checksum bit k depends on the data bits whose syndrome has bit k set.
+ *         genSyndromeTable() must be called before use.
+ */
+void genCoeffMatrix()
+{
+    uint8_t zeroLine[DATA_SIZE] = {0};
+
+    memset(coeffMatrix.mask, 0, sizeof(coeffMatrix.mask));
+
+    for (unsigned int pos = 0; pos < DATA_SIZE * BYTE; ++pos) {
+        unsigned int wordIdx = pos / 64;
+        unsigned int bitIdx = ((pos / BYTE) % 8) * BYTE + (BYTE - 1 - pos % BYTE);  // little-endian word
+
+        for (unsigned int k = 0; k < CRC; ++k) {
+            if ((synTable.bitSyndrome[pos] >> k) & 1) {
+                coeffMatrix.mask[k][wordIdx] |= (uint64_t)1 << bitIdx;
+            }
+        }
+    }
+
+    coeffMatrix.offset = calcCRCBitwise(zeroLine, DATA_SIZE);
+
+#if HAVE_X86_AVX2
+    __builtin_cpu_init();
+    useAVX2 = __builtin_cpu_supports("avx2") && DATA_SIZE % 32 == 0;
+#endif
+    useCLMUL = hasCLMUL();
+}
+
+/*
+ *  Function to get the name of a batch method.
+ */
+const char *getBatchMethodName(BatchMethod method)
+{
+    switch (method) {
+        case BATCH_SERIAL     : return "serial";
+        case BATCH_MATRIX     : return "matrix";
+        case BATCH_INTERLEAVE : return "interleave";
+        case BATCH_AUTO       : return "auto";
+        default               : return "unknown";
+    }
+}
+
+/*
+ *  Function to calculate the CRC of a line with the coefficient matrix (portable).
+ */
+static uint32_t calcCRCMatrix(const uint8_t *line)
+{
+    uint64_t words[MATRIX_WORDS];
+    uint32_t checksum = 0;
+
+    memcpy(words, line, DATA_SIZE);
+
+    for (unsigned int k = 0; k < CRC; ++k) {
+        uint64_t acc = 0;
+
+        for (unsigned int wordIdx = 0; wordIdx < MATRIX_WORDS; ++wordIdx) {
+            acc ^= words[wordIdx] & coeffMatrix.mask[k][wordIdx];
+        }
+        checksum |= (uint32_t)__builtin_parityll(acc) << k;
+    }
+
+    return checksum ^ coeffMatrix.offset;
+}
+
+#if HAVE_X86_AVX2
+
+/*
+ *  Function to calculate the CRC of a line with the coefficient matrix (AVX2).
+ *
+ *  NOTE : Four checksum bits are reduced together: the four 256-bit products are
+ *         XOR-folded into one 64-bit word each, and the parity of every word
+ *         is moved to its sign bit for a single movemask.
+ */
+__attribute__((target("avx2")))
+static uint32_t calcCRCMatrixAVX2(const uint8_t *line)
+{
+    __m256i data[MATRIX_WORDS / 4];
+    uint32_t checksum = 0;
+
+    for (unsigned int vecIdx = 0; vecIdx < MATRIX_WORDS / 4; ++vecIdx) {
+        data[vecIdx] = _mm256_loadu_si256((const __m256i *)(line + 32 * vecIdx));
+    }
+
+    for (unsigned int k = 0; k < CRC; k += 4) {
+        __m256i product[4];
+
+        for (unsigned int j = 0; j < 4; ++j) {
+            product[j] = _mm256_setzero_si256();
+            for (unsigned int vecIdx = 0; vecIdx < MATRIX_WORDS / 4; ++vecIdx) {
+                __m256i mask = _mm256_load_si256((const __m256i *)&coeffMatrix.mask[k + j][4 * vecIdx]);
+                product[j] = _mm256_xor_si256(product[j], _mm256_and_si256(data[vecIdx], mask));
+            }
+        }
+
+        // Fold 4 x 4 words into words {p0, p1, p2, p3}.
+        __m256i pair01 = _mm256_xor_si256(_mm256_unpacklo_epi64(product[0], product[1]),
+                                          _mm256_unpackhi_epi64(product[0], product[1]));
+        __m256i pair23 = _mm256_xor_si256(_mm256_unpacklo_epi64(product[2], product[3]),
+                                          _mm256_unpackhi_epi64(product[2], product[3]));
+        __m256i folded = _mm256_xor_si256(_mm256_permute2x128_si256(pair01, pair23, 0x20),
+                                          _mm256_permute2x128_si256(pair01, pair23, 0x31));
+
+        for (int shift = 32; shift > 0; shift >>= 1) {
+            folded = _mm256_xor_si256(folded, _mm256_srli_epi64(folded, shift));
+        }
+
+        int parity = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(folded, 63)));
+        checksum |= (uint32_t)parity << k;
+    }
+
+    return checksum ^ coeffMatrix.offset;
+}
+
+#endif
+
+/*
+ *  Function to calculate the CRCs of consecutive DATA_SIZE lines with the fastest method.
+ */
+void calcCRCBatch(const uint8_t *lines, size_t numLine, uint32_t *checksums)
+{
+    calcCRCBatchWithMethod(BATCH_AUTO, lines, numLine, checksums);
+}
+
+/*
+ *  Function to calculate the CRCs of consecutive DATA_SIZE lines with the given method.
+ *
+ *  NOTE : genCoeffMatrix() must be called before use (done by initCRCEngine()).
+ */
+void calcCRCBatchWithMethod(BatchMethod method, const uint8_t *lines, size_t numLine, uint32_t *checksums)
+{
+    if (method == BATCH_AUTO) {
+        method = useCLMUL ? BATCH_INTERLEAVE : BATCH_SERIAL;
+    }
+
+    switch (method) {
+        case BATCH_MATRIX : {
+#if HAVE_X86_AVX2
+            if (useAVX2) {
+                for (size_t lineIdx = 0; lineIdx < numLine; ++lineIdx) {
+                    checksums[lineIdx] = calcCRCMatrixAVX2(lines + lineIdx * DATA_SIZE);
+                }
+                break;
+            }
+#endif
+            for (size_t lineIdx = 0; lineIdx < numLine; ++lineIdx) {
+                checksums[lineIdx] = calcCRCMatrix(lines + lineIdx * DATA_SIZE);
+            }
+            break;
+        }
+
+        case BATCH_INTERLEAVE : {
+            updateCRCBatchClmul(INIT_VAL, lines, DATA_SIZE, numLine, checksums);
+            for (size_t lineIdx = 0; lineIdx < numLine; ++lineIdx) {
+                checksums[lineIdx] = finalizeCRC(checksums[lineIdx]);
+            }
+            break;
+        }
+
+        default : {
+            for (size_t lineIdx = 0; lineIdx < numLine; ++lineIdx) {
+                checksums[lineIdx] = calcCRC(lines + lineIdx * DATA_SIZE, DATA_SIZE);
+            }
+            break;
+        }
+    }
+}
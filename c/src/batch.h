@@ -0,0 +1,36 @@
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#define MATRIX_WORDS (DATA_SIZE / 8)  // 64-bit words of a coefficient mask
+
+/*
+ *  Methods to calculate the CRCs of many DATA_SIZE lines.
+ *  All methods produce the same checksums as calcCRC().
+ */
+typedef enum {
+    BATCH_SERIAL,       // calcCRC() per line
+    BATCH_MATRIX,       // coefficient matrix: each checksum bit is parity(line & mask) (AVX2)
+    BATCH_INTERLEAVE,   // carry-less multiply folding of 4 lines at once
+    BATCH_AUTO,         // fastest method for this CPU
+    NUM_BATCH_METHODS
+} BatchMethod;
+
+/*
+ *  Coefficient matrix of the CRC over a DATA_SIZE line, the form used by CRC_COEFF_TABLE.
+ *
+ *  NOTE : mask[k] selects the data bits whose parity gives checksum bit k (LSB = 0),
+ *         as 64-bit little-endian words of the line. A zero line has checksum 'offset'.
+ */
+typedef struct {
+    uint64_t mask[CRC][MATRIX_WORDS] __attribute__((aligned(32)));
+    uint32_t offset;
+} CoeffMatrix;
+
+extern CoeffMatrix coeffMatrix;
+
+void genCoeffMatrix();
+const char *getBatchMethodName(BatchMethod method);
+void calcCRCBatch(const uint8_t *lines, size_t numLine, uint32_t *checksums);
+void calcCRCBatchWithMethod(BatchMethod method, const uint8_t *lines, size_t numLine, uint32_t *checksums);
+
+#endif
@@ -0,0 +1,595 @@
+/*
+ *  Benchmark suite of the CRC kernels and the simulator.
+ *
+ *  Every data point is cross-checked against the bitwise reference, and the
+ *  report is printed as a table, CSV or JSON so results can be compared between
+ *  versions ('make bench'):
+ *
+ *    1) kernel   : GB/s, TSC cycles/byte and latency per call of each CRC kernel
+ *                  over buffer sizes from --min-size to --max-size.
+ *    2) batch    : time per call of each batch method over batches of 1..N lines,
+ *                  and from which batch size it beats serial calcCRC() calls.
+ *    3) update   : latency of an incremental update of a partial line write.
+ *    4) parallel : calcCRCParallel() over the largest buffer.
+ *    5) sim      : simulation trials per second of a single thread, per-trial and bit-sliced.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "crc32.h"
+#include "fold.h"
+#include "rng.h"
+#include "syndrome.h"
+#include "sim.h"
+#include "bitslice.h"
+#include "batch.h"
+#include "combine.h"
+#include "bench.h"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#define HAVE_X86_TSC 1
+#else
+#define HAVE_X86_TSC 0
+#endif
+
+#define UPDATE_BYTES 4          // bytes changed by the incremental update benchmark
+#define NUM_SIM_CHECK 4096      // error vectors of the simulator cross-check
+
+/*
+ *  Function called repeatedly by timeCalls(). Returns a checksum of the call.
+ */
+typedef uint32_t (*BenchCall)(void *arg);
+
+typedef struct {
+    CRCKernel kernel;
+    const uint8_t *data;
+    size_t byteLen;
+} KernelArg;
+
+typedef struct {
+    BatchMethod method;
+    const uint8_t *lines;
+    size_t numLine;
+    uint32_t *checksums;
+} BatchArg;
+
+typedef struct {
+    const uint8_t *line;
+    uint32_t checksum;
+    const uint8_t *newBytes;
+} UpdateArg;
+
+typedef struct {
+    const uint8_t *data;
+    size_t byteLen;
+    unsigned int numThreads;
+} ParallelArg;
+
+typedef struct {
+    SimConfig config;
+    SimResult result;
+} SimArg;
+
+/*
+ *  Function to get benchmark settings from program input arguments.
+ */
+void getBenchConfig(int argc, char *argv[], BenchConfig *config)
+{
+    long numCPU = sysconf(_SC_NPROCESSORS_ONLN);
+
+    config->minSize = BENCH_MIN_SIZE;
+    config->maxSize = BENCH_MAX_SIZE;
+    config->maxLines = BENCH_LINES;
+    config->simIter = BENCH_SIM_ITER;
+    config->numThreads = numCPU > 0 ? (unsigned int)numCPU : 1;
+    config->format = BENCH_TEXT;
+    config->outPath = NULL;
+
+    for (int argIdx = 2; argIdx < argc - 1; ++argIdx) {
+        if (strcmp(argv[argIdx], "--min-size") == 0) {
+            config->minSize = strtoull(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--max-size") == 0) {
+            config->maxSize = strtoull(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--lines") == 0) {
+            config->maxLines = (size_t)strtoull(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--iter") == 0) {
+            config->simIter = strtoull(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--out") == 0) {
+            config->outPath = argv[++argIdx];
+        }
+        else if (strcmp(argv[argIdx], "--format") == 0) {
+            const char *name = argv[++argIdx];
+
+            if (strcmp(name, "text") == 0) {
+                config->format = BENCH_TEXT;
+            }
+            else if (strcmp(name, "csv") == 0) {
+                config->format = BENCH_CSV;
+            }
+            else if (strcmp(name, "json") == 0) {
+                config->format = BENCH_JSON;
+            }
+            else {
+                printf("Unknown report format: %s\n", name);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    if (config->minSize == 0) {
+        config->minSize = 1;
+    }
+    if (config->maxSize < config->minSize) {
+        config->maxSize = config->minSize;
+    }
+    if (config->maxLines == 0) {
+        config->maxLines = 1;
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+}
+
+/*
+ *  Function to get the monotonic time in seconds.
+ */
+double getTime()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/*
+ *  Function to read the time stamp counter (0 if unavailable).
+ */
+uint64_t getCycles()
+{
+#if HAVE_X86_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/*
+ *  Function to append a data point to the report.
+ */
+static void addRecord(BenchReport *report, const char *group, const char *name, uint64_t bytes,
+    uint64_t numCall, double seconds, uint64_t cycles, bool passed)
+{
+    if (report->numRecord == report->capacity) {
+        report->capacity = report->capacity ? report->capacity * 2 : 64;
+        report->records = (BenchRecord *)realloc(report->records, report->capacity * sizeof(BenchRecord));
+        if (report->records == NULL) {
+            printf("Unable to allocate benchmark records\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    BenchRecord *record = &report->records[report->numRecord++];
+    bool isSim = (strcmp(group, "sim") == 0);
+
+    record->group = group;
+    snprintf(record->name, sizeof(record->name), "%s", name);
+    record->bytes = bytes;
+    record->numCall = numCall;
+    record->seconds = seconds;
+    record->gbps = isSim ? 0.0 : (double)bytes * numCall / seconds * 1e-9;
+    record->cyclesPerByte = isSim ? 0.0 : (double)cycles / ((double)bytes * numCall);
+    record->latencyNs = seconds / numCall * 1e9;
+    record->ratePerSec = (isSim ? (double)bytes * numCall : (double)numCall) / seconds;
+    record->passed = passed;
+}
+
+/*
+ *  Function to call a function repeatedly for at least BENCH_MIN_TIME seconds.
+ *  Returns the result of the last call.
+ *
+ *  NOTE : The clock is read once per BENCH_REPEAT_BYTES bytes,
+ *         so its cost stays out of small calls.
+ */
+static uint32_t timeCalls(BenchCall call, void *arg, uint64_t bytesPerCall,
+    uint64_t *numCall, double *seconds, uint64_t *cycles)
+{
+    uint64_t numRepeat = (bytesPerCall < BENCH_REPEAT_BYTES) ? BENCH_REPEAT_BYTES / bytesPerCall : 1;
+    uint32_t result = 0;
+    double startTime = getTime();
+    uint64_t startCycles = getCycles();
+
+    *numCall = 0;
+    do {
+        for (uint64_t repeatIdx = 0; repeatIdx < numRepeat; ++repeatIdx) {
+            result = call(arg);
+        }
+        *numCall += numRepeat;
+        *seconds = getTime() - startTime;
+    } while (*seconds < BENCH_MIN_TIME);
+
+    *cycles = getCycles() - startCycles;
+    return result;
+}
+
+static uint32_t callKernel(void *arg)
+{
+    KernelArg *kernelArg = (KernelArg *)arg;
+    return calcCRCWithKernel(kernelArg->kernel, kernelArg->data, kernelArg->byteLen);
+}
+
+static uint32_t callBatch(void *arg)
+{
+    BatchArg *batchArg = (BatchArg *)arg;
+    calcCRCBatchWithMethod(batchArg->method, batchArg->lines, batchArg->numLine, batchArg->checksums);
+    return batchArg->checksums[0];
+}
+
+static uint32_t callUpdate(void *arg)
+{
+    UpdateArg *updateArg = (UpdateArg *)arg;
+    uint32_t checksum = updateArg->checksum;
+
+    updateCRCIncremental(&checksum, DATA_SIZE, DATA_SIZE / 4,
+        updateArg->line + DATA_SIZE / 4, updateArg->newBytes, UPDATE_BYTES);
+    return checksum;
+}
+
+static uint32_t callParallel(void *arg)
+{
+    ParallelArg *parallelArg = (ParallelArg *)arg;
+    return calcCRCParallel(parallelArg->data, parallelArg->byteLen, parallelArg->numThreads);
+}
+
+static uint32_t callSim(void *arg)
+{
+    SimArg *simArg = (SimArg *)arg;
+    memset(&simArg->result, 0, sizeof(SimResult));
+    if (simArg->config.bitSlice) {
+        simulateBitSliceChunk(&simArg->config, 0, simArg->config.numIter, &simArg->result);
+    }
+    else {
+        simulateChunk(&simArg->config, 0, simArg->config.numIter, &simArg->result);
+    }
+    return (uint32_t)simArg->result.totDetError;
+}
+
+/*
+ *  Function to benchmark every CRC kernel over the buffer sizes.
+ *  The bitwise kernel runs first at each size and gives the reference checksum.
+ *  Returns the reference checksum of the largest buffer.
+ */
+static uint32_t benchKernels(const BenchConfig *config, const uint8_t *data, BenchReport *report)
+{
+    uint32_t expected = 0;
+
+    for (uint64_t size = config->minSize; size <= config->maxSize; size *= BENCH_SIZE_STEP) {
+        for (int kernel = KERNEL_BITWISE; kernel < NUM_KERNELS; ++kernel) {
+            KernelArg arg = { (CRCKernel)kernel, data, size };
+            uint64_t numCall, cycles;
+            double seconds;
+
+            uint32_t checksum = timeCalls(callKernel, &arg, size, &numCall, &seconds, &cycles);
+            if (kernel == KERNEL_BITWISE) {
+                expected = checksum;
+            }
+
+            addRecord(report, "kernel", getKernelName((CRCKernel)kernel), size, numCall, seconds, cycles,
+                checksum == expected);
+        }
+
+        if (size > config->maxSize / BENCH_SIZE_STEP) {
+            break;  // avoid overflow
+        }
+    }
+
+    return expected;
+}
+
+/*
+ *  Function to benchmark the batch methods over batches of 1..maxLines lines.
+ */
+static void benchBatch(const BenchConfig *config, const uint8_t *data, BenchReport *report)
+{
+    uint32_t *expected = (uint32_t *)malloc(config->maxLines * sizeof(uint32_t));
+    uint32_t *checksums = (uint32_t *)malloc(config->maxLines * sizeof(uint32_t));
+
+    if (expected == NULL || checksums == NULL) {
+        printf("Unable to allocate %zu lines\n", config->maxLines);
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t lineIdx = 0; lineIdx < config->maxLines; ++lineIdx) {
+        expected[lineIdx] = calcCRCBitwise(data + lineIdx * DATA_SIZE, DATA_SIZE);
+    }
+
+    for (size_t numLine = 1; numLine <= config->maxLines; numLine *= 2) {
+        for (int method = BATCH_SERIAL; method < BATCH_AUTO; ++method) {
+            BatchArg arg = { (BatchMethod)method, data, numLine, checksums };
+            uint64_t numCall, cycles;
+            double seconds;
+            char name[32];
+
+            timeCalls(callBatch, &arg, numLine * DATA_SIZE, &numCall, &seconds, &cycles);
+            snprintf(name, sizeof(name), "%s", getBatchMethodName((BatchMethod)method));
+            addRecord(report, "batch", name, numLine * DATA_SIZE, numCall, seconds, cycles,
+                memcmp(checksums, expected, numLine * sizeof(uint32_t)) == 0);
+        }
+    }
+
+    free(checksums);
+    free(expected);
+}
+
+/*
+ *  Function to benchmark the incremental update of a partial line write.
+ */
+static void benchUpdate(const uint8_t *data, BenchReport *report)
+{
+    uint8_t line[DATA_SIZE];
+    const uint8_t *newBytes = data + DATA_SIZE;
+    UpdateArg arg = { data, calcCRCBitwise(data, DATA_SIZE), newBytes };
+    uint64_t numCall, cycles;
+    double seconds;
+
+    memcpy(line, data, DATA_SIZE);
+    memcpy(line + DATA_SIZE / 4, newBytes, UPDATE_BYTES);
+
+    uint32_t checksum = timeCalls(callUpdate, &arg, UPDATE_BYTES, &numCall, &seconds, &cycles);
+    addRecord(report, "update", "incremental", UPDATE_BYTES, numCall, seconds, cycles,
+        checksum == calcCRCBitwise(line, DATA_SIZE));
+}
+
+/*
+ *  Function to benchmark calcCRCParallel() over the largest buffer.
+ */
+static void benchParallel(const BenchConfig *config, const uint8_t *data, uint64_t size, uint32_t expected,
+    BenchReport *report)
+{
+    ParallelArg arg = { data, size, config->numThreads };
+    uint64_t numCall, cycles;
+    double seconds;
+    char name[32];
+
+    uint32_t checksum = timeCalls(callParallel, &arg, size, &numCall, &seconds, &cycles);
+    snprintf(name, sizeof(name), "threads-%u", config->numThreads);
+    addRecord(report, "parallel", name, size, numCall, seconds, cycles, checksum == expected);
+}
+
+/*
+ *  Function to check that syndrome detection agrees with bitwise decoding,
+ *  and the bit-sliced engine with syndrome detection.
+ */
+static bool checkSimDetection()
+{
+    static uint8_t errors[NUM_SIM_CHECK][CW_SIZE];
+    uint8_t codeword[CW_SIZE] = {0};
+    Rng rng;
+
+    memset(errors, 0, sizeof(errors));
+    encodeCRC(codeword, DATA_SIZE);
+    seedRng(&rng, 1, 0);
+    for (int checkIdx = 0; checkIdx < NUM_SIM_CHECK; ++checkIdx) {
+        uint8_t *error = errors[checkIdx];
+        uint8_t received[CW_SIZE];
+
+        // Alternate bursts and sparse random errors, which may be undetected.
+        if (checkIdx % 2) {
+            genErrorFast(error, CW_SIZE, &rng, getRngProb(0.004));
+        }
+        else {
+            genBurstErrorFast(error, CW_SIZE, &rng, getRngProb(0.5));
+        }
+        memcpy(received, codeword, CW_SIZE);
+        bitwiseXOR(received, error, CW_SIZE);
+
+        bool detected = calcCRCBitwise(received, DATA_SIZE) != loadBE32(received + DATA_SIZE);
+        if (detected != (getSyndrome(&synTable, error, CW_SIZE) != 0)) {
+            return false;
+        }
+    }
+
+    return checkBitSliceSyndrome(errors, NUM_SIM_CHECK);
+}
+
+/*
+ *  Function to benchmark the simulator trials per second (single thread).
+ */
+static void benchSim(const BenchConfig *config, BenchReport *report)
+{
+    uint8_t zero[DATA_SIZE] = {0};
+    bool passed = checkSimDetection() && calcCRCBitwise(zero, DATA_SIZE) == calcCRC(zero, DATA_SIZE);
+
+    // 0 : per-trial fast path, 1 : per-bit reference, 2 : bit-sliced engine
+    for (int engine = 0; engine <= 2; ++engine) {
+        static const char *names[] = { "fast", "ref", "bitslice" };
+        SimArg arg = {0};
+        uint64_t numCall, cycles;
+        double seconds;
+
+        arg.config.numIter = engine == 1 ? (config->simIter + 7) / 8 : config->simIter;  // reference path is slower
+        arg.config.numThreads = 1;
+        arg.config.seed = 1;
+        arg.config.flipRate = 0.5;
+        arg.config.refGen = engine == 1;
+        arg.config.model = ERROR_BURST;
+        arg.config.correctBurst = 0;
+        arg.config.bitSlice = engine == 2;
+
+        timeCalls(callSim, &arg, BENCH_REPEAT_BYTES, &numCall, &seconds, &cycles);
+        addRecord(report, "sim", names[engine], arg.config.numIter, numCall, seconds, cycles,
+            passed && arg.result.numIter == arg.config.numIter);
+    }
+}
+
+/*
+ *  Function to print the report as a table, with the crossover of the batch methods.
+ */
+static void printBenchText(FILE *out, const BenchReport *report)
+{
+    fprintf(out, "%-9s %-12s %12s %10s %10s %10s %14s %14s %6s\n",
+        "Group", "Name", "Bytes", "Calls", "GB/s", "Cycles/B", "Latency(ns)", "Rate(/s)", "Check");
+
+    for (size_t recordIdx = 0; recordIdx < report->numRecord; ++recordIdx) {
+        const BenchRecord *record = &report->records[recordIdx];
+
+        fprintf(out, "%-9s %-12s %12llu %10llu %10.3f %10.3f %14.1f %14.4g %6s\n",
+            record->group, record->name, (unsigned long long)record->bytes, (unsigned long long)record->numCall,
+            record->gbps, record->cyclesPerByte, record->latencyNs, record->ratePerSec,
+            record->passed ? "pass" : "FAIL");
+    }
+
+    // A batch method crosses over at the first batch size where it beats serial calls.
+    for (int method = BATCH_MATRIX; method < BATCH_AUTO; ++method) {
+        const char *name = getBatchMethodName((BatchMethod)method);
+        double serialLatency = 0.0;
+        uint64_t crossover = 0;
+
+        for (size_t recordIdx = 0; recordIdx < report->numRecord && crossover == 0; ++recordIdx) {
+            const BenchRecord *record = &report->records[recordIdx];
+
+            if (strcmp(record->group, "batch") != 0) {
+                continue;
+            }
+            if (strcmp(record->name, getBatchMethodName(BATCH_SERIAL)) == 0) {
+                serialLatency = record->latencyNs;
+            }
+            else if (strcmp(record->name, name) == 0 && record->latencyNs < serialLatency) {
+                crossover = record->bytes / DATA_SIZE;
+            }
+        }
+
+        if (crossover > 0) {
+            fprintf(out, "Crossover : %s beats serial from %llu lines\n", name, (unsigned long long)crossover);
+        }
+        else {
+            fprintf(out, "Crossover : %s does not beat serial\n", name);
+        }
+    }
+}
+
+static void printBenchCSV(FILE *out, const BenchReport *report)
+{
+    fprintf(out, "group,name,bytes,calls,seconds,gb_per_s,cycles_per_byte,latency_ns,rate_per_s,check\n");
+
+    for (size_t recordIdx = 0; recordIdx < report->numRecord; ++recordIdx) {
+        const BenchRecord *record = &report->records[recordIdx];
+
+        fprintf(out, "%s,%s,%llu,%llu,%.6f,%.4f,%.4f,%.2f,%.6g,%s\n",
+            record->group, record->name, (unsigned long long)record->bytes, (unsigned long long)record->numCall,
+            record->seconds, record->gbps, record->cyclesPerByte, record->latencyNs, record->ratePerSec,
+            record->passed ? "pass" : "fail");
+    }
+}
+
+static void printBenchJSON(FILE *out, const BenchReport *report)
+{
+    fprintf(out, "{\n");
+    fprintf(out, "  \"poly\": \"0x%08X\",\n", GEN_POLY);
+    fprintf(out, "  \"init\": \"0x%08X\",\n", INIT_VAL);
+    fprintf(out, "  \"xorOut\": \"0x%08X\",\n", XOR_VAL);
+    fprintf(out, "  \"reflect\": %s,\n", REFLECT ? "true" : "false");
+    fprintf(out, "  \"dataSize\": %d,\n", DATA_SIZE);
+    fprintf(out, "  \"clmul\": %s,\n", hasCLMUL() ? "true" : "false");
+    fprintf(out, "  \"results\": [\n");
+
+    for (size_t recordIdx = 0; recordIdx < report->numRecord; ++recordIdx) {
+        const BenchRecord *record = &report->records[recordIdx];
+
+        fprintf(out, "    {\"group\": \"%s\", \"name\": \"%s\", \"bytes\": %llu, \"calls\": %llu, "
+            "\"seconds\": %.6f, \"gbPerSec\": %.4f, \"cyclesPerByte\": %.4f, \"latencyNs\": %.2f, "
+            "\"ratePerSec\": %.6g, \"check\": \"%s\"}%s\n",
+            record->group, record->name, (unsigned long long)record->bytes, (unsigned long long)record->numCall,
+            record->seconds, record->gbps, record->cyclesPerByte, record->latencyNs, record->ratePerSec,
+            record->passed ? "pass" : "fail", recordIdx + 1 < report->numRecord ? "," : "");
+    }
+
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+/*
+ *  Function to run all benchmarks and print the report.
+ *  Exits with failure if any result does not match the bitwise reference.
+ */
+void benchmark(const BenchConfig *config)
+{
+    size_t bufferLen = config->maxSize;
+    BenchReport report = { NULL, 0, 0 };
+    Rng rng;
+
+    if (bufferLen < config->maxLines * DATA_SIZE) {
+        bufferLen = config->maxLines * DATA_SIZE;
+    }
+
+    uint8_t *data = (uint8_t *)malloc(bufferLen);
+    if (data == NULL) {
+        printf("Unable to allocate %zu bytes\n", bufferLen);
+        exit(EXIT_FAILURE);
+    }
+
+    seedRng(&rng, 0, 0);
+    for (size_t byteIdx = 0; byteIdx + sizeof(uint64_t) <= bufferLen; byteIdx += sizeof(uint64_t)) {
+        uint64_t value = nextRng(&rng);
+        memcpy(data + byteIdx, &value, sizeof(uint64_t));
+    }
+    for (size_t byteIdx = bufferLen / sizeof(uint64_t) * sizeof(uint64_t); byteIdx < bufferLen; ++byteIdx) {
+        data[byteIdx] = (uint8_t)nextRng(&rng);
+    }
+
+    uint64_t largestSize = config->minSize;
+    while (largestSize <= config->maxSize / BENCH_SIZE_STEP) {
+        largestSize *= BENCH_SIZE_STEP;
+    }
+
+    uint32_t expected = benchKernels(config, data, &report);
+    benchBatch(config, data, &report);
+    benchUpdate(data, &report);
+    benchParallel(config, data, largestSize, expected, &report);
+    benchSim(config, &report);
+
+    FILE *out = stdout;
+    if (config->outPath != NULL) {
+        out = fopen(config->outPath, "w");
+        if (out == NULL) {
+            printf("Unable to create %s\n", config->outPath);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    switch (config->format) {
+        case BENCH_CSV  : printBenchCSV(out, &report); break;
+        case BENCH_JSON : printBenchJSON(out, &report); break;
+        default         : printBenchText(out, &report); break;
+    }
+
+    if (out != stdout) {
+        fclose(out);
+        printf("Benchmark report written to %s\n", config->outPath);
+    }
+
+    bool passed = true;
+    for (size_t recordIdx = 0; recordIdx < report.numRecord; ++recordIdx) {
+        passed = passed && report.records[recordIdx].passed;
+    }
+
+    free(report.records);
+    free(data);
+
+    if (!passed) {
+        printf("Cross-check against the bitwise reference failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
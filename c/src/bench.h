@@ -0,0 +1,61 @@
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#define BENCH_MIN_SIZE 64                   // default smallest buffer in bytes
+#define BENCH_MAX_SIZE (1ULL << 30)         // default largest buffer in bytes
+#define BENCH_SIZE_STEP 4                   // buffer sizes grow by this factor
+#define BENCH_LINES 4096                    // default largest batch of lines
+#define BENCH_SIM_ITER (1 << 20)            // default simulation trials
+#define BENCH_MIN_TIME 0.01                 // minimum measuring time of a data point in seconds
+#define BENCH_REPEAT_BYTES (1 << 18)        // bytes processed between clock reads
+
+/*
+ *  Output formats of the benchmark report.
+ */
+typedef enum {
+    BENCH_TEXT,
+    BENCH_CSV,
+    BENCH_JSON
+} BenchFormat;
+
+/*
+ *  Benchmark settings given by program input arguments.
+ */
+typedef struct {
+    uint64_t minSize;           // smallest buffer in bytes         (--min-size N)
+    uint64_t maxSize;           // largest buffer in bytes          (--max-size N)
+    size_t maxLines;            // largest batch of lines           (--lines N)
+    uint64_t simIter;           // simulation trials                (--iter N)
+    unsigned int numThreads;    // threads of calcCRCParallel()     (--threads N)
+    BenchFormat format;         // report format                    (--format text|csv|json)
+    const char *outPath;        // report file (default: stdout)    (--out FILE)
+} BenchConfig;
+
+/*
+ *  A measured data point.
+ */
+typedef struct {
+    const char *group;          // kernel, batch, update, parallel or sim
+    char name[32];
+    uint64_t bytes;             // bytes per call (trials per call for sim)
+    uint64_t numCall;
+    double seconds;
+    double gbps;                // GB/s
+    double cyclesPerByte;       // TSC cycles per byte (0 if unavailable)
+    double latencyNs;           // time per call in ns
+    double ratePerSec;          // calls per second (trials per second for sim)
+    bool passed;                // result matches the bitwise reference
+} BenchRecord;
+
+typedef struct {
+    BenchRecord *records;
+    size_t numRecord;
+    size_t capacity;
+} BenchReport;
+
+void getBenchConfig(int argc, char *argv[], BenchConfig *config);
+void benchmark(const BenchConfig *config);
+double getTime();
+uint64_t getCycles();
+
+#endif
@@ -0,0 +1,413 @@
+/*
+ *  Bit-sliced simulation engine (see bitslice.h).
+ *
+ *  Every trial of simulateChunk() is linear over GF(2): the syndrome is the
+ *  product of the per-bit syndrome matrix and the error vector. Here the error
+ *  bits of BITSLICE_LANES trials at one codeword position form one bit-sliced
+ *  word, and the matrix is applied to all of them with word-wide XORs.
+ *
+ *  NOTE : The data columns of the matrix are the powers of x mod GEN_POLY, so
+ *         they are applied in Horner form, as a shift register of bit-sliced
+ *         words with a tap per term of GEN_POLY, instead of 16 XORs per bit
+ *         on average. The check columns are single bits and read from synTable.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "sim.h"
+#include "bitslice.h"
+
+#define BITSLICE_INLINE static inline __attribute__((always_inline))
+#define DATA_BITS (DATA_SIZE * BYTE)
+
+typedef uint64_t BitSliceWord __attribute__((vector_size(BITSLICE_WORDS * sizeof(uint64_t))));
+
+/*
+ *  xoshiro256** of rng.h, one independent stream per 64-bit word.
+ */
+typedef struct {
+    BitSliceWord state[4];
+} BitSliceRng;
+
+/*
+ *  Bit-sliced state of a block after all codeword bits.
+ */
+typedef struct {
+    BitSliceWord syndrome[CRC];     // syndrome bit j of every trial
+    BitSliceWord ones;              // error bit count, bit 0 (odd error)
+    BitSliceWord twos;              // error bit count, bit 1
+    BitSliceWord many;              // error bit count >= 4
+    BitSliceWord longBurst;         // two error bits at least CRC bits apart
+} BitSliceBlock;
+
+typedef enum {
+    BITSLICE_SCALAR,
+    BITSLICE_AVX2,
+    BITSLICE_AVX512
+} BitSliceISA;
+
+/*
+ *  Function to get the widest instruction set of the engine on this CPU.
+ */
+static BitSliceISA getBitSliceTarget()
+{
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx512f")) {
+        return BITSLICE_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return BITSLICE_AVX2;
+    }
+#endif
+    return BITSLICE_SCALAR;
+}
+
+const char *getBitSliceISA()
+{
+    static const char *names[] = { "scalar", "avx2", "avx512" };
+    return names[getBitSliceTarget()];
+}
+
+/*
+ *  Function to check if the engine supports an error model.
+ *
+ *  NOTE : The DRAM fault models are already evaluated by one lookup per 8 bits
+ *         of the faulty region (errmodel.c), so they stay on the per-trial loop.
+ */
+bool isBitSliceModel(ErrorModel model)
+{
+    return model == ERROR_RANDOM || model == ERROR_BURST;
+}
+
+static void seedBitSliceRng(BitSliceRng *rng, uint64_t seed, uint64_t stream)
+{
+    for (unsigned int wordIdx = 0; wordIdx < BITSLICE_WORDS; ++wordIdx) {
+        Rng wordRng;
+
+        seedRng(&wordRng, seed, stream + wordIdx);
+        for (int stateIdx = 0; stateIdx < 4; ++stateIdx) {
+            rng->state[stateIdx][wordIdx] = wordRng.state[stateIdx];
+        }
+    }
+}
+
+BITSLICE_INLINE void nextBitSliceRng(BitSliceRng *rng, BitSliceWord *random)
+{
+    BitSliceWord *s = rng->state;
+    BitSliceWord mul5 = (s[1] << 2) + s[1];
+    BitSliceWord rotated = (mul5 << 7) | (mul5 >> 57);
+    BitSliceWord result = (rotated << 3) + rotated;
+    BitSliceWord t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+
+    *random = result;
+}
+
+/*
+ *  Function to get bits which are 1 with a probability of prob / 2^64 (see nextRngMask()).
+ */
+BITSLICE_INLINE void nextBitSliceMask(BitSliceRng *rng, uint64_t prob, BitSliceWord *mask)
+{
+    *mask = (BitSliceWord){0};
+
+    if (prob == 0) {
+        return;
+    }
+
+    for (int bitIdx = __builtin_ctzll(prob); bitIdx < 64; ++bitIdx) {
+        BitSliceWord random;
+
+        nextBitSliceRng(rng, &random);
+        *mask = ((prob >> bitIdx) & 1) ? (*mask | random) : (*mask & random);
+    }
+}
+
+/*
+ *  Function to evaluate a block of trials.
+ *
+ *  NOTE : Error bits are taken from errors if given, otherwise drawn with flipProb
+ *         and masked by the byte window of each trial if given. Positions are
+ *         processed CRC at a time, so the register and history slots are constant
+ *         after unrolling.
+ */
+BITSLICE_INLINE void evalBitSliceBlock(BitSliceBlock *block, BitSliceRng *rng, uint64_t flipProb,
+    const BitSliceWord *window, const BitSliceWord *errors, const uint8_t *checkBit)
+{
+    BitSliceWord reg[CRC] = {{0}};      // shift register, logical bit k in slot (top + k) % CRC
+    BitSliceWord history[CRC] = {{0}};  // error bits CRC positions back
+    BitSliceWord buffer[CRC];
+    BitSliceWord ones = {0}, twos = {0}, many = {0};
+    BitSliceWord seen = {0}, longBurst = {0};
+
+    for (unsigned int base = 0; base < CW_BITS; base += CRC) {
+        for (unsigned int step = 0; step < CRC; ++step) {
+            unsigned int pos = base + step;
+
+            if (errors != NULL) {
+                buffer[step] = errors[pos];
+            }
+            else {
+                nextBitSliceMask(rng, flipProb, &buffer[step]);
+                if (window != NULL) {
+                    buffer[step] &= window[pos / BYTE];
+                }
+            }
+        }
+
+#pragma GCC unroll 32
+        for (unsigned int step = 0; step < CRC; ++step) {
+            BitSliceWord error = buffer[step];
+            BitSliceWord carry = ones & error;
+
+            // Saturating bit count, and whether any earlier bit is CRC or more positions back.
+            ones ^= error;
+            many |= twos & carry;
+            twos ^= carry;
+            seen |= history[step];
+            longBurst |= seen & error;
+            history[step] = error;
+
+            if (base < DATA_BITS) {
+                // The shift moves the slot of logical bit CRC-1 to logical bit 0.
+                unsigned int top = (CRC - 1 - step) % CRC;
+                BitSliceWord feedback = reg[top] ^ error;
+
+                reg[top] = (GEN_POLY & 1) ? feedback : (feedback & 0);
+#pragma GCC unroll 32
+                for (unsigned int tap = 1; tap < CRC; ++tap) {
+                    if ((GEN_POLY >> tap) & 1) {
+                        reg[(top + tap) % CRC] ^= feedback;
+                    }
+                }
+            }
+            else {
+                if (step == 0) {
+                    // After DATA_BITS shifts the logical bit k is in slot k again.
+                    for (unsigned int bitIdx = 0; bitIdx < CRC; ++bitIdx) {
+                        block->syndrome[bitIdx] = reg[REFLECT ? CRC - 1 - bitIdx : bitIdx];
+                    }
+                }
+                block->syndrome[checkBit[step]] ^= error;
+            }
+        }
+    }
+
+    block->ones = ones;
+    block->twos = twos;
+    block->many = many;
+    block->longBurst = longBurst;
+}
+
+static inline uint64_t countBitSlice(const BitSliceWord *word, const BitSliceWord *valid)
+{
+    uint64_t count = 0;
+
+    for (unsigned int wordIdx = 0; wordIdx < BITSLICE_WORDS; ++wordIdx) {
+        count += __builtin_popcountll((*word)[wordIdx] & (*valid)[wordIdx]);
+    }
+
+    return count;
+}
+
+/*
+ *  Function to add the counters of the valid lanes of a block to the result.
+ */
+static void tallyBitSliceBlock(const BitSliceBlock *block, unsigned int numLane, SimResult *result)
+{
+    BitSliceWord valid, detected = {0};
+
+    for (unsigned int wordIdx = 0; wordIdx < BITSLICE_WORDS; ++wordIdx) {
+        unsigned int firstLane = wordIdx * 64;
+        valid[wordIdx] = numLane >= firstLane + 64 ? ~(uint64_t)0 :
+                         numLane > firstLane ? ((uint64_t)1 << (numLane - firstLane)) - 1 : 0;
+    }
+    for (unsigned int bitIdx = 0; bitIdx < CRC; ++bitIdx) {
+        detected |= block->syndrome[bitIdx];
+    }
+
+    BitSliceWord nonZero = block->ones | block->twos | block->many;
+    BitSliceWord doubleError = block->twos & ~block->ones & ~block->many;
+    BitSliceWord burst32 = nonZero & ~block->longBurst;
+    BitSliceWord detOdd = block->ones & detected;
+    BitSliceWord detDouble = doubleError & detected;
+    BitSliceWord detBurst32 = burst32 & detected;
+
+    // A detected error is always non-zero, as the syndrome of zero is zero.
+    result->numError        += countBitSlice(&nonZero, &valid);
+    result->totDetError     += countBitSlice(&detected, &valid);
+    result->totOddError     += countBitSlice(&block->ones, &valid);
+    result->detOddError     += countBitSlice(&detOdd, &valid);
+    result->totDoubleError  += countBitSlice(&doubleError, &valid);
+    result->detDoubleError  += countBitSlice(&detDouble, &valid);
+    result->totBurst32Error += countBitSlice(&burst32, &valid);
+    result->detBurst32Error += countBitSlice(&detBurst32, &valid);
+}
+
+/*
+ *  Function to get the syndrome bit of each checksum bit position.
+ */
+static void getCheckBits(uint8_t *checkBit)
+{
+    for (unsigned int bitIdx = 0; bitIdx < CRC; ++bitIdx) {
+        checkBit[bitIdx] = (uint8_t)__builtin_ctz(synTable.bitSyndrome[DATA_BITS + bitIdx]);
+    }
+}
+
+/*
+ *  Function to run a chunk of iterations, BITSLICE_LANES trials at a time.
+ *
+ *  NOTE : A chunk draws from BITSLICE_WORDS + 1 streams: one per word of the
+ *         bit-sliced generator, and one for the burst positions.
+ */
+BITSLICE_INLINE void runBitSliceChunk(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter,
+    SimResult *result)
+{
+    uint64_t stream = chunkIdx * (BITSLICE_WORDS + 1);
+    uint64_t flipProb = getRngProb(config->flipRate);
+    uint8_t checkBit[CRC];
+    BitSliceRng rng;
+    Rng startRng;
+
+    seedBitSliceRng(&rng, config->seed, stream);
+    seedRng(&startRng, config->seed, stream + BITSLICE_WORDS);
+    getCheckBits(checkBit);
+
+    for (uint64_t firstIter = 0; firstIter < numIter; firstIter += BITSLICE_LANES) {
+        unsigned int numLane = numIter - firstIter < BITSLICE_LANES ? numIter - firstIter : BITSLICE_LANES;
+        BitSliceWord window[CW_SIZE] = {{0}};
+        BitSliceBlock block;
+
+        if (config->model == ERROR_BURST) {
+            // A burst covers CHECK_SIZE bytes from a start byte in 1..DATA_SIZE, as in genBurstErrorFast().
+            BitSliceWord start[CW_SIZE] = {{0}};
+
+            for (unsigned int lane = 0; lane < BITSLICE_LANES; lane += 2) {
+                uint64_t random = nextRng(&startRng);
+
+                for (unsigned int half = 0; half < 2; ++half) {
+                    uint64_t startByteIdx = (((random >> (32 * half)) & 0xFFFFFFFF) * DATA_SIZE >> 32) + 1;
+                    start[startByteIdx][(lane + half) / 64] |= (uint64_t)1 << ((lane + half) % 64);
+                }
+            }
+            for (unsigned int byteIdx = 0; byteIdx < CW_SIZE; ++byteIdx) {
+                for (unsigned int offset = 0; offset < CHECK_SIZE && offset <= byteIdx; ++offset) {
+                    window[byteIdx] |= start[byteIdx - offset];
+                }
+            }
+        }
+
+        evalBitSliceBlock(&block, &rng, flipProb, config->model == ERROR_BURST ? window : NULL, NULL, checkBit);
+        tallyBitSliceBlock(&block, numLane, result);
+    }
+
+    result->numIter += numIter;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx512f")))
+static void runBitSliceChunkAVX512(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result)
+{
+    runBitSliceChunk(config, chunkIdx, numIter, result);
+}
+
+__attribute__((target("avx2")))
+static void runBitSliceChunkAVX2(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result)
+{
+    runBitSliceChunk(config, chunkIdx, numIter, result);
+}
+#endif
+
+static void runBitSliceChunkScalar(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result)
+{
+    runBitSliceChunk(config, chunkIdx, numIter, result);
+}
+
+/*
+ *  Function to run a chunk of iterations with the bit-sliced engine.
+ *
+ *  NOTE : Every chunk has its own random streams seeded by (seed, chunkIdx), as
+ *         in simulateChunk(). The streams differ from simulateChunk(), so the
+ *         counters match it statistically, not exactly.
+ */
+void simulateBitSliceChunk(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result)
+{
+    switch (getBitSliceTarget()) {
+#if defined(__x86_64__)
+        case BITSLICE_AVX512 : {
+            runBitSliceChunkAVX512(config, chunkIdx, numIter, result);
+            break;
+        }
+        case BITSLICE_AVX2 : {
+            runBitSliceChunkAVX2(config, chunkIdx, numIter, result);
+            break;
+        }
+#endif
+        default : {
+            runBitSliceChunkScalar(config, chunkIdx, numIter, result);
+            break;
+        }
+    }
+}
+
+/*
+ *  Function to check the engine against getSyndrome() and the per-trial counters
+ *  on given error vectors.
+ */
+bool checkBitSliceSyndrome(const uint8_t (*errors)[CW_SIZE], size_t numError)
+{
+    static BitSliceWord sliced[CW_BITS];
+    uint8_t checkBit[CRC];
+
+    getCheckBits(checkBit);
+
+    for (size_t firstError = 0; firstError < numError; firstError += BITSLICE_LANES) {
+        size_t numLane = numError - firstError < BITSLICE_LANES ? numError - firstError : BITSLICE_LANES;
+        BitSliceBlock block;
+
+        // Transpose: bit 'pos' of error vector t goes to lane t of sliced[pos].
+        memset(sliced, 0, sizeof(sliced));
+        for (size_t lane = 0; lane < numLane; ++lane) {
+            for (unsigned int pos = 0; pos < CW_BITS; ++pos) {
+                if ((errors[firstError + lane][pos / BYTE] << (pos % BYTE)) & 0x80) {
+                    sliced[pos][lane / 64] |= (uint64_t)1 << (lane % 64);
+                }
+            }
+        }
+
+        evalBitSliceBlock(&block, NULL, 0, NULL, sliced, checkBit);
+
+        for (size_t lane = 0; lane < numLane; ++lane) {
+            const uint8_t *error = errors[firstError + lane];
+            unsigned int errorCount = countOneFast(error, CW_SIZE);
+            unsigned int wordIdx = lane / 64;
+            unsigned int shift = lane % 64;
+            uint32_t syndrome = 0;
+
+            for (unsigned int bitIdx = 0; bitIdx < CRC; ++bitIdx) {
+                syndrome |= (uint32_t)((block.syndrome[bitIdx][wordIdx] >> shift) & 1) << bitIdx;
+            }
+
+            bool isOdd = (block.ones[wordIdx] >> shift) & 1;
+            bool isDouble = ((block.twos & ~block.ones & ~block.many)[wordIdx] >> shift) & 1;
+            bool isLong = (block.longBurst[wordIdx] >> shift) & 1;
+
+            if (syndrome != getSyndrome(&synTable, error, CW_SIZE) || isOdd != (errorCount % 2) ||
+                isDouble != (errorCount == 2) || isLong != (getBurstLenFast(error, CW_SIZE) > CRC)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,25 @@
+#ifndef __BITSLICE_H__
+#define __BITSLICE_H__
+
+#define BITSLICE_WORDS 8                            // 64-bit words of a bit-sliced word
+#define BITSLICE_LANES (BITSLICE_WORDS * 64)        // trials evaluated together
+
+/*
+ *  Bit-sliced simulation engine.
+ *
+ *  Lane t of a bit-sliced word belongs to trial t of a block of BITSLICE_LANES
+ *  trials, so one word-wide operation handles a codeword bit of every trial.
+ *  The syndromes of all trials are computed together, and the counters are
+ *  tallied with popcounts.
+ *
+ *  NOTE : Lanes are processed 512, 256 or 64 at a time by the widest instruction
+ *         set of the CPU, with the same random streams, so the result does not
+ *         depend on the CPU.
+ */
+
+bool isBitSliceModel(ErrorModel model);
+const char *getBitSliceISA();
+void simulateBitSliceChunk(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result);
+bool checkBitSliceSyndrome(const uint8_t (*errors)[CW_SIZE], size_t numError);
+
+#endif
@@ -0,0 +1,234 @@
+/*
+ *  Incremental update and combination of CRC checksums.
+ *
+ *  CRC is affine over GF(2), so the checksum of a modified line only changes by
+ *  the CRC of the changed bits, shifted by the bytes that follow them:
+ *
+ *    CRC(line ^ delta) = CRC(line) ^ (R(delta) * x^(8 * trailing) mod P)
+ *
+ *  where R(delta) is the register over the changed bytes from a zero register.
+ *  The same shift operator concatenates independently computed checksums,
+ *  which lets a large buffer be split across threads.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "crc32.h"
+#include "fold.h"
+#include "combine.h"
+
+#define PARALLEL_ALIGN 64       // chunk boundaries of calcCRCParallel()
+
+ShiftTable shiftTable;
+
+typedef struct {
+    const uint8_t *data;
+    size_t byteLen;
+    uint32_t crc;
+} ParallelChunk;
+
+/*
+ *  Function to generate the shift operators.
+ */
+void genShiftTable()
+{
+    shiftTable.byteShift[0] = 0x00000001;  // x^0
+    for (unsigned int numBytes = 1; numBytes <= DATA_SIZE; ++numBytes) {
+        shiftTable.byteShift[numBytes] = multModP(shiftTable.byteShift[numBytes - 1], xPowMod(BYTE));
+    }
+
+    shiftTable.powShift[0] = xPowMod(BYTE);
+    for (unsigned int k = 1; k < SHIFT_OPS; ++k) {
+        shiftTable.powShift[k] = multModP(shiftTable.powShift[k - 1], shiftTable.powShift[k - 1]);
+    }
+
+    // Multiplying by x^(8n) is linear, so an entry is the XOR of the shifted bits of its byte.
+    for (unsigned int numBytes = 0; numBytes <= DATA_SIZE; ++numBytes) {
+        for (unsigned int byteIdx = 0; byteIdx < CRC / BYTE; ++byteIdx) {
+            uint32_t *table = shiftTable.byteTable[numBytes][byteIdx];
+            uint32_t bitShift[BYTE];
+
+            for (unsigned int bitIdx = 0; bitIdx < BYTE; ++bitIdx) {
+                bitShift[bitIdx] = multModP((uint32_t)1 << (CRC - BYTE * (byteIdx + 1) + bitIdx),
+                    shiftTable.byteShift[numBytes]);
+            }
+
+            table[0] = 0;
+            for (unsigned int byteValue = 1; byteValue < TABLE_SIZE; ++byteValue) {
+                unsigned int lowBit = __builtin_ctz(byteValue);
+                table[byteValue] = table[byteValue & (byteValue - 1)] ^ bitShift[lowBit];
+            }
+        }
+    }
+}
+
+/*
+ *  Function to calculate a * b mod P.
+ */
+uint32_t multModP(uint32_t a, uint32_t b)
+{
+    uint32_t product = 0;
+
+    // Horner's rule over the bits of b, from the highest.
+    for (int bitIdx = CRC - 1; bitIdx >= 0; --bitIdx) {
+        product = (product & 0x80000000) ? (product << 1) ^ GEN_POLY : product << 1;
+
+        if ((b >> bitIdx) & 1) {
+            product ^= a;
+        }
+    }
+
+    return product;
+}
+
+/*
+ *  Function to get x^(8n) mod P, the operator that shifts a register over n zero bytes.
+ */
+uint32_t getByteShift(uint64_t numBytes)
+{
+    uint32_t result = 0x00000001;
+
+    if (numBytes <= DATA_SIZE) {
+        return shiftTable.byteShift[numBytes];
+    }
+
+    for (unsigned int k = 0; numBytes != 0; ++k, numBytes >>= 1) {
+        if (numBytes & 1) {
+            result = multModP(result, shiftTable.powShift[k]);
+        }
+    }
+
+    return result;
+}
+
+/*
+ *  Function to shift a CRC register over the given number of zero bytes.
+ */
+uint32_t shiftCRC(uint32_t crc, uint64_t numBytes)
+{
+    if (numBytes <= DATA_SIZE) {
+        const uint32_t (*table)[TABLE_SIZE] = shiftTable.byteTable[numBytes];
+
+        return table[0][crc >> 24] ^ table[1][(crc >> 16) & 0xFF] ^
+               table[2][(crc >> 8) & 0xFF] ^ table[3][crc & 0xFF];
+    }
+
+    return multModP(crc, getByteShift(numBytes));
+}
+
+/*
+ *  Function to undo finalizeCRC().
+ */
+static inline uint32_t unfinalizeCRC(uint32_t checksum)
+{
+    checksum ^= XOR_VAL;
+    return REFLECT ? reflect(checksum) : checksum;
+}
+
+/*
+ *  Function to combine the checksums of A and B into the checksum of A followed by B.
+ *
+ *  NOTE : Both checksums are calcCRC() results. The register of B started from INIT_VAL
+ *         instead of the register of A, so their difference is shifted over B:
+ *           R(A || B) = (R(A) ^ INIT_VAL) * x^(8 * lenB) ^ R(B)
+ */
+uint32_t combineCRC(uint32_t crcA, uint32_t crcB, uint64_t lenB)
+{
+    uint32_t regA = unfinalizeCRC(crcA);
+    uint32_t regB = unfinalizeCRC(crcB);
+
+    return finalizeCRC(shiftCRC(regA ^ INIT_VAL, lenB) ^ regB);
+}
+
+/*
+ *  Function to update the checksum of a line after numBytes bytes at 'offset' changed.
+ *  Returns false, leaving the checksum as is, if the bytes are out of the line.
+ *
+ *  NOTE : Runs in O(numBytes) with one table lookup per changed byte and
+ *         one shift over the (lineLen - offset - numBytes) trailing bytes,
+ *         which is 4 lookups for lines up to DATA_SIZE bytes.
+ */
+bool updateCRCIncremental(uint32_t *checksum, size_t lineLen, size_t offset,
+    const uint8_t *oldBytes, const uint8_t *newBytes, size_t numBytes)
+{
+    uint32_t delta = 0;
+
+    if (offset > lineLen || numBytes > lineLen - offset) {
+        return false;
+    }
+
+    for (size_t byteIdx = 0; byteIdx < numBytes; ++byteIdx) {
+        uint8_t change = oldBytes[byteIdx] ^ newBytes[byteIdx];
+        delta = (delta << BYTE) ^ CRCTable[(delta >> (CRC - BYTE)) ^ change];
+    }
+
+    delta = shiftCRC(delta, lineLen - offset - numBytes);
+    *checksum ^= REFLECT ? reflect(delta) : delta;
+
+    return true;
+}
+
+/*
+ *  Worker thread function. Calculates the checksum of a chunk.
+ */
+static void *parallelWorker(void *arg)
+{
+    ParallelChunk *chunk = (ParallelChunk *)arg;
+
+    chunk->crc = calcCRC(chunk->data, chunk->byteLen);
+    return NULL;
+}
+
+/*
+ *  Function to calculate the checksum of a large buffer with worker threads.
+ *  The buffer is split into one chunk per thread, and the chunk checksums are combined.
+ */
+uint32_t calcCRCParallel(const uint8_t *data, size_t byteLen, unsigned int numThreads)
+{
+    if (numThreads <= 1) {
+        return calcCRC(data, byteLen);
+    }
+
+    // Chunks are rounded up to PARALLEL_ALIGN bytes, so there are at most numThreads chunks.
+    size_t numAlign = (byteLen + PARALLEL_ALIGN - 1) / PARALLEL_ALIGN;
+    size_t chunkLen = (numAlign + numThreads - 1) / numThreads * PARALLEL_ALIGN;
+
+    if (byteLen <= chunkLen) {
+        return calcCRC(data, byteLen);
+    }
+
+    ParallelChunk *chunks = (ParallelChunk *)calloc(numThreads, sizeof(ParallelChunk));
+    pthread_t *threads = (pthread_t *)calloc(numThreads, sizeof(pthread_t));
+    unsigned int numChunk = 0;
+
+    if (chunks == NULL || threads == NULL) {
+        printf("Unable to allocate %u workers\n", numThreads);
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t offset = 0; offset < byteLen; offset += chunkLen, ++numChunk) {
+        chunks[numChunk].data = data + offset;
+        chunks[numChunk].byteLen = (byteLen - offset < chunkLen) ? byteLen - offset : chunkLen;
+
+        if (pthread_create(&threads[numChunk], NULL, parallelWorker, &chunks[numChunk]) != 0) {
+            printf("Unable to create thread %u\n", numChunk);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    pthread_join(threads[0], NULL);
+    uint32_t checksum = chunks[0].crc;
+
+    for (unsigned int chunkIdx = 1; chunkIdx < numChunk; ++chunkIdx) {
+        pthread_join(threads[chunkIdx], NULL);
+        checksum = combineCRC(checksum, chunks[chunkIdx].crc, chunks[chunkIdx].byteLen);
+    }
+
+    free(threads);
+    free(chunks);
+    return checksum;
+}
@@ -0,0 +1,30 @@
+#ifndef __COMBINE_H__
+#define __COMBINE_H__
+
+#define SHIFT_OPS 64            // shift operators x^(8 * 2^k) mod P for k < SHIFT_OPS
+
+/*
+ *  Precomputed shift operators.
+ *  Shifting a CRC register over n zero bytes multiplies it by x^(8n) mod P.
+ *
+ *  NOTE : byteTable[n][j][b] is (b * x^(CRC - 8(j+1))) * x^(8n) mod P, so a shift
+ *         over n <= DATA_SIZE bytes is one lookup per register byte.
+ */
+typedef struct {
+    uint32_t byteShift[DATA_SIZE + 1];  // x^(8n) mod P for n <= DATA_SIZE
+    uint32_t powShift[SHIFT_OPS];       // x^(8 * 2^k) mod P
+    uint32_t byteTable[DATA_SIZE + 1][CRC / BYTE][TABLE_SIZE];
+} ShiftTable;
+
+extern ShiftTable shiftTable;
+
+void genShiftTable();
+uint32_t multModP(uint32_t a, uint32_t b);
+uint32_t getByteShift(uint64_t numBytes);
+uint32_t shiftCRC(uint32_t crc, uint64_t numBytes);
+uint32_t combineCRC(uint32_t crcA, uint32_t crcB, uint64_t lenB);
+bool updateCRCIncremental(uint32_t *checksum, size_t lineLen, size_t offset,
+    const uint8_t *oldBytes, const uint8_t *newBytes, size_t numBytes);
+uint32_t calcCRCParallel(const uint8_t *data, size_t byteLen, unsigned int numThreads);
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ *  Syndrome-indexed correction of single-bit and short-burst errors.
+ *
+ *  The codeword (CW_BITS bits) is far shorter than the period of the polynomial,
+ *  so every single-bit error, and every burst of a few bits, has its own
+ *  syndrome. The syndromes of all bursts up to maxBurst bits (both ends set) are
+ *  stored in an open-addressing hash table, so a received codeword with a
+ *  non-zero syndrome is corrected by one lookup instead of a retry.
+ *
+ *  NOTE : A syndrome shared by several correctable patterns is kept as
+ *         ambiguous and only detected. An uncorrectable error whose syndrome
+ *         is in the table is miscorrected; for random syndromes this happens
+ *         with probability numPattern / 2^32.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "correct.h"
+
+CorrectTable correctTable;
+
+static inline uint32_t hashSyndrome(uint32_t syndrome, unsigned int hashBits)
+{
+    return (syndrome * 0x9E3779B1u) >> (32 - hashBits);
+}
+
+/*
+ *  Function to add a correctable pattern to the table.
+ */
+static void addCorrection(CorrectTable *table, uint32_t syndrome, uint32_t pattern, unsigned int firstPos,
+    unsigned int burstLen)
+{
+    uint32_t slotMask = (1u << table->hashBits) - 1;
+    uint32_t slot = hashSyndrome(syndrome, table->hashBits);
+
+    while (table->entries[slot].burstLen != 0) {
+        CorrectEntry *entry = &table->entries[slot];
+
+        if (entry->syndrome == syndrome) {
+            if (!entry->ambiguous) {
+                entry->ambiguous = true;
+                table->numPattern--;
+                table->numAmbiguous++;
+            }
+            return;
+        }
+        slot = (slot + 1) & slotMask;
+    }
+
+    table->entries[slot].syndrome = syndrome;
+    table->entries[slot].pattern = pattern;
+    table->entries[slot].firstPos = (uint16_t)firstPos;
+    table->entries[slot].burstLen = (uint8_t)burstLen;
+    table->entries[slot].ambiguous = false;
+    table->numPattern++;
+}
+
+/*
+ *  Function to generate the correction table of all bursts up to maxBurst bits.
+ *
+ *  NOTE : A burst of L bits has both ends set, so there are 2^(L-2) of them at each position.
+ */
+void genCorrectTable(CorrectTable *table, const SyndromeTable *synTable, unsigned int maxBurst)
+{
+    uint64_t numCandidate = 0;
+
+    if (maxBurst == 0 || maxBurst > MAX_CORRECT_BURST) {
+        printf("Corrected burst length must be 1 to %d bits\n", MAX_CORRECT_BURST);
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int burstLen = 1; burstLen <= maxBurst; ++burstLen) {
+        numCandidate += (uint64_t)(CW_BITS - burstLen + 1) << (burstLen > 2 ? burstLen - 2 : 0);
+    }
+
+    memset(table, 0, sizeof(CorrectTable));
+    table->maxBurst = maxBurst;
+    table->hashBits = 1;
+    while (((uint64_t)1 << table->hashBits) < 2 * numCandidate) {
+        table->hashBits++;  // load factor <= 1/2
+    }
+
+    table->entries = (CorrectEntry *)calloc((size_t)1 << table->hashBits, sizeof(CorrectEntry));
+    if (table->entries == NULL) {
+        printf("Unable to allocate the correction table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int firstPos = 0; firstPos < CW_BITS; ++firstPos) {
+        for (unsigned int burstLen = 1; burstLen <= maxBurst && firstPos + burstLen <= CW_BITS; ++burstLen) {
+            uint32_t numMiddle = burstLen > 2 ? 1u << (burstLen - 2) : 1;
+
+            for (uint32_t middle = 0; middle < numMiddle; ++middle) {
+                uint32_t pattern = 1 | (1u << (burstLen - 1)) | (burstLen > 2 ? middle << 1 : 0);
+                uint32_t syndrome = 0;
+
+                for (unsigned int bitIdx = 0; bitIdx < burstLen; ++bitIdx) {
+                    if ((pattern >> bitIdx) & 1) {
+                        syndrome ^= synTable->bitSyndrome[firstPos + bitIdx];
+                    }
+                }
+
+                // An undetected pattern can not be corrected.
+                if (syndrome != 0) {
+                    addCorrection(table, syndrome, pattern, firstPos, burstLen);
+                }
+            }
+        }
+    }
+}
+
+void freeCorrectTable(CorrectTable *table)
+{
+    free(table->entries);
+    table->entries = NULL;
+}
+
+/*
+ *  Function to find the correctable pattern of a syndrome.
+ *  Returns NULL if the syndrome is zero, uncorrectable or ambiguous.
+ */
+const CorrectEntry *findCorrection(const CorrectTable *table, uint32_t syndrome)
+{
+    uint32_t slotMask = (1u << table->hashBits) - 1;
+    uint32_t slot = hashSyndrome(syndrome, table->hashBits);
+
+    if (syndrome == 0) {
+        return NULL;
+    }
+
+    while (table->entries[slot].burstLen != 0) {
+        const CorrectEntry *entry = &table->entries[slot];
+
+        if (entry->syndrome == syndrome) {
+            return entry->ambiguous ? NULL : entry;
+        }
+        slot = (slot + 1) & slotMask;
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to flip the bits of a correctable pattern in the codeword.
+ */
+void applyCorrection(const CorrectEntry *entry, uint8_t *codeword)
+{
+    for (unsigned int bitIdx = 0; bitIdx < entry->burstLen; ++bitIdx) {
+        if ((entry->pattern >> bitIdx) & 1) {
+            unsigned int pos = entry->firstPos + bitIdx;
+            codeword[pos / BYTE] ^= 0x80 >> (pos % BYTE);  // position 0 is the MSB
+        }
+    }
+}
+
+/*
+ *  Function to check if a correctable pattern is exactly the error vector.
+ *
+ *  NOTE : byteLen must not exceed CW_SIZE.
+ */
+bool matchCorrection(const CorrectEntry *entry, const uint8_t *error, size_t byteLen)
+{
+    uint8_t residue[CW_SIZE];
+
+    memcpy(residue, error, byteLen);
+    applyCorrection(entry, residue);
+
+    for (size_t byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
+        if (residue[byteIdx]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ *  Function to correct a received codeword of CW_SIZE bytes in place.
+ */
+CorrectStatus correctCodeword(const CorrectTable *table, uint8_t *codeword, size_t byteLen)
+{
+    size_t dataLen = byteLen - CRC / BYTE;
+    uint32_t syndrome = calcCRC(codeword, dataLen) ^ loadBE32(&codeword[dataLen]);
+    const CorrectEntry *entry;
+
+    if (syndrome == 0) {
+        return CORRECT_CLEAN;
+    }
+
+    entry = findCorrection(table, syndrome);
+    if (entry == NULL) {
+        return CORRECT_DETECTED;
+    }
+
+    applyCorrection(entry, codeword);
+    return CORRECT_FIXED;
+}
@@ -0,0 +1,48 @@
+#ifndef __CORRECT_H__
+#define __CORRECT_H__
+
+#define MAX_CORRECT_BURST 12    // limit of the corrected burst length (2^(L-2) patterns per position)
+
+/*
+ *  Error pattern of a syndrome in the correction table.
+ *
+ *  NOTE : Bit k of pattern is codeword bit firstPos + k (position 0 is the MSB of byte 0).
+ */
+typedef struct {
+    uint32_t syndrome;
+    uint32_t pattern;
+    uint16_t firstPos;
+    uint8_t burstLen;           // 0 for an empty slot
+    bool ambiguous;             // several correctable patterns share the syndrome
+} CorrectEntry;
+
+/*
+ *  Open-addressing hash table from syndrome to the correctable error pattern.
+ */
+typedef struct {
+    unsigned int maxBurst;      // bursts up to maxBurst bits are corrected
+    unsigned int hashBits;
+    uint64_t numPattern;        // correctable patterns (unambiguous syndromes)
+    uint64_t numAmbiguous;      // syndromes shared by several patterns (detected only)
+    CorrectEntry *entries;
+} CorrectTable;
+
+/*
+ *  Result of correcting a received codeword.
+ */
+typedef enum {
+    CORRECT_CLEAN,              // zero syndrome (no error, or an undetected one)
+    CORRECT_FIXED,              // a correctable pattern was flipped back
+    CORRECT_DETECTED            // uncorrectable error, needs a retry
+} CorrectStatus;
+
+extern CorrectTable correctTable;  // correction table for GEN_POLY
+
+void genCorrectTable(CorrectTable *table, const SyndromeTable *synTable, unsigned int maxBurst);
+void freeCorrectTable(CorrectTable *table);
+const CorrectEntry *findCorrection(const CorrectTable *table, uint32_t syndrome);
+void applyCorrection(const CorrectEntry *entry, uint8_t *codeword);
+bool matchCorrection(const CorrectEntry *entry, const uint8_t *error, size_t byteLen);
+CorrectStatus correctCodeword(const CorrectTable *table, uint8_t *codeword, size_t byteLen);
+
+#endif
@@ -1,159 +1,71 @@
 /*
- *  This program performs CRC32 checksum generation and error detection
- *  for a given set of data streams. There are three modes available.
- * 
- *    1) Simulation mode:
- *         Performs Monte Carlo simulation to evaluate the effectiveness of CRC32 
- *         error detection. Simulates random errors in codewords and checks 
- *         how well CRC32 can detect these errors.
- *  
- *    2) Table generation mode:
- *         Generates a CRC32 lookup table based on the given polynomial and 
- *         prints the table. Useful for precomputing CRC32 values for efficient 
- *         checksum calculation.
- *  
- *    3) Encoding mode:
- *         Serializes a data stream and computes the CRC32 checksum for the 
- *         serialized data. Outputs both the data and the corresponding checksum.
+ *  CRC32 engine of the program.
+ *
+ *  Lookup tables, slicing-by-N kernels and the bitwise reference of the CRC
+ *  given in crc32.h, and the kernel selection of calcCRC(). The program modes
+ *  are in main.c, and the context API for runtime specs is in the library
+ *  (crcctx.c, see sait_crc.h).
  */
 
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
-#include <time.h>
 #include <string.h>
 #include "crc32.h"
-#include "sim.h"
-
-uint32_t CRCTable[TABLE_SIZE] = {
-    0x00000000, 0x000000AF, 0x0000015E, 0x000001F1, 0x000002BC, 0x00000213, 0x000003E2, 0x0000034D, 
-    0x00000578, 0x000005D7, 0x00000426, 0x00000489, 0x000007C4, 0x0000076B, 0x0000069A, 0x00000635, 
-    0x00000AF0, 0x00000A5F, 0x00000BAE, 0x00000B01, 0x0000084C, 0x000008E3, 0x00000912, 0x000009BD, 
-    0x00000F88, 0x00000F27, 0x00000ED6, 0x00000E79, 0x00000D34, 0x00000D9B, 0x00000C6A, 0x00000CC5, 
-    0x000015E0, 0x0000154F, 0x000014BE, 0x00001411, 0x0000175C, 0x000017F3, 0x00001602, 0x000016AD, 
-    0x00001098, 0x00001037, 0x000011C6, 0x00001169, 0x00001224, 0x0000128B, 0x0000137A, 0x000013D5, 
-    0x00001F10, 0x00001FBF, 0x00001E4E, 0x00001EE1, 0x00001DAC, 0x00001D03, 0x00001CF2, 0x00001C5D, 
-    0x00001A68, 0x00001AC7, 0x00001B36, 0x00001B99, 0x000018D4, 0x0000187B, 0x0000198A, 0x00001925, 
-    0x00002BC0, 0x00002B6F, 0x00002A9E, 0x00002A31, 0x0000297C, 0x000029D3, 0x00002822, 0x0000288D, 
-    0x00002EB8, 0x00002E17, 0x00002FE6, 0x00002F49, 0x00002C04, 0x00002CAB, 0x00002D5A, 0x00002DF5, 
-    0x00002130, 0x0000219F, 0x0000206E, 0x000020C1, 0x0000238C, 0x00002323, 0x000022D2, 0x0000227D, 
-    0x00002448, 0x000024E7, 0x00002516, 0x000025B9, 0x000026F4, 0x0000265B, 0x000027AA, 0x00002705, 
-    0x00003E20, 0x00003E8F, 0x00003F7E, 0x00003FD1, 0x00003C9C, 0x00003C33, 0x00003DC2, 0x00003D6D, 
-    0x00003B58, 0x00003BF7, 0x00003A06, 0x00003AA9, 0x000039E4, 0x0000394B, 0x000038BA, 0x00003815, 
-    0x000034D0, 0x0000347F, 0x0000358E, 0x00003521, 0x0000366C, 0x000036C3, 0x00003732, 0x0000379D, 
-    0x000031A8, 0x00003107, 0x000030F6, 0x00003059, 0x00003314, 0x000033BB, 0x0000324A, 0x000032E5, 
-    0x00005780, 0x0000572F, 0x000056DE, 0x00005671, 0x0000553C, 0x00005593, 0x00005462, 0x000054CD, 
-    0x000052F8, 0x00005257, 0x000053A6, 0x00005309, 0x00005044, 0x000050EB, 0x0000511A, 0x000051B5, 
-    0x00005D70, 0x00005DDF, 0x00005C2E, 0x00005C81, 0x00005FCC, 0x00005F63, 0x00005E92, 0x00005E3D, 
-    0x00005808, 0x000058A7, 0x00005956, 0x000059F9, 0x00005AB4, 0x00005A1B, 0x00005BEA, 0x00005B45, 
-    0x00004260, 0x000042CF, 0x0000433E, 0x00004391, 0x000040DC, 0x00004073, 0x00004182, 0x0000412D, 
-    0x00004718, 0x000047B7, 0x00004646, 0x000046E9, 0x000045A4, 0x0000450B, 0x000044FA, 0x00004455, 
-    0x00004890, 0x0000483F, 0x000049CE, 0x00004961, 0x00004A2C, 0x00004A83, 0x00004B72, 0x00004BDD, 
-    0x00004DE8, 0x00004D47, 0x00004CB6, 0x00004C19, 0x00004F54, 0x00004FFB, 0x00004E0A, 0x00004EA5, 
-    0x00007C40, 0x00007CEF, 0x00007D1E, 0x00007DB1, 0x00007EFC, 0x00007E53, 0x00007FA2, 0x00007F0D, 
-    0x00007938, 0x00007997, 0x00007866, 0x000078C9, 0x00007B84, 0x00007B2B, 0x00007ADA, 0x00007A75, 
-    0x000076B0, 0x0000761F, 0x000077EE, 0x00007741, 0x0000740C, 0x000074A3, 0x00007552, 0x000075FD, 
-    0x000073C8, 0x00007367, 0x00007296, 0x00007239, 0x00007174, 0x000071DB, 0x0000702A, 0x00007085, 
-    0x000069A0, 0x0000690F, 0x000068FE, 0x00006851, 0x00006B1C, 0x00006BB3, 0x00006A42, 0x00006AED, 
-    0x00006CD8, 0x00006C77, 0x00006D86, 0x00006D29, 0x00006E64, 0x00006ECB, 0x00006F3A, 0x00006F95, 
-    0x00006350, 0x000063FF, 0x0000620E, 0x000062A1, 0x000061EC, 0x00006143, 0x000060B2, 0x0000601D, 
-    0x00006628, 0x00006687, 0x00006776, 0x000067D9, 0x00006494, 0x0000643B, 0x000065CA, 0x00006565,
-};
-
-int main(int argc, char *argv[]) {
-
-    ProgramMode mode = getMode(argc, argv);
-
-    switch (mode) {
-        // Simulation modes perform MonteCarlo simulation.
-        case MODE_SIMULATION : {
-            simulate(NUM_ITER);
-            break;
-        }
-
-        // Table generation modes generates and prints CRC lookup table.
-        case MODE_TABLE_GENERATION : {
-            genCRCTable();
-            printCRCTable();
-            break;
-        }
-
-        // Encoding mode generate CRC checksum for the input data stream.
-        case MODE_ENCODING : {
-            // Get input data chunk : read from 'data.txt'
-            uint32_t dataStream[GROUP_SIZE][BL];
-
-            FILE *inputFile = fopen("../src/data.txt", "r");
-            if (inputFile == NULL) {
-                printf("Unable to open data.txt\n");
-                return 1;
-            }
-            
-            for (int i = 0; i < GROUP_SIZE; ++i) {
-                for (int j = 0; j < BL; ++j) {
-                    fscanf(inputFile, "%x", &dataStream[i][j]);
-                }
-            }
+#include "fold.h"
+#include "syndrome.h"
+#include "batch.h"
+#include "combine.h"
+#include "crcspec.h"
 
-            fclose(inputFile);
+// Generated by the compiler from GEN_POLY (see crcspec.h).
+CRC_TABLE_DEFINE(CRC, const uint32_t, CRC, GEN_POLY, 0);
 
-            uint8_t* data = (uint8_t*)calloc(DATA_SIZE, sizeof(uint8_t));
+// SliceTable[k][b] is the CRC of byte 'b' followed by 'k' zero bytes.
+uint32_t SliceTable[SLICE_SIZE][TABLE_SIZE];
 
-            // Serialize data chunk into data
-            serialize(dataStream, data, DQ_SIZE, GROUP_SIZE);
+// Register update function used by calcCRC(), selected by initCRCEngine().
+CRCUpdateFunc CRCUpdate = updateCRCBitwise;
 
-            // Now encoding.
-            uint32_t checksum = calcCRC(data, DATA_SIZE);  // checksum for the received data
+/*
+ *  Function to get CRC kernel from program input arguments ('--kernel <name>').
+ */
+CRCKernel getKernel(int argc, char *argv[])
+{
+    for (int argIdx = 2; argIdx < argc - 1; ++argIdx) {
+        if (strcmp(argv[argIdx], "--kernel") != 0) {
+            continue;
+        }
 
-            // Show data and the calculated checksum.
-            printf("[Data] : ");
-            for (size_t byteIdx = 0; byteIdx < DATA_SIZE; ++byteIdx) {
-                printf("%02X", data[byteIdx]);
-                if (byteIdx % 4 == 3 && byteIdx != DATA_SIZE - 1) {
-                    printf("_");
-                }
+        const char *name = argv[argIdx + 1];
+        for (int kernel = KERNEL_BITWISE; kernel < NUM_KERNELS; ++kernel) {
+            if (strcmp(name, getKernelName((CRCKernel)kernel)) == 0) {
+                return (CRCKernel)kernel;
             }
-            printf("\n");
-            printf("[Checksum] : %08X\n", checksum);
-
-            free(data);
-            break;
         }
 
-        default : { // should not reach here
-            printf("Invalid program mode.\n");
-            exit(EXIT_FAILURE);
-        }
+        printf("Unknown kernel: %s\n", name);
+        exit(EXIT_FAILURE);
     }
 
-    return 0;
+    return KERNEL_AUTO;  // default kernel
 }
 
 /*
- *  Function to get mode from program input arguments.
+ *  Function to get the name of a CRC kernel.
  */
-ProgramMode getMode(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf("Usage: %s <mode>\n\n", argv[0]);
-        printf("Available modes: sim, table, enc\n");
-        printf("  + sim: simulation mode\n");
-        printf("  + table: table generation mode\n");
-        printf("  + enc: encoding mode\n");
-    }
-
-    if (strcmp(argv[1], "sim") == 0) {
-        return MODE_SIMULATION;
-    }
-    else if (strcmp(argv[1], "table") == 0) {
-        return MODE_TABLE_GENERATION;
-    }
-    else if (strcmp(argv[1], "enc") == 0) {
-        return MODE_ENCODING;
-    }
-    else {
-        printf("Unknown mode: %s\n", argv[1]);
-        exit(EXIT_FAILURE);
+const char *getKernelName(CRCKernel kernel)
+{
+    switch (kernel) {
+        case KERNEL_BITWISE : return "bitwise";
+        case KERNEL_TABLE   : return "table";
+        case KERNEL_SLICE8  : return "slice8";
+        case KERNEL_SLICE16 : return "slice16";
+        case KERNEL_FOLD    : return "fold";
+        case KERNEL_CLMUL   : return "clmul";
+        case KERNEL_AUTO    : return "auto";
+        default             : return "unknown";
     }
 }
 
@@ -198,10 +110,25 @@ void serialize(const uint32_t (*dataStream)[BL], uint8_t *data, size_t DQLen, si
     }
 }
 
+/*
+ *  Function to get the bit position in the serialized data of a DQ at a tick of a data stream.
+ *
+ *  NOTE : Follows the layout of serialize(). Bit position 0 is the MSB of data[0].
+ */
+unsigned int getSerialBitPos(unsigned int streamIdx, unsigned int tick, unsigned int dq)
+{
+    unsigned int byteIdx = (dq / BYTE) * (GROUP_SIZE * BL) + (tick % 4) * 4 + streamIdx * 2 + tick / 4;
+
+    return byteIdx * BYTE + dq % BYTE;
+}
+
 /*
  *  Function to generate a CRC lookup table for CRC32.
+ *
+ *  NOTE : The table is written to the caller's buffer. CRCTable itself is
+ *         generated by the compiler and never written, so it is thread-safe.
  */
-void genCRCTable()
+void genCRCTable(uint32_t *table)
 {
     uint32_t dividend;
     uint32_t MSBit;
@@ -227,23 +154,197 @@ void genCRCTable()
         }
 
         // The final dividend is a remainder.
-        CRCTable[byteValue] = dividend;
+        table[byteValue] = dividend;
     }
 }
 
 /*
  *  Function to print generated CRC32 lookup table.
  */
-void printCRCTable()
+void printCRCTable(const uint32_t *table)
 {
     for (int i = 0; i < CRC; ++i) {
         for (int j = 0; j < BYTE; ++j) {
-            printf("0x%08X, ", CRCTable[i*BYTE+j]);
+            printf("0x%08X, ", table[i*BYTE+j]);
         }
         printf("\n");
     }
 }
 
+/*
+ *  Function to print the specs and check their generated functions against the
+ *  catalog check values and the bitwise reference.
+ */
+void printCRCSpecs()
+{
+    const uint8_t *checkInput = (const uint8_t *)CRC_CHECK_INPUT;
+    size_t checkLen = strlen(CRC_CHECK_INPUT);
+    bool passed = true;
+
+    printf("%-14s %5s %18s %18s %5s %6s %18s %18s  %s\n", "Spec", "Width", "Poly", "Init", "RefIn", "RefOut",
+        "XorOut", "Check", "Result");
+
+    for (int specIdx = 0; specIdx < NUM_CRC_SPECS; ++specIdx) {
+        const CRCSpec *spec = CRCSpecs[specIdx];
+        uint64_t checksum = spec->calc(checkInput, checkLen);
+        uint64_t expected = spec->check ? spec->check : calcCRC(checkInput, checkLen);
+        bool match = (checksum == expected) && (checksum == calcCRCSpecBitwise(spec, checkInput, checkLen));
+
+        printf("%-14s %5u %#18llx %#18llx %5s %6s %#18llx %#18llx  %s\n", spec->name, spec->width,
+            (unsigned long long)spec->poly, (unsigned long long)spec->init, spec->refIn ? "true" : "false",
+            spec->refOut ? "true" : "false", (unsigned long long)spec->xorOut, (unsigned long long)checksum,
+            match ? "pass" : "FAIL");
+        passed = passed && match;
+    }
+
+    if (!passed) {
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ *  Function to generate extended lookup tables for slicing-by-N.
+ *
+ *  NOTE : SliceTable[0] is the CRC lookup table itself, and each next table
+ *         appends one zero byte to the previous one:
+ *           SliceTable[k][b] = (SliceTable[k-1][b] << 8) ^ CRCTable[SliceTable[k-1][b] >> 24]
+ */
+void genSliceTables()
+{
+    for (unsigned int byteValue = 0; byteValue < TABLE_SIZE; ++byteValue) {
+        SliceTable[0][byteValue] = CRCTable[byteValue];
+    }
+
+    for (unsigned int sliceIdx = 1; sliceIdx < SLICE_SIZE; ++sliceIdx) {
+        for (unsigned int byteValue = 0; byteValue < TABLE_SIZE; ++byteValue) {
+            uint32_t prev = SliceTable[sliceIdx - 1][byteValue];
+            SliceTable[sliceIdx][byteValue] = (prev << BYTE) ^ CRCTable[prev >> (CRC - BYTE)];
+        }
+    }
+}
+
+/*
+ *  Function to update the CRC register with slicing-by-8.
+ *
+ *  NOTE : The current CRC value is folded into the first 4 bytes of each 8-byte block,
+ *         so the 8 table lookups per block are independent of each other.
+ *         genSliceTables() must be called before use.
+ */
+uint32_t updateCRCSlice8(uint32_t crc_temp, const uint8_t *data, size_t byteLen)
+{
+    for (; byteLen >= 8; data += 8, byteLen -= 8) {
+        uint32_t hi = crc_temp ^ loadBE32(data);
+        uint32_t lo = loadBE32(data + 4);
+
+        crc_temp = SliceTable[7][hi >> 24] ^ SliceTable[6][(hi >> 16) & 0xFF] ^
+                   SliceTable[5][(hi >> 8) & 0xFF] ^ SliceTable[4][hi & 0xFF] ^
+                   SliceTable[3][lo >> 24] ^ SliceTable[2][(lo >> 16) & 0xFF] ^
+                   SliceTable[1][(lo >> 8) & 0xFF] ^ SliceTable[0][lo & 0xFF];
+    }
+
+    // Remaining bytes are processed one at a time.
+    for (; byteLen > 0; ++data, --byteLen) {
+        crc_temp = (crc_temp << BYTE) ^ SliceTable[0][(crc_temp >> (CRC - BYTE)) ^ *data];
+    }
+
+    return crc_temp;
+}
+
+/*
+ *  Function to update the CRC register with slicing-by-16.
+ *
+ *  NOTE : genSliceTables() must be called before use.
+ */
+uint32_t updateCRCSlice16(uint32_t crc_temp, const uint8_t *data, size_t byteLen)
+{
+    for (; byteLen >= 16; data += 16, byteLen -= 16) {
+        uint32_t w0 = crc_temp ^ loadBE32(data);
+        uint32_t w1 = loadBE32(data + 4);
+        uint32_t w2 = loadBE32(data + 8);
+        uint32_t w3 = loadBE32(data + 12);
+
+        crc_temp = SliceTable[15][w0 >> 24] ^ SliceTable[14][(w0 >> 16) & 0xFF] ^
+                   SliceTable[13][(w0 >> 8) & 0xFF] ^ SliceTable[12][w0 & 0xFF] ^
+                   SliceTable[11][w1 >> 24] ^ SliceTable[10][(w1 >> 16) & 0xFF] ^
+                   SliceTable[9][(w1 >> 8) & 0xFF] ^ SliceTable[8][w1 & 0xFF] ^
+                   SliceTable[7][w2 >> 24] ^ SliceTable[6][(w2 >> 16) & 0xFF] ^
+                   SliceTable[5][(w2 >> 8) & 0xFF] ^ SliceTable[4][w2 & 0xFF] ^
+                   SliceTable[3][w3 >> 24] ^ SliceTable[2][(w3 >> 16) & 0xFF] ^
+                   SliceTable[1][(w3 >> 8) & 0xFF] ^ SliceTable[0][w3 & 0xFF];
+    }
+
+    // Remaining bytes are processed one at a time.
+    for (; byteLen > 0; ++data, --byteLen) {
+        crc_temp = (crc_temp << BYTE) ^ SliceTable[0][(crc_temp >> (CRC - BYTE)) ^ *data];
+    }
+
+    return crc_temp;
+}
+
+/*
+ *  Function to calculate CRC checksum with slicing-by-8.
+ */
+uint32_t calcCRCSlice8(const uint8_t *data, size_t byteLen)
+{
+    return finalizeCRC(updateCRCSlice8(INIT_VAL, data, byteLen));
+}
+
+/*
+ *  Function to calculate CRC checksum with slicing-by-16.
+ */
+uint32_t calcCRCSlice16(const uint8_t *data, size_t byteLen)
+{
+    return finalizeCRC(updateCRCSlice16(INIT_VAL, data, byteLen));
+}
+
+/*
+ *  Function to initialize the CRC engine.
+ *
+ *  Generates lookup tables, folding constants and syndrome tables from GEN_POLY,
+ *  and selects the fastest kernel supported by this CPU for calcCRC().
+ */
+void initCRCEngine()
+{
+    genSliceTables();
+    genFoldConstants();
+    genSyndromeTable(&synTable, GEN_POLY);
+    genCoeffMatrix();
+    genShiftTable();
+
+    CRCUpdate = hasCLMUL() ? updateCRCClmul : updateCRCSlice16;
+}
+
+/*
+ *  Function to get the register update function of the given kernel.
+ *
+ *  NOTE : KERNEL_CLMUL falls back to the portable folding kernel
+ *         if the CPU does not support carry-less multiplication.
+ */
+CRCUpdateFunc getUpdateFunc(CRCKernel kernel)
+{
+    switch (kernel) {
+        case KERNEL_BITWISE : return updateCRCBitwise;
+        case KERNEL_SLICE8  : return updateCRCSlice8;
+        case KERNEL_SLICE16 : return updateCRCSlice16;
+        case KERNEL_FOLD    : return updateCRCFold;
+        case KERNEL_CLMUL   : return hasCLMUL() ? updateCRCClmul : updateCRCFold;
+        case KERNEL_AUTO    :
+        default             : return CRCUpdate;
+    }
+}
+
+/*
+ *  Function to calculate CRC checksum with the given kernel.
+ */
+uint32_t calcCRCWithKernel(CRCKernel kernel, const uint8_t *data, size_t byteLen)
+{
+    if (kernel == KERNEL_TABLE) {
+        return calcCRCWithTable(data, byteLen);
+    }
+
+    return finalizeCRC(getUpdateFunc(kernel)(INIT_VAL, data, byteLen));
+}
+
 /*
  *  Function to calculate CRC checksum using CRC lookup table.
  */
@@ -254,7 +355,7 @@ uint32_t calcCRCWithTable(const uint8_t *data, size_t byteLen)
 
     // Calculate CRC for each byte in the data.
     for (unsigned int byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
-        // TODO : reflect input
+        // Data enters MSB-first as in the RTL (reflected-input specs are in crcspec.h).
         byte = data[byteIdx];
 
         // The next crc value is determined by 
@@ -273,21 +374,22 @@ uint32_t calcCRCWithTable(const uint8_t *data, size_t byteLen)
 }
 
 /*
- *  Function to calculate CRC checksum.
+ *  Function to update the CRC register bit by bit.
+ *
+ *  NOTE : This is the reference implementation. All other kernels must match it.
  */
-uint32_t calcCRC(const uint8_t *data, size_t byteLen)
+uint32_t updateCRCBitwise(uint32_t crc_temp, const uint8_t *data, size_t byteLen)
 {
     uint8_t byte;
-    uint32_t crc_temp = INIT_VAL;
     uint32_t MSBit;
 
     // Calculate CRC for each byte in the data.
-    for (unsigned int byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
+    for (size_t byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
         byte = data[byteIdx];
 
-        crc_temp ^= (byte << (CRC - BYTE));
+        crc_temp ^= ((uint32_t)byte << (CRC - BYTE));
 
-        // TODO : reflect input
+        // Data enters MSB-first as in the RTL (reflected-input specs are in crcspec.h).
         for (unsigned int bitIdx = 0; bitIdx < BYTE; ++bitIdx) {
             MSBit = crc_temp & 0x80000000;
 
@@ -300,13 +402,26 @@ uint32_t calcCRC(const uint8_t *data, size_t byteLen)
         }
     }
 
-    // Reflect the result if needed.
-    crc_temp = REFLECT ? reflect(crc_temp) : crc_temp;
+    return crc_temp;
+}
 
-    // XOR to the result value.
-    crc_temp ^= XOR_VAL;
+/*
+ *  Function to calculate CRC checksum bit by bit (reference).
+ */
+uint32_t calcCRCBitwise(const uint8_t *data, size_t byteLen)
+{
+    return finalizeCRC(updateCRCBitwise(INIT_VAL, data, byteLen));
+}
 
-    return crc_temp;  // this is the checksum
+/*
+ *  Function to calculate CRC checksum.
+ *
+ *  NOTE : Uses the kernel selected by initCRCEngine().
+ *         Before initialization, it falls back to the bitwise reference.
+ */
+uint32_t calcCRC(const uint8_t *data, size_t byteLen)
+{
+    return finalizeCRC(CRCUpdate(INIT_VAL, data, byteLen));
 }
 
 /*
@@ -25,23 +25,93 @@
 #define CW_SIZE 68              // size of codeword in bytes
 #define BL 8                    // burst length
 
-extern uint32_t CRCTable[TABLE_SIZE];  // CRC lookup table
+#define SLICE_SIZE 16            // number of tables for slicing-by-N
+
+extern const uint32_t CRCTable[TABLE_SIZE];  // CRC lookup table (generated by the compiler)
+extern uint32_t SliceTable[SLICE_SIZE][TABLE_SIZE];  // extended tables for slicing-by-N
 
 /*
- *  Three modes of the program.
+ *  Modes of the program.
  */
 typedef enum {
     MODE_SIMULATION,
     MODE_TABLE_GENERATION,
-    MODE_ENCODING
+    MODE_ENCODING,
+    MODE_EXHAUSTIVE,
+    MODE_SEARCH,
+    MODE_STREAM,
+    MODE_BENCHMARK,
+    MODE_ANALYZE,
+    MODE_MERGE,
+    MODE_SWEEP
 } ProgramMode;
 
+/*
+ *  CRC calculation kernels.
+ *  All kernels produce bit-identical checksums.
+ */
+typedef enum {
+    KERNEL_BITWISE,     // bit-serial reference (calcCRCBitwise)
+    KERNEL_TABLE,       // byte-at-a-time table lookup (calcCRCWithTable)
+    KERNEL_SLICE8,      // slicing-by-8
+    KERNEL_SLICE16,     // slicing-by-16
+    KERNEL_FOLD,        // carry-less multiply folding (portable)
+    KERNEL_CLMUL,       // carry-less multiply folding (x86 PCLMULQDQ)
+    KERNEL_AUTO,        // best kernel for this CPU (calcCRC)
+    NUM_KERNELS
+} CRCKernel;
+
+/*
+ *  Function type to update the CRC register over the data.
+ *  The register is neither reflected nor XORed with XOR_VAL.
+ */
+typedef uint32_t (*CRCUpdateFunc)(uint32_t crc, const uint8_t *data, size_t byteLen);
+
+extern CRCUpdateFunc CRCUpdate;  // register update function used by calcCRC()
+
 ProgramMode getMode(int argc, char *argv[]);
+char *getOptionValue(int argc, char *argv[], int *argIdx);
+void exitUnknownOption(char *argv[], int argIdx);
+CRCKernel getKernel(int argc, char *argv[]);
+const char *getKernelName(CRCKernel kernel);
 void serialize(const uint32_t (*dataStream)[BL], uint8_t *data, size_t DQLen, size_t groupLen);
-void genCRCTable();
-void printCRCTable();
+unsigned int getSerialBitPos(unsigned int streamIdx, unsigned int tick, unsigned int dq);
+void genCRCTable(uint32_t *table);
+void printCRCTable(const uint32_t *table);
+void printCRCSpecs();
+void genSliceTables();
+void initCRCEngine();
+CRCUpdateFunc getUpdateFunc(CRCKernel kernel);
+uint32_t updateCRCBitwise(uint32_t crc, const uint8_t *data, size_t byteLen);
+uint32_t updateCRCSlice8(uint32_t crc, const uint8_t *data, size_t byteLen);
+uint32_t updateCRCSlice16(uint32_t crc, const uint8_t *data, size_t byteLen);
 uint32_t calcCRCWithTable(const uint8_t *data, size_t byteLen);
+uint32_t calcCRCSlice8(const uint8_t *data, size_t byteLen);
+uint32_t calcCRCSlice16(const uint8_t *data, size_t byteLen);
+uint32_t calcCRCWithKernel(CRCKernel kernel, const uint8_t *data, size_t byteLen);
+uint32_t calcCRCBitwise(const uint8_t *data, size_t byteLen);
 uint32_t calcCRC(const uint8_t *data, size_t byteLen);
 uint32_t reflect(uint32_t value);
 
+/*
+ *  Function to load 4 bytes as a big-endian (MSB-first) 32-bit word.
+ */
+static inline uint32_t loadBE32(const uint8_t *data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+           ((uint32_t)data[2] << 8)  |  (uint32_t)data[3];
+}
+
+/*
+ *  Function to apply output reflection and final XOR to the CRC register.
+ */
+static inline uint32_t finalizeCRC(uint32_t crc_temp)
+{
+    // Reflect the result if needed.
+    crc_temp = REFLECT ? reflect(crc_temp) : crc_temp;
+
+    // XOR to the result value.
+    return crc_temp ^ XOR_VAL;
+}
+
 #endif  /* __CRC32_H__ */
\ No newline at end of file
@@ -0,0 +1,212 @@
+/*
+ *  CRC context API of the library (see sait_crc.h).
+ *
+ *  The CRC engine of crc32.c is built for the spec of crc32.h and keeps its tables
+ *  in globals set by initCRCEngine(). A context instead carries its own spec and
+ *  tables, so any 32-bit spec can be used at run time, and contexts of different
+ *  specs can be used side by side from many threads. The library is built from
+ *  this file and crcspec.c only, so it shares no state with the program.
+ *
+ *    1) initCRCContext()       : generates the tables of a spec into the context.
+ *    2) encodeCRCWithContext() : writes data and checksum to the caller's codeword.
+ *    3) checkCRCWithContext()  : checks the checksum of a received codeword.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "crcspec.h"
+
+_Static_assert(CRC_CONTEXT_SLICES == SLICE_SIZE && CRC_CONTEXT_TABLE == TABLE_SIZE,
+    "context tables must match the slicing-by-16 tables of crc32.h");
+
+/*
+ *  Function to load 4 bytes as a little-endian (LSB-first) 32-bit word.
+ */
+static inline uint32_t loadLE32(const uint8_t *data)
+{
+    return (uint32_t)data[0]         | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+/*
+ *  Function to initialize a context with a spec.
+ *  Returns false if the spec is not supported (the width must be 32).
+ *
+ *  NOTE : The context must not be used by other threads while it is initialized.
+ */
+bool initCRCContext(CRCContext *ctx, const CRCSpec *spec)
+{
+    if (spec == NULL || spec->width != CRC) {
+        return false;
+    }
+
+    ctx->spec = *spec;
+
+    uint32_t poly = (uint32_t)spec->poly;
+    uint32_t reflectedPoly = (uint32_t)CRC_REFLECT(CRC, poly);
+
+    ctx->init = spec->refIn ? (uint32_t)CRC_REFLECT(CRC, spec->init) : (uint32_t)spec->init;
+
+    // Table of a single byte, in the bit order of the register.
+    for (unsigned int byteValue = 0; byteValue < TABLE_SIZE; ++byteValue) {
+        uint32_t remainder = spec->refIn ? byteValue : (uint32_t)byteValue << (CRC - BYTE);
+
+        for (unsigned int bitIdx = 0; bitIdx < BYTE; ++bitIdx) {
+            if (spec->refIn) {
+                remainder = (remainder >> 1) ^ ((0 - (remainder & 1)) & reflectedPoly);
+            }
+            else {
+                remainder = (remainder << 1) ^ ((0 - (remainder >> (CRC - 1))) & poly);
+            }
+        }
+        ctx->table[0][byteValue] = remainder;
+    }
+
+    // Each next table appends one zero byte to the previous one (see genSliceTables()).
+    for (unsigned int sliceIdx = 1; sliceIdx < SLICE_SIZE; ++sliceIdx) {
+        for (unsigned int byteValue = 0; byteValue < TABLE_SIZE; ++byteValue) {
+            uint32_t prev = ctx->table[sliceIdx - 1][byteValue];
+
+            if (spec->refIn) {
+                ctx->table[sliceIdx][byteValue] = (prev >> BYTE) ^ ctx->table[0][prev & 0xFF];
+            }
+            else {
+                ctx->table[sliceIdx][byteValue] = (prev << BYTE) ^ ctx->table[0][prev >> (CRC - BYTE)];
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+ *  Function to update the CRC register of a MSB-first spec with slicing-by-16.
+ */
+static uint32_t updateCRCNormal(const uint32_t (*table)[TABLE_SIZE], uint32_t crc, const uint8_t *data, size_t byteLen)
+{
+    for (; byteLen >= 16; data += 16, byteLen -= 16) {
+        uint32_t w0 = crc ^ loadBE32(data);
+        uint32_t w1 = loadBE32(data + 4);
+        uint32_t w2 = loadBE32(data + 8);
+        uint32_t w3 = loadBE32(data + 12);
+
+        crc = table[15][w0 >> 24] ^ table[14][(w0 >> 16) & 0xFF] ^
+              table[13][(w0 >> 8) & 0xFF] ^ table[12][w0 & 0xFF] ^
+              table[11][w1 >> 24] ^ table[10][(w1 >> 16) & 0xFF] ^
+              table[9][(w1 >> 8) & 0xFF] ^ table[8][w1 & 0xFF] ^
+              table[7][w2 >> 24] ^ table[6][(w2 >> 16) & 0xFF] ^
+              table[5][(w2 >> 8) & 0xFF] ^ table[4][w2 & 0xFF] ^
+              table[3][w3 >> 24] ^ table[2][(w3 >> 16) & 0xFF] ^
+              table[1][(w3 >> 8) & 0xFF] ^ table[0][w3 & 0xFF];
+    }
+
+    // Remaining bytes are processed one at a time.
+    for (; byteLen > 0; ++data, --byteLen) {
+        crc = (crc << BYTE) ^ table[0][(crc >> (CRC - BYTE)) ^ *data];
+    }
+
+    return crc;
+}
+
+/*
+ *  Function to update the CRC register of a reflected-input spec with slicing-by-16.
+ *
+ *  NOTE : The register is in reflected order, so the first byte of a word is its low byte.
+ */
+static uint32_t updateCRCReflected(const uint32_t (*table)[TABLE_SIZE], uint32_t crc, const uint8_t *data, size_t byteLen)
+{
+    for (; byteLen >= 16; data += 16, byteLen -= 16) {
+        uint32_t w0 = crc ^ loadLE32(data);
+        uint32_t w1 = loadLE32(data + 4);
+        uint32_t w2 = loadLE32(data + 8);
+        uint32_t w3 = loadLE32(data + 12);
+
+        crc = table[15][w0 & 0xFF] ^ table[14][(w0 >> 8) & 0xFF] ^
+              table[13][(w0 >> 16) & 0xFF] ^ table[12][w0 >> 24] ^
+              table[11][w1 & 0xFF] ^ table[10][(w1 >> 8) & 0xFF] ^
+              table[9][(w1 >> 16) & 0xFF] ^ table[8][w1 >> 24] ^
+              table[7][w2 & 0xFF] ^ table[6][(w2 >> 8) & 0xFF] ^
+              table[5][(w2 >> 16) & 0xFF] ^ table[4][w2 >> 24] ^
+              table[3][w3 & 0xFF] ^ table[2][(w3 >> 8) & 0xFF] ^
+              table[1][(w3 >> 16) & 0xFF] ^ table[0][w3 >> 24];
+    }
+
+    // Remaining bytes are processed one at a time.
+    for (; byteLen > 0; ++data, --byteLen) {
+        crc = (crc >> BYTE) ^ table[0][(crc ^ *data) & 0xFF];
+    }
+
+    return crc;
+}
+
+/*
+ *  Function to update the CRC register of a context over the data.
+ *
+ *  NOTE : Start from ctx->init. The register is neither reflected nor XORed with xorOut,
+ *         so the data can be given in pieces.
+ */
+uint32_t updateCRCWithContext(const CRCContext *ctx, uint32_t crc, const uint8_t *data, size_t byteLen)
+{
+    if (ctx->spec.refIn) {
+        return updateCRCReflected(ctx->table, crc, data, byteLen);
+    }
+
+    return updateCRCNormal(ctx->table, crc, data, byteLen);
+}
+
+/*
+ *  Function to apply output reflection and final XOR of a context to the CRC register.
+ */
+uint32_t finalizeCRCWithContext(const CRCContext *ctx, uint32_t crc)
+{
+    // The register is in reflected order if refIn, so it is reflected once more only if refOut differs.
+    crc = (ctx->spec.refIn != ctx->spec.refOut) ? (uint32_t)CRC_REFLECT(CRC, crc) : crc;
+
+    return crc ^ (uint32_t)ctx->spec.xorOut;
+}
+
+/*
+ *  Function to calculate CRC checksum with a context.
+ */
+uint32_t calcCRCWithContext(const CRCContext *ctx, const uint8_t *data, size_t byteLen)
+{
+    return finalizeCRCWithContext(ctx, updateCRCWithContext(ctx, ctx->init, data, byteLen));
+}
+
+/*
+ *  Function to make a codeword of the data with a context.
+ *
+ *  NOTE : The codeword must have room for dataLen + CRC/BYTE bytes.
+ *         It may be the data buffer itself, then only the checksum is written.
+ */
+void encodeCRCWithContext(const CRCContext *ctx, const uint8_t *data, size_t dataLen, uint8_t *codeword)
+{
+    uint32_t checksum = calcCRCWithContext(ctx, data, dataLen);
+
+    if (codeword != data) {
+        memmove(codeword, data, dataLen);
+    }
+
+    for (int byteIdx = 0; byteIdx < CRC / BYTE; ++byteIdx) {
+        codeword[dataLen + byteIdx] = (uint8_t)(checksum >> (CRC - BYTE * (byteIdx + 1)));
+    }
+}
+
+/*
+ *  Function to check if the checksum of a codeword matches its data.
+ *  Returns false if an error is detected, or if the codeword is shorter than a checksum.
+ */
+bool checkCRCWithContext(const CRCContext *ctx, const uint8_t *codeword, size_t byteLen)
+{
+    if (byteLen < CRC / BYTE) {
+        return false;
+    }
+
+    size_t dataLen = byteLen - CRC / BYTE;
+
+    return calcCRCWithContext(ctx, codeword, dataLen) == loadBE32(&codeword[dataLen]);
+}
@@ -0,0 +1,76 @@
+/*
+ *  CRC specs of the generic engine (see crcspec.h).
+ *
+ *  Catalog specs for metadata fields (CRC-8/16/32/64), and CRC32Sait built from
+ *  the CRC32 specification of crc32.h. The codeword engine of crc32.c feeds data
+ *  MSB-first as the RTL does, so CRC32Sait takes REFLECT as output reflection only.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "crcspec.h"
+
+// Check values are from the catalog; CRC32Sait has none (0), and is checked against calcCRC().
+//              name          label            type      W   poly                init                refIn refOut   xorOut              check
+CRC_SPEC_DEFINE(CRC8Smbus,    "crc8-smbus",    uint8_t,   8, 0x07,               0x00,               0,    0,       0x00,               0xF4)
+CRC_SPEC_DEFINE(CRC16Ibm3740, "crc16-ibm3740", uint16_t, 16, 0x1021,             0xFFFF,             0,    0,       0x0000,             0x29B1)
+CRC_SPEC_DEFINE(CRC16Arc,     "crc16-arc",     uint16_t, 16, 0x8005,             0x0000,             1,    1,       0x0000,             0xBB3D)
+CRC_SPEC_DEFINE(CRC32IsoHdlc, "crc32-isohdlc", uint32_t, 32, 0x04C11DB7,         0xFFFFFFFF,         1,    1,       0xFFFFFFFF,         0xCBF43926)
+CRC_SPEC_DEFINE(CRC32Iscsi,   "crc32-iscsi",   uint32_t, 32, 0x1EDC6F41,         0xFFFFFFFF,         1,    1,       0xFFFFFFFF,         0xE3069283)
+CRC_SPEC_DEFINE(CRC32Sait,    "crc32-sait",    uint32_t, 32, GEN_POLY,           INIT_VAL,           0,    REFLECT, XOR_VAL,            0)
+CRC_SPEC_DEFINE(CRC64Xz,      "crc64-xz",      uint64_t, 64, 0x42F0E1EBA9EA3693, 0xFFFFFFFFFFFFFFFF, 1,    1,       0xFFFFFFFFFFFFFFFF, 0x995DC9BBDF1939FA)
+CRC_SPEC_DEFINE(CRC64Ecma182, "crc64-ecma182", uint64_t, 64, 0x42F0E1EBA9EA3693, 0x0000000000000000, 0,    0,       0x0000000000000000, 0x6C40DF5F0B497347)
+
+const CRCSpec *const CRCSpecs[NUM_CRC_SPECS] = {
+    &CRC8SmbusSpec, &CRC16Ibm3740Spec, &CRC16ArcSpec, &CRC32IsoHdlcSpec,
+    &CRC32IscsiSpec, &CRC32SaitSpec, &CRC64XzSpec, &CRC64Ecma182Spec,
+};
+
+/*
+ *  Function to get a spec by name. Returns NULL if unknown.
+ */
+const CRCSpec *getCRCSpec(const char *name)
+{
+    for (int specIdx = 0; specIdx < NUM_CRC_SPECS; ++specIdx) {
+        if (strcmp(name, CRCSpecs[specIdx]->name) == 0) {
+            return CRCSpecs[specIdx];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to calculate the checksum of a spec bit by bit (reference).
+ *
+ *  NOTE : Unlike the generated functions, every parameter is read at run time.
+ */
+uint64_t calcCRCSpecBitwise(const CRCSpec *spec, const uint8_t *data, size_t byteLen)
+{
+    uint64_t mask = CRC_MASK(spec->width);
+    uint64_t topBit = (uint64_t)1 << (spec->width - 1);
+    uint64_t crc = spec->init & mask;
+
+    for (size_t byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
+        for (unsigned int bitIdx = 0; bitIdx < BYTE; ++bitIdx) {
+            // Reflected input feeds the LSB of each byte first.
+            unsigned int bit = spec->refIn ? (data[byteIdx] >> bitIdx) & 1 : (data[byteIdx] >> (BYTE - 1 - bitIdx)) & 1;
+            bool feedback = ((crc & topBit) != 0) != bit;
+
+            crc = (crc << 1) & mask;
+            if (feedback) {
+                crc ^= spec->poly;
+            }
+        }
+    }
+
+    if (spec->refOut) {
+        crc = CRC_REFLECT(spec->width, crc);
+    }
+
+    return (crc ^ spec->xorOut) & mask;
+}
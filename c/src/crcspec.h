@@ -0,0 +1,144 @@
+#ifndef __CRCSPEC_H__
+#define __CRCSPEC_H__
+
+#include "sait_crc.h"
+
+/*
+ *  Width- and spec-generic CRC engine.
+ *
+ *  A spec is defined once with CRC_SPEC_DEFINE() and gets its own lookup table,
+ *  functions and CRCSpec descriptor (<name>Spec), with every parameter a literal. The table is a list of 256 constant
+ *  expressions, so it is computed by the compiler from the polynomial and never goes
+ *  stale, and the reflect/XOR choices are folded out of the byte loop.
+ *
+ *    - update<Name>(crc, data, byteLen) : updates the register (reflected if refIn)
+ *    - calc<Name>(data, byteLen)        : checksum of the data
+ *
+ *  CRCSpec, getCRCSpec() and calcCRCSpecBitwise() are part of the public API (sait_crc.h).
+ *
+ *  NOTE : Widths are 8 to 64 bits. refIn must be the literal 0 or 1 (it selects the table).
+ *         The polynomial is in normal form (MSB-first, without the highest "1").
+ */
+
+#define NUM_CRC_SPECS 8
+#define CRC_CHECK_INPUT "123456789"     // input of the catalog check values
+
+#define CRC_MASK(W) ((((uint64_t)1 << ((W) - 1)) << 1) - 1)
+
+// Bit reflection of a W-bit value.
+#define CRC_REFLECT_BIT(Q, i) ((((Q) >> (63 - (i))) & 1) << (i))
+#define CRC_REFLECT_4(Q, i) (CRC_REFLECT_BIT(Q, i) | CRC_REFLECT_BIT(Q, (i) + 1) | \
+                             CRC_REFLECT_BIT(Q, (i) + 2) | CRC_REFLECT_BIT(Q, (i) + 3))
+#define CRC_REFLECT_16(Q, i) (CRC_REFLECT_4(Q, i) | CRC_REFLECT_4(Q, (i) + 4) | \
+                              CRC_REFLECT_4(Q, (i) + 8) | CRC_REFLECT_4(Q, (i) + 12))
+#define CRC_REFLECT_64(Q) (CRC_REFLECT_16(Q, 0) | CRC_REFLECT_16(Q, 16) | \
+                           CRC_REFLECT_16(Q, 32) | CRC_REFLECT_16(Q, 48))
+#define CRC_REFLECT(W, v) CRC_REFLECT_64((uint64_t)(v) << (64 - (W)))
+
+// One bit step of the register: MSB-first (table 0) or reflected (table 1).
+#define CRC_STEP_0(W, P, r) ((((r) << 1) ^ ((0 - (((r) >> ((W) - 1)) & 1)) & (P))) & CRC_MASK(W))
+#define CRC_STEP_1(W, P, r) (((r) >> 1) ^ ((0 - ((r) & 1)) & (P)))
+#define CRC_STEP_8(S, W, P, r) S(W, P, S(W, P, S(W, P, S(W, P, S(W, P, S(W, P, S(W, P, S(W, P, r))))))))
+
+// Table entry of byte b. The reflected table takes the reflected polynomial.
+#define CRC_ENTRY_0(W, P, b) CRC_STEP_8(CRC_STEP_0, W, P, (uint64_t)(b) << ((W) - 8))
+#define CRC_ENTRY_1(W, P, b) CRC_STEP_8(CRC_STEP_1, W, P, (uint64_t)(b))
+
+/*
+ *  Constants of a table, as 16-bit enum constants so that every use is a single name:
+ *  the reflected polynomial, and the entries of the 8 single-bit bytes (basis).
+ *
+ *  NOTE : A table with zero initial value is linear, so the entry of byte b is the XOR
+ *         of the basis entries of its set bits. Expanding the 8 bit steps for every
+ *         entry instead would make the compiler fold 256 times larger expressions.
+ */
+#define CRC_CHUNKS(prefix, value) prefix##_0 = (int)((value) & 0xFFFF), prefix##_1 = (int)(((value) >> 16) & 0xFFFF), \
+                                  prefix##_2 = (int)(((value) >> 32) & 0xFFFF), prefix##_3 = (int)(((value) >> 48) & 0xFFFF)
+#define CRC_UNCHUNK(prefix) ((uint64_t)prefix##_0 | ((uint64_t)prefix##_1 << 16) | \
+                             ((uint64_t)prefix##_2 << 32) | ((uint64_t)prefix##_3 << 48))
+
+#define CRC_TABLE_POLY_0(poly, W, P) ((uint64_t)(P))
+#define CRC_TABLE_POLY_1(poly, W, P) CRC_UNCHUNK(poly)
+
+#define CRC_TABLE_DEFINE(name, type, W, P, REFIN)                                                   \
+    enum {                                                                                          \
+        CRC_CHUNKS(name##Poly, CRC_REFLECT(W, P)),                                                  \
+        CRC_CHUNKS(name##Basis0, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x01)),   \
+        CRC_CHUNKS(name##Basis1, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x02)),   \
+        CRC_CHUNKS(name##Basis2, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x04)),   \
+        CRC_CHUNKS(name##Basis3, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x08)),   \
+        CRC_CHUNKS(name##Basis4, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x10)),   \
+        CRC_CHUNKS(name##Basis5, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x20)),   \
+        CRC_CHUNKS(name##Basis6, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x40)),   \
+        CRC_CHUNKS(name##Basis7, CRC_ENTRY_##REFIN(W, CRC_TABLE_POLY_##REFIN(name##Poly, W, P), 0x80))    \
+    };                                                                                              \
+    type name##Table[256] = { CRC_TABLE_256(name##Basis) }
+
+#define CRC_BIT_TERM(basis, b, i) ((0 - (((uint64_t)(b) >> (i)) & 1)) & CRC_UNCHUNK(basis##i))
+#define CRC_LINEAR_ENTRY(basis, b) (CRC_BIT_TERM(basis, b, 0) ^ CRC_BIT_TERM(basis, b, 1) ^ CRC_BIT_TERM(basis, b, 2) ^ \
+                                    CRC_BIT_TERM(basis, b, 3) ^ CRC_BIT_TERM(basis, b, 4) ^ CRC_BIT_TERM(basis, b, 5) ^ \
+                                    CRC_BIT_TERM(basis, b, 6) ^ CRC_BIT_TERM(basis, b, 7))
+
+#define CRC_TABLE_4(basis, b) CRC_LINEAR_ENTRY(basis, (b)), CRC_LINEAR_ENTRY(basis, (b) + 1), \
+                              CRC_LINEAR_ENTRY(basis, (b) + 2), CRC_LINEAR_ENTRY(basis, (b) + 3)
+#define CRC_TABLE_16(basis, b) CRC_TABLE_4(basis, b), CRC_TABLE_4(basis, (b) + 4), \
+                               CRC_TABLE_4(basis, (b) + 8), CRC_TABLE_4(basis, (b) + 12)
+#define CRC_TABLE_64(basis, b) CRC_TABLE_16(basis, b), CRC_TABLE_16(basis, (b) + 16), \
+                               CRC_TABLE_16(basis, (b) + 32), CRC_TABLE_16(basis, (b) + 48)
+#define CRC_TABLE_256(basis) CRC_TABLE_64(basis, 0), CRC_TABLE_64(basis, 64), \
+                             CRC_TABLE_64(basis, 128), CRC_TABLE_64(basis, 192)
+
+#define CRC_SPEC_DECLARE(name, type)                                                                \
+    extern const CRCSpec name##Spec;                                                                \
+    extern const type name##Table[256];                                                             \
+    type update##name(type crc, const uint8_t *data, size_t byteLen);                               \
+    type calc##name(const uint8_t *data, size_t byteLen)
+
+#define CRC_SPEC_DEFINE(name, label, type, W, P, INIT, REFIN, REFOUT, XOROUT, CHECK)                \
+    _Static_assert((W) >= 8 && (W) <= 64 && (W) <= 8 * sizeof(type), "unsupported CRC width");      \
+    CRC_TABLE_DEFINE(name, const type, W, P, REFIN);                                                \
+                                                                                                    \
+    type update##name(type crc, const uint8_t *data, size_t byteLen)                                \
+    {                                                                                               \
+        for (; byteLen > 0; ++data, --byteLen) {                                                    \
+            if (REFIN) {                                                                            \
+                crc = (type)(((uint64_t)crc >> 8) ^ name##Table[(crc ^ *data) & 0xFF]);             \
+            }                                                                                       \
+            else {                                                                                  \
+                crc = (type)((((uint64_t)crc << 8) & CRC_MASK(W)) ^                                 \
+                    name##Table[(((uint64_t)crc >> ((W) - 8)) ^ *data) & 0xFF]);                    \
+            }                                                                                       \
+        }                                                                                           \
+        return crc;                                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    type calc##name(const uint8_t *data, size_t byteLen)                                            \
+    {                                                                                               \
+        uint64_t crc = update##name((type)((REFIN) ? CRC_REFLECT(W, INIT) : (INIT)), data, byteLen); \
+                                                                                                    \
+        /* The register is in reflected order if refIn, so it is reflected once more          */   \
+        /* only if refOut differs.                                                              */   \
+        crc = ((REFIN) != (REFOUT)) ? CRC_REFLECT(W, crc) : crc;                                    \
+        return (type)((crc ^ (XOROUT)) & CRC_MASK(W));                                              \
+    }                                                                                               \
+                                                                                                    \
+    static uint64_t calc##name##Wide(const uint8_t *data, size_t byteLen)                           \
+    {                                                                                               \
+        return calc##name(data, byteLen);                                                           \
+    }                                                                                               \
+                                                                                                    \
+    const CRCSpec name##Spec = { label, W, P, INIT, REFIN, REFOUT, XOROUT, CHECK, calc##name##Wide };
+
+extern const CRCSpec *const CRCSpecs[NUM_CRC_SPECS];
+
+CRC_SPEC_DECLARE(CRC8Smbus, uint8_t);
+CRC_SPEC_DECLARE(CRC16Ibm3740, uint16_t);
+CRC_SPEC_DECLARE(CRC16Arc, uint16_t);
+CRC_SPEC_DECLARE(CRC32IsoHdlc, uint32_t);
+CRC_SPEC_DECLARE(CRC32Iscsi, uint32_t);
+CRC_SPEC_DECLARE(CRC32Sait, uint32_t);
+CRC_SPEC_DECLARE(CRC64Xz, uint64_t);
+CRC_SPEC_DECLARE(CRC64Ecma182, uint64_t);
+
+
+#endif
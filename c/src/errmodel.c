@@ -0,0 +1,305 @@
+/*
+ *  DRAM-structured error models.
+ *
+ *  The observed failures of a memory channel follow the serialization of the
+ *  DQ/beat data (see serialize()): a dead DQ pin, a short of two adjacent pins,
+ *  a single beat across all DQs, or a whole x4/x8 device. Each fault class is a
+ *  set of regions of the codeword, and a fault only flips bits of one region.
+ *
+ *  CRC is linear, so the syndrome of a fault is the XOR of the syndromes of its
+ *  bits. The syndromes of every 8 bits of every region are precomputed for all
+ *  256 values, so a fault costs one lookup per 8 bits of its region (2 for a pin,
+ *  16 for an x8 device) instead of a CRC over the codeword.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "search.h"
+#include "errmodel.h"
+
+FaultCache faultCache;
+
+static const char *errorModelName[NUM_ERROR_MODELS] = { "burst", "random", "pin", "adj-pin", "beat", "x4", "x8" };
+
+/*
+ *  Function to get an error model by name. Returns NUM_ERROR_MODELS if unknown.
+ */
+ErrorModel getErrorModel(const char *name)
+{
+    for (int model = 0; model < NUM_ERROR_MODELS; ++model) {
+        if (strcmp(name, errorModelName[model]) == 0) {
+            return (ErrorModel)model;
+        }
+    }
+
+    return NUM_ERROR_MODELS;
+}
+
+/*
+ *  Function to get the name of an error model.
+ */
+const char *getErrorModelName(ErrorModel model)
+{
+    return (model < NUM_ERROR_MODELS) ? errorModelName[model] : "unknown";
+}
+
+/*
+ *  Function to check if an error model is a DRAM fault model.
+ */
+bool isFaultModel(ErrorModel model)
+{
+    return model >= ERROR_PIN && model < NUM_ERROR_MODELS;
+}
+
+/*
+ *  Function to get the number of regions of a DRAM fault model.
+ */
+unsigned int getNumFaultRegion(ErrorModel model)
+{
+    switch (model) {
+        case ERROR_PIN     : return DQ_SIZE;
+        case ERROR_ADJ_PIN : return DQ_SIZE - 1;
+        case ERROR_BEAT    : return GROUP_SIZE * BL;
+        case ERROR_X4      : return DQ_SIZE / 4;
+        case ERROR_X8      : return DQ_SIZE / 8;
+        default            : return 0;
+    }
+}
+
+/*
+ *  Function to get the codeword bit positions of a region of a DRAM fault model.
+ *  Returns the number of positions.
+ *
+ *  NOTE : Regions of DQs list the beats of each DQ in turn, so the two pins of
+ *         an adjacent-pin short are the two halves of the region.
+ */
+unsigned int getFaultRegion(ErrorModel model, unsigned int regionIdx, unsigned int *positions)
+{
+    unsigned int firstDQ = regionIdx;
+    unsigned int numDQ = 1;
+    unsigned int numPos = 0;
+
+    switch (model) {
+        case ERROR_BEAT : {
+            for (unsigned int dq = 0; dq < DQ_SIZE; ++dq) {
+                positions[numPos++] = getSerialBitPos(regionIdx / BL, regionIdx % BL, dq);
+            }
+            return numPos;
+        }
+        case ERROR_ADJ_PIN : numDQ = 2; break;
+        case ERROR_X4      : numDQ = 4; firstDQ = regionIdx * 4; break;
+        case ERROR_X8      : numDQ = 8; firstDQ = regionIdx * 8; break;
+        default            : break;
+    }
+
+    for (unsigned int dq = firstDQ; dq < firstDQ + numDQ; ++dq) {
+        for (unsigned int streamIdx = 0; streamIdx < GROUP_SIZE; ++streamIdx) {
+            for (unsigned int tick = 0; tick < BL; ++tick) {
+                positions[numPos++] = getSerialBitPos(streamIdx, tick, dq);
+            }
+        }
+    }
+
+    return numPos;
+}
+
+/*
+ *  Function to generate the syndrome cache of a DRAM fault model.
+ *
+ *  NOTE : genSyndromeTable() must be called before use (done by initCRCEngine()).
+ */
+void genFaultCache(FaultCache *cache, ErrorModel model)
+{
+    unsigned int regionPos[MAX_FAULT_BITS];
+
+    memset(cache, 0, sizeof(FaultCache));
+    cache->model = model;
+    cache->numRegion = getNumFaultRegion(model);
+    cache->regionLen = getFaultRegion(model, 0, regionPos);
+    cache->numGroup = (cache->regionLen + BYTE - 1) / BYTE;
+
+    cache->positions = (unsigned int *)malloc(cache->numRegion * cache->regionLen * sizeof(unsigned int));
+    cache->groups = (FaultGroup *)malloc(cache->numRegion * cache->numGroup * sizeof(FaultGroup));
+
+    if (cache->positions == NULL || cache->groups == NULL) {
+        printf("Unable to allocate the syndrome cache of %s faults\n", getErrorModelName(model));
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int regionIdx = 0; regionIdx < cache->numRegion; ++regionIdx) {
+        unsigned int *positions = &cache->positions[regionIdx * cache->regionLen];
+
+        getFaultRegion(model, regionIdx, positions);
+
+        // Values are built from the lowest set bit, as byteSyndrome in genSyndromeTable().
+        for (unsigned int groupIdx = 0; groupIdx < cache->numGroup; ++groupIdx) {
+            FaultGroup *group = &cache->groups[regionIdx * cache->numGroup + groupIdx];
+
+            group->syndrome[0] = 0;
+            group->firstPos[0] = UINT16_MAX;
+            group->lastPos[0] = 0;
+
+            for (unsigned int value = 1; value < TABLE_SIZE; ++value) {
+                unsigned int prev = value & (value - 1);
+                unsigned int bitIdx = groupIdx * BYTE + __builtin_ctz(value);
+
+                group->syndrome[value] = group->syndrome[prev];
+                group->firstPos[value] = group->firstPos[prev];
+                group->lastPos[value] = group->lastPos[prev];
+
+                if (bitIdx < cache->regionLen) {
+                    unsigned int pos = positions[bitIdx];
+
+                    group->syndrome[value] ^= synTable.bitSyndrome[pos];
+                    group->firstPos[value] = pos < group->firstPos[value] ? pos : group->firstPos[value];
+                    group->lastPos[value] = pos > group->lastPos[value] ? pos : group->lastPos[value];
+                }
+            }
+        }
+    }
+}
+
+void freeFaultCache(FaultCache *cache)
+{
+    free(cache->positions);
+    free(cache->groups);
+    cache->positions = NULL;
+    cache->groups = NULL;
+}
+
+/*
+ *  Function to randomly generate a fault, a word at a time.
+ *  Returns the region, and stores the flipped bits of the region to mask.
+ *
+ *  NOTE : In an adjacent-pin short, the two pins differ in a beat with flipProb,
+ *         and one of them (chosen at random) takes the value of the other.
+ */
+unsigned int genFaultMask(const FaultCache *cache, Rng *rng, uint64_t flipProb, uint64_t *mask)
+{
+    unsigned int regionIdx = nextRng(rng) % cache->numRegion;
+    unsigned int numWord = (cache->regionLen + 63) / 64;
+
+    if (cache->model == ERROR_ADJ_PIN) {
+        unsigned int numBeat = cache->regionLen / 2;
+        uint64_t differ = nextRngMask(rng, flipProb) & (((uint64_t)1 << numBeat) - 1);
+        uint64_t side = nextRng(rng);
+
+        mask[0] = (differ & side) | ((differ & ~side) << numBeat);
+        return regionIdx;
+    }
+
+    for (unsigned int wordIdx = 0; wordIdx < numWord; ++wordIdx) {
+        mask[wordIdx] = nextRngMask(rng, flipProb);
+    }
+    if (cache->regionLen % 64) {
+        mask[numWord - 1] &= ((uint64_t)1 << (cache->regionLen % 64)) - 1;
+    }
+
+    return regionIdx;
+}
+
+/*
+ *  Function to randomly generate a fault, a bit at a time (reference).
+ */
+unsigned int genFaultMaskRef(const FaultCache *cache, Rng *rng, double flipRate, uint64_t *mask)
+{
+    unsigned int regionIdx = nextRng(rng) % cache->numRegion;
+
+    memset(mask, 0, FAULT_WORDS * sizeof(uint64_t));
+
+    if (cache->model == ERROR_ADJ_PIN) {
+        unsigned int numBeat = cache->regionLen / 2;
+
+        for (unsigned int beat = 0; beat < numBeat; ++beat) {
+            if (nextUniform(rng) < flipRate) {
+                unsigned int bitIdx = (nextUniform(rng) < 0.5) ? beat : beat + numBeat;
+                mask[bitIdx / 64] |= (uint64_t)1 << (bitIdx % 64);
+            }
+        }
+        return regionIdx;
+    }
+
+    for (unsigned int bitIdx = 0; bitIdx < cache->regionLen; ++bitIdx) {
+        if (nextUniform(rng) < flipRate) {
+            mask[bitIdx / 64] |= (uint64_t)1 << (bitIdx % 64);
+        }
+    }
+
+    return regionIdx;
+}
+
+static inline unsigned int getGroupValue(const uint64_t *mask, unsigned int groupIdx)
+{
+    return (mask[groupIdx / 8] >> (BYTE * (groupIdx % 8))) & 0xFF;
+}
+
+/*
+ *  Function to get the syndrome of a fault from the cache.
+ */
+uint32_t getFaultSyndrome(const FaultCache *cache, unsigned int regionIdx, const uint64_t *mask)
+{
+    const FaultGroup *groups = &cache->groups[regionIdx * cache->numGroup];
+    uint32_t syndrome = 0;
+
+    for (unsigned int groupIdx = 0; groupIdx < cache->numGroup; ++groupIdx) {
+        syndrome ^= groups[groupIdx].syndrome[getGroupValue(mask, groupIdx)];
+    }
+
+    return syndrome;
+}
+
+/*
+ *  Function to get the burst length of a fault in the codeword from the cache.
+ */
+unsigned int getFaultBurstLen(const FaultCache *cache, unsigned int regionIdx, const uint64_t *mask)
+{
+    const FaultGroup *groups = &cache->groups[regionIdx * cache->numGroup];
+    unsigned int firstPos = UINT16_MAX;
+    unsigned int lastPos = 0;
+
+    for (unsigned int groupIdx = 0; groupIdx < cache->numGroup; ++groupIdx) {
+        unsigned int value = getGroupValue(mask, groupIdx);
+
+        if (value) {
+            firstPos = groups[groupIdx].firstPos[value] < firstPos ? groups[groupIdx].firstPos[value] : firstPos;
+            lastPos = groups[groupIdx].lastPos[value] > lastPos ? groups[groupIdx].lastPos[value] : lastPos;
+        }
+    }
+
+    return (firstPos == UINT16_MAX) ? 0 : lastPos - firstPos + 1;
+}
+
+/*
+ *  Function to apply a fault to an error vector of the codeword.
+ */
+void getFaultError(const FaultCache *cache, unsigned int regionIdx, const uint64_t *mask, uint8_t *error)
+{
+    const unsigned int *positions = &cache->positions[regionIdx * cache->regionLen];
+
+    for (unsigned int bitIdx = 0; bitIdx < cache->regionLen; ++bitIdx) {
+        if ((mask[bitIdx / 64] >> (bitIdx % 64)) & 1) {
+            error[positions[bitIdx] / BYTE] |= 0x80 >> (positions[bitIdx] % BYTE);  // position 0 is the MSB
+        }
+    }
+}
+
+/*
+ *  Function to get the undetected fraction of all non-zero error patterns of a region,
+ *  averaged over the regions.
+ */
+double getFaultUndetected(const FaultCache *cache)
+{
+    double undetected = 0.0;
+
+    for (unsigned int regionIdx = 0; regionIdx < cache->numRegion; ++regionIdx) {
+        undetected += getRegionUndetected(synTable.bitSyndrome, &cache->positions[regionIdx * cache->regionLen],
+            cache->regionLen);
+    }
+
+    return undetected / cache->numRegion;
+}
@@ -0,0 +1,66 @@
+#ifndef __ERRMODEL_H__
+#define __ERRMODEL_H__
+
+#include "rng.h"
+
+#define MAX_FAULT_BITS (8 * GROUP_SIZE * BL)        // bits of the largest fault region (x8 device)
+#define FAULT_WORDS ((MAX_FAULT_BITS + 63) / 64)    // 64-bit words of a fault mask
+
+/*
+ *  Error models of the simulation.
+ *
+ *  NOTE : DRAM fault models are regions of the serialized data (see serialize()).
+ *         A region is chosen uniformly, and each of its bits flips with the flip rate.
+ */
+typedef enum {
+    ERROR_BURST,                // bits of CHECK_SIZE bytes at a random position (genBurstError)
+    ERROR_RANDOM,               // bits of the whole codeword (genError)
+    ERROR_PIN,                  // one DQ across all beats
+    ERROR_ADJ_PIN,              // short of two adjacent DQs: one of them flips in a beat where they differ
+    ERROR_BEAT,                 // all DQs in one beat
+    ERROR_X4,                   // one x4 device across all beats
+    ERROR_X8,                   // one x8 device across all beats
+    NUM_ERROR_MODELS
+} ErrorModel;
+
+/*
+ *  Precomputed syndromes of 8 bits of a fault region.
+ *
+ *  NOTE : Bit b of a value is bit 8g + b of the region mask for group g.
+ */
+typedef struct {
+    uint32_t syndrome[TABLE_SIZE];              // syndrome of each value
+    uint16_t firstPos[TABLE_SIZE];              // first codeword bit of each value
+    uint16_t lastPos[TABLE_SIZE];               // last codeword bit of each value
+} FaultGroup;
+
+/*
+ *  Syndrome cache of every region of a DRAM fault model.
+ *  The syndrome of a fault is the XOR of one lookup per 8 bits of its region.
+ */
+typedef struct {
+    ErrorModel model;
+    unsigned int numRegion;
+    unsigned int regionLen;                     // bits of a region
+    unsigned int numGroup;                      // groups of 8 bits of a region
+    unsigned int *positions;                    // codeword bit positions of each region
+    FaultGroup *groups;                         // groups of each region
+} FaultCache;
+
+extern FaultCache faultCache;  // cache of the simulated fault model
+
+ErrorModel getErrorModel(const char *name);
+const char *getErrorModelName(ErrorModel model);
+bool isFaultModel(ErrorModel model);
+unsigned int getNumFaultRegion(ErrorModel model);
+unsigned int getFaultRegion(ErrorModel model, unsigned int regionIdx, unsigned int *positions);
+void genFaultCache(FaultCache *cache, ErrorModel model);
+void freeFaultCache(FaultCache *cache);
+unsigned int genFaultMask(const FaultCache *cache, Rng *rng, uint64_t flipProb, uint64_t *mask);
+unsigned int genFaultMaskRef(const FaultCache *cache, Rng *rng, double flipRate, uint64_t *mask);
+uint32_t getFaultSyndrome(const FaultCache *cache, unsigned int regionIdx, const uint64_t *mask);
+unsigned int getFaultBurstLen(const FaultCache *cache, unsigned int regionIdx, const uint64_t *mask);
+void getFaultError(const FaultCache *cache, unsigned int regionIdx, const uint64_t *mask, uint8_t *error);
+double getFaultUndetected(const FaultCache *cache);
+
+#endif
@@ -0,0 +1,270 @@
+/*
+ *  Exhaustive enumeration of low-weight and burst error patterns.
+ *
+ *  Random sampling can never observe undetected rates near 2^-32, so this mode
+ *  evaluates every error pattern of weight 1..K and every burst of length 1..L
+ *  over the CW_SIZE codeword and reports exact undetected counts.
+ *
+ *    1) Weight-k patterns are enumerated in lexicographic order, keeping the
+ *       syndrome of each prefix. Each new pattern costs one XOR and one compare.
+ *    2) Bursts enumerate their inner bits in Gray-code order,
+ *       so each new pattern flips exactly one bit syndrome.
+ *
+ *  The pattern space is split into work items by (weight, first position) and
+ *  (burst length, start position), which are handed out to worker threads.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "exhaust.h"
+
+/*
+ *  A unit of work: all patterns of a given size starting at a given position.
+ */
+typedef struct {
+    bool isBurst;
+    uint16_t size;              // weight or burst length
+    uint16_t firstPos;          // position of the first erroneous bit
+} ExhaustItem;
+
+typedef struct {
+    const ExhaustConfig *config;
+    const ExhaustItem *items;
+    size_t numItem;
+    size_t nextItem;            // shared work counter (atomic)
+} ExhaustContext;
+
+typedef struct {
+    ExhaustContext *context;
+    ExhaustResult result;
+} __attribute__((aligned(64))) ExhaustWorker;
+
+/*
+ *  Function to get enumeration settings from program input arguments.
+ */
+void getExhaustConfig(int argc, char *argv[], ExhaustConfig *config)
+{
+    config->maxWeight = EXHAUST_WEIGHT;
+    config->maxBurst = EXHAUST_BURST;
+    config->numThreads = 1;
+
+    for (int argIdx = 2; argIdx < argc - 1; ++argIdx) {
+        if (strcmp(argv[argIdx], "--weight") == 0) {
+            config->maxWeight = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--burst") == 0) {
+            config->maxBurst = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+    }
+
+    if (config->maxWeight > MAX_EXHAUST_WEIGHT) {
+        printf("Weight is limited to %d\n", MAX_EXHAUST_WEIGHT);
+        config->maxWeight = MAX_EXHAUST_WEIGHT;
+    }
+    if (config->maxBurst > MAX_EXHAUST_BURST) {
+        printf("Burst length is limited to %d\n", MAX_EXHAUST_BURST);
+        config->maxBurst = MAX_EXHAUST_BURST;
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+}
+
+/*
+ *  Function to calculate the binomial coefficient C(n, k).
+ */
+uint64_t countCombination(unsigned int n, unsigned int k)
+{
+    uint64_t result = 1;
+
+    if (k > n) {
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < k; ++i) {
+        result = result * (n - i) / (i + 1);
+    }
+
+    return result;
+}
+
+/*
+ *  Function to count undetected patterns that add 'depth' more bits
+ *  at positions >= firstPos to a prefix with the given syndrome.
+ */
+static uint64_t countFrom(const uint32_t *bitSyndrome, unsigned int firstPos, unsigned int depth, uint32_t prefix)
+{
+    uint64_t count = 0;
+
+    if (depth == 0) {
+        return prefix == 0;
+    }
+
+    // The last bit only needs a compare per position.
+    if (depth == 1) {
+        for (unsigned int pos = firstPos; pos < CW_BITS; ++pos) {
+            count += (bitSyndrome[pos] == prefix);
+        }
+        return count;
+    }
+
+    for (unsigned int pos = firstPos; pos + depth <= CW_BITS; ++pos) {
+        count += countFrom(bitSyndrome, pos + 1, depth - 1, prefix ^ bitSyndrome[pos]);
+    }
+
+    return count;
+}
+
+/*
+ *  Function to count undetected errors of the given weight whose first bit is at firstPos.
+ */
+uint64_t countUndetectedWeight(const SyndromeTable *table, unsigned int weight, unsigned int firstPos)
+{
+    return countFrom(table->bitSyndrome, firstPos + 1, weight - 1, table->bitSyndrome[firstPos]);
+}
+
+/*
+ *  Function to count undetected bursts of exactly burstLen bits starting at startPos.
+ *
+ *  NOTE : The first and the last bits of a burst are erroneous, and the
+ *         2^(burstLen - 2) inner patterns are visited in Gray-code order.
+ */
+uint64_t countUndetectedBurst(const SyndromeTable *table, unsigned int burstLen, unsigned int startPos)
+{
+    const uint32_t *bitSyndrome = table->bitSyndrome;
+
+    if (burstLen == 1) {
+        return bitSyndrome[startPos] == 0;
+    }
+
+    uint32_t syndrome = bitSyndrome[startPos] ^ bitSyndrome[startPos + burstLen - 1];
+    uint64_t numInner = (uint64_t)1 << (burstLen - 2);
+    uint64_t count = (syndrome == 0);
+
+    for (uint64_t grayIdx = 1; grayIdx < numInner; ++grayIdx) {
+        syndrome ^= bitSyndrome[startPos + 1 + __builtin_ctzll(grayIdx)];
+        count += (syndrome == 0);
+    }
+
+    return count;
+}
+
+/*
+ *  Worker thread function. Work items are taken from the shared counter.
+ */
+static void *exhaustWorker(void *arg)
+{
+    ExhaustWorker *worker = (ExhaustWorker *)arg;
+    ExhaustContext *context = worker->context;
+
+    while (true) {
+        size_t itemIdx = __atomic_fetch_add(&context->nextItem, 1, __ATOMIC_RELAXED);
+        if (itemIdx >= context->numItem) {
+            break;
+        }
+
+        const ExhaustItem *item = &context->items[itemIdx];
+        if (item->isBurst) {
+            worker->result.undetBurst[item->size] += countUndetectedBurst(&synTable, item->size, item->firstPos);
+        }
+        else {
+            worker->result.undetWeight[item->size] += countUndetectedWeight(&synTable, item->size, item->firstPos);
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to enumerate all low-weight and burst errors and print exact counts.
+ */
+void exhaust(const ExhaustConfig *config)
+{
+    size_t maxItem = (size_t)(config->maxWeight + config->maxBurst) * CW_BITS;
+    ExhaustItem *items = (ExhaustItem *)calloc(maxItem, sizeof(ExhaustItem));
+    ExhaustWorker *workers = (ExhaustWorker *)aligned_alloc(64, config->numThreads * sizeof(ExhaustWorker));
+    pthread_t *threads = (pthread_t *)calloc(config->numThreads, sizeof(pthread_t));
+    ExhaustContext context = { config, items, 0, 0 };
+    ExhaustResult total = {0};
+
+    if (items == NULL || workers == NULL || threads == NULL) {
+        printf("Unable to allocate %u workers\n", config->numThreads);
+        exit(EXIT_FAILURE);
+    }
+
+    // Heavy items (high weight, long burst, small first position) go first for load balancing.
+    for (unsigned int burstLen = config->maxBurst; burstLen >= 1; --burstLen) {
+        for (unsigned int pos = 0; pos + burstLen <= CW_BITS; ++pos) {
+            items[context.numItem++] = (ExhaustItem){ true, (uint16_t)burstLen, (uint16_t)pos };
+        }
+        total.totBurst[burstLen] = (burstLen == 1 ? 1 : (uint64_t)1 << (burstLen - 2)) * (CW_BITS - burstLen + 1);
+    }
+    for (unsigned int weight = config->maxWeight; weight >= 1; --weight) {
+        for (unsigned int pos = 0; pos + weight <= CW_BITS; ++pos) {
+            items[context.numItem++] = (ExhaustItem){ false, (uint16_t)weight, (uint16_t)pos };
+        }
+        total.totWeight[weight] = countCombination(CW_BITS, weight);
+    }
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        memset(&workers[threadIdx], 0, sizeof(ExhaustWorker));
+        workers[threadIdx].context = &context;
+
+        if (pthread_create(&threads[threadIdx], NULL, exhaustWorker, &workers[threadIdx]) != 0) {
+            printf("Unable to create thread %u\n", threadIdx);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        pthread_join(threads[threadIdx], NULL);
+
+        for (unsigned int weight = 1; weight <= MAX_EXHAUST_WEIGHT; ++weight) {
+            total.undetWeight[weight] += workers[threadIdx].result.undetWeight[weight];
+        }
+        for (unsigned int burstLen = 1; burstLen <= MAX_EXHAUST_BURST; ++burstLen) {
+            total.undetBurst[burstLen] += workers[threadIdx].result.undetBurst[burstLen];
+        }
+    }
+
+    // Print the result.
+    printf("##### Exhaustive Result #####\n");
+    printf("Polynomial : 0x%08X, Codeword : %d bits, Threads : %u\n", GEN_POLY, CW_BITS, config->numThreads);
+    printf("%-8s %20s %20s %14s\n", "Weight", "Patterns", "Undetected", "Ratio");
+    unsigned int minDistance = 0;
+    for (unsigned int weight = 1; weight <= config->maxWeight; ++weight) {
+        printf("%-8u %20llu %20llu %14.6e\n", weight,
+            (unsigned long long)total.totWeight[weight], (unsigned long long)total.undetWeight[weight],
+            (double)total.undetWeight[weight] / total.totWeight[weight]);
+
+        if (minDistance == 0 && total.undetWeight[weight] > 0) {
+            minDistance = weight;
+        }
+    }
+    printf("%-8s %20s %20s %14s\n", "Burst", "Patterns", "Undetected", "Ratio");
+    for (unsigned int burstLen = 1; burstLen <= config->maxBurst; ++burstLen) {
+        printf("%-8u %20llu %20llu %14.6e\n", burstLen,
+            (unsigned long long)total.totBurst[burstLen], (unsigned long long)total.undetBurst[burstLen],
+            (double)total.undetBurst[burstLen] / total.totBurst[burstLen]);
+    }
+
+    if (minDistance > 0) {
+        printf("Minimum Hamming distance   : %u\n", minDistance);
+    }
+    else {
+        printf("Minimum Hamming distance   : > %u\n", config->maxWeight);
+    }
+
+    free(threads);
+    free(workers);
+    free(items);
+}
@@ -0,0 +1,34 @@
+#ifndef __EXHAUST_H__
+#define __EXHAUST_H__
+
+#define EXHAUST_WEIGHT 4        // default maximum error weight to enumerate
+#define EXHAUST_BURST 24        // default maximum burst length to enumerate
+#define MAX_EXHAUST_WEIGHT 8    // limit of --weight
+#define MAX_EXHAUST_BURST 48    // limit of --burst
+
+/*
+ *  Exhaustive enumeration settings given by program input arguments.
+ */
+typedef struct {
+    unsigned int maxWeight;     // enumerate all errors of weight 1..maxWeight  (--weight K)
+    unsigned int maxBurst;      // enumerate all bursts of length 1..maxBurst   (--burst L)
+    unsigned int numThreads;    // number of worker threads                     (--threads N)
+} ExhaustConfig;
+
+/*
+ *  Exact pattern counts of the enumeration.
+ */
+typedef struct {
+    uint64_t totWeight[MAX_EXHAUST_WEIGHT + 1];
+    uint64_t undetWeight[MAX_EXHAUST_WEIGHT + 1];
+    uint64_t totBurst[MAX_EXHAUST_BURST + 1];
+    uint64_t undetBurst[MAX_EXHAUST_BURST + 1];
+} ExhaustResult;
+
+void getExhaustConfig(int argc, char *argv[], ExhaustConfig *config);
+void exhaust(const ExhaustConfig *config);
+uint64_t countUndetectedWeight(const SyndromeTable *table, unsigned int weight, unsigned int firstPos);
+uint64_t countUndetectedBurst(const SyndromeTable *table, unsigned int burstLen, unsigned int startPos);
+uint64_t countCombination(unsigned int n, unsigned int k);
+
+#endif
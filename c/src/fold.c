@@ -0,0 +1,426 @@
+/*
+ *  Carry-less multiply folding kernels for the MSB-first (non-reflected) CRC32.
+ *
+ *  The data is viewed as a polynomial over GF(2) and consumed in 128-bit blocks.
+ *  Instead of dividing bit by bit, the running 128-bit remainder is multiplied by
+ *  x^D mod P ("folded" D bits forward) and XORed into the next block. After the
+ *  last block, the 128-bit remainder is reduced to 32 bits with Barrett reduction.
+ *
+ *    1) updateCRCClmul : uses the x86 PCLMULQDQ instruction.
+ *    2) updateCRCFold  : portable version with a software carry-less multiply.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "fold.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_X86_CLMUL 1
+#else
+#define HAVE_X86_CLMUL 0
+#endif
+
+FoldConstants foldConst;
+
+/*
+ *  128-bit block in MSB-first order.
+ */
+typedef struct {
+    uint64_t hi;                // coefficients of x^127 .. x^64
+    uint64_t lo;                // coefficients of x^63  .. x^0
+} Block128;
+
+/*
+ *  Function to calculate x^n mod P.
+ */
+uint32_t xPowMod(unsigned int n)
+{
+    uint32_t remainder = 0x00000001;  // x^0
+
+    for (unsigned int i = 0; i < n; ++i) {
+        if (remainder & 0x80000000) {
+            remainder = (remainder << 1) ^ GEN_POLY;
+        }
+        else {
+            remainder <<= 1;
+        }
+    }
+
+    return remainder;
+}
+
+/*
+ *  Function to calculate floor(x^64 / P) by polynomial long division.
+ */
+static uint64_t divXPow64()
+{
+    uint64_t poly = ((uint64_t)1 << CRC) | GEN_POLY;
+    uint64_t remHi = 1;         // coefficient of x^64
+    uint64_t remLo = 0;         // coefficients of x^63 .. x^0
+    uint64_t quotient = 0;
+
+    for (int bitIdx = 64; bitIdx >= CRC; --bitIdx) {
+        uint64_t leadBit = (bitIdx == 64) ? remHi : (remLo >> bitIdx) & 1;
+
+        if (leadBit) {
+            unsigned int shift = bitIdx - CRC;
+
+            quotient |= (uint64_t)1 << shift;
+            remLo ^= poly << shift;
+            if (shift == CRC) {
+                remHi ^= 1;     // x^32 term of P shifted to x^64
+            }
+        }
+    }
+
+    return quotient;
+}
+
+/*
+ *  Function to generate folding constants from GEN_POLY.
+ */
+void genFoldConstants()
+{
+    foldConst.fold1[0]  = xPowMod(128 + 64);
+    foldConst.fold1[1]  = xPowMod(128);
+    foldConst.fold2[0]  = xPowMod(256 + 64);
+    foldConst.fold2[1]  = xPowMod(256);
+    foldConst.fold3[0]  = xPowMod(384 + 64);
+    foldConst.fold3[1]  = xPowMod(384);
+    foldConst.fold4[0]  = xPowMod(512 + 64);
+    foldConst.fold4[1]  = xPowMod(512);
+    foldConst.reduce[0] = xPowMod(96);
+    foldConst.reduce[1] = xPowMod(64);
+    foldConst.mu        = divXPow64();
+    foldConst.poly      = ((uint64_t)1 << CRC) | GEN_POLY;
+}
+
+/*
+ *  Function to check if the CPU supports carry-less multiplication.
+ */
+bool hasCLMUL()
+{
+#if HAVE_X86_CLMUL
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+/*
+ *  Function to load 8 bytes as a big-endian (MSB-first) 64-bit word.
+ */
+static inline uint64_t loadBE64(const uint8_t *data)
+{
+    return ((uint64_t)loadBE32(data) << 32) | loadBE32(data + 4);
+}
+
+static inline Block128 loadBlock(const uint8_t *data)
+{
+    Block128 block = { loadBE64(data), loadBE64(data + 8) };
+    return block;
+}
+
+/*
+ *  Function to carry-less multiply a 64-bit value by a 32-bit value in software.
+ *
+ *  NOTE : The lower 64 bits of the product are returned,
+ *         and the upper 32 bits are stored in 'hi'.
+ */
+static inline uint64_t clmulSoft(uint64_t a, uint32_t b, uint64_t *hi)
+{
+    uint64_t lo = a & -(uint64_t)(b & 1);
+    uint64_t up = 0;
+
+    for (int bitIdx = 1; bitIdx < CRC; ++bitIdx) {
+        uint64_t mask = -(uint64_t)((b >> bitIdx) & 1);
+        lo ^= (a << bitIdx) & mask;
+        up ^= (a >> (64 - bitIdx)) & mask;
+    }
+
+    *hi = up;
+    return lo;
+}
+
+/*
+ *  Function to fold the accumulator forward and XOR it into the next block.
+ */
+static inline Block128 foldSoft(Block128 acc, const uint64_t k[2], Block128 next)
+{
+    uint64_t hiOfHi, hiOfLo;
+    uint64_t loOfHi = clmulSoft(acc.hi, (uint32_t)k[0], &hiOfHi);
+    uint64_t loOfLo = clmulSoft(acc.lo, (uint32_t)k[1], &hiOfLo);
+
+    next.hi ^= hiOfHi ^ hiOfLo;
+    next.lo ^= loOfHi ^ loOfLo;
+    return next;
+}
+
+/*
+ *  Function to reduce the 128-bit accumulator to the CRC register, (acc * x^32) mod P.
+ */
+static uint32_t reduceSoft(Block128 acc)
+{
+    uint64_t unused;
+
+    // acc * x^32 = H * x^96 + L * x^32, where H * x^96 == H * (x^96 mod P).
+    uint64_t hi;
+    uint64_t lo = clmulSoft(acc.hi, (uint32_t)foldConst.reduce[0], &hi);
+    lo ^= acc.lo << CRC;
+    hi ^= acc.lo >> CRC;
+
+    // The upper 32 bits A are folded with A * x^64 == A * (x^64 mod P).
+    uint64_t value = clmulSoft(hi, (uint32_t)foldConst.reduce[1], &unused) ^ lo;
+
+    // Barrett reduction of the 64-bit value.
+    uint64_t top = value >> CRC;
+    uint64_t quotient = ((top << CRC) ^ clmulSoft(top, (uint32_t)foldConst.mu, &unused)) >> CRC;
+    uint64_t product = (quotient << CRC) ^ clmulSoft(quotient, GEN_POLY, &unused);
+
+    return (uint32_t)(value ^ product);
+}
+
+/*
+ *  Function to update the CRC register with carry-less multiply folding (portable).
+ *
+ *  NOTE : genFoldConstants() and genSliceTables() must be called before use.
+ *         Inputs shorter than a block and the trailing bytes use slicing-by-16.
+ */
+uint32_t updateCRCFold(uint32_t crc, const uint8_t *data, size_t byteLen)
+{
+    Block128 acc;
+
+    if (byteLen < FOLD_BLOCK) {
+        return updateCRCSlice16(crc, data, byteLen);
+    }
+
+    if (byteLen >= FOLD_LANES * FOLD_BLOCK) {
+        Block128 lane[FOLD_LANES];
+
+        for (int laneIdx = 0; laneIdx < FOLD_LANES; ++laneIdx) {
+            lane[laneIdx] = loadBlock(data + laneIdx * FOLD_BLOCK);
+        }
+        lane[0].hi ^= (uint64_t)crc << CRC;  // the CRC register joins the first 32 bits
+        data += FOLD_LANES * FOLD_BLOCK;
+        byteLen -= FOLD_LANES * FOLD_BLOCK;
+
+        // Fold each lane by 4 blocks.
+        for (; byteLen >= FOLD_LANES * FOLD_BLOCK; data += FOLD_LANES * FOLD_BLOCK, byteLen -= FOLD_LANES * FOLD_BLOCK) {
+            for (int laneIdx = 0; laneIdx < FOLD_LANES; ++laneIdx) {
+                lane[laneIdx] = foldSoft(lane[laneIdx], foldConst.fold4, loadBlock(data + laneIdx * FOLD_BLOCK));
+            }
+        }
+
+        // Merge lanes into a single accumulator.
+        acc = lane[0];
+        for (int laneIdx = 1; laneIdx < FOLD_LANES; ++laneIdx) {
+            acc = foldSoft(acc, foldConst.fold1, lane[laneIdx]);
+        }
+    }
+    else {
+        acc = loadBlock(data);
+        acc.hi ^= (uint64_t)crc << CRC;
+        data += FOLD_BLOCK;
+        byteLen -= FOLD_BLOCK;
+    }
+
+    for (; byteLen >= FOLD_BLOCK; data += FOLD_BLOCK, byteLen -= FOLD_BLOCK) {
+        acc = foldSoft(acc, foldConst.fold1, loadBlock(data));
+    }
+
+    return updateCRCSlice16(reduceSoft(acc), data, byteLen);
+}
+
+#if HAVE_X86_CLMUL
+
+#define CLMUL_TARGET __attribute__((target("pclmul,ssse3")))
+
+CLMUL_TARGET
+static inline __m128i loadBlockClmul(const uint8_t *data, __m128i byteSwap)
+{
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)data), byteSwap);
+}
+
+CLMUL_TARGET
+static inline __m128i foldClmul(__m128i acc, __m128i k, __m128i next)
+{
+    __m128i hi = _mm_clmulepi64_si128(acc, k, 0x11);  // acc.hi * k.hi
+    __m128i lo = _mm_clmulepi64_si128(acc, k, 0x00);  // acc.lo * k.lo
+
+    return _mm_xor_si128(next, _mm_xor_si128(hi, lo));
+}
+
+/*
+ *  Function to reduce the 128-bit accumulator to the CRC register, (acc * x^32) mod P.
+ *  Same steps as reduceSoft(), kept in vector registers.
+ */
+CLMUL_TARGET
+static inline uint32_t reduceClmul(__m128i acc)
+{
+    const __m128i k = _mm_set_epi64x((long long)foldConst.reduce[1], (long long)foldConst.reduce[0]);
+    const __m128i barrett = _mm_set_epi64x((long long)foldConst.poly, (long long)foldConst.mu);
+
+    // acc * x^32 = H * (x^96 mod P) + L * x^32 (96 bits).
+    __m128i value = _mm_xor_si128(_mm_clmulepi64_si128(acc, k, 0x01),
+                                  _mm_slli_si128(_mm_move_epi64(acc), 4));
+
+    // The upper 32 bits A are folded with A * (x^64 mod P) (64 bits).
+    value = _mm_xor_si128(_mm_clmulepi64_si128(value, k, 0x11), _mm_move_epi64(value));
+
+    // Barrett reduction of the 64-bit value.
+    __m128i quotient = _mm_srli_epi64(_mm_clmulepi64_si128(_mm_srli_epi64(value, CRC), barrett, 0x00), CRC);
+    __m128i product = _mm_clmulepi64_si128(quotient, barrett, 0x10);
+
+    return (uint32_t)_mm_cvtsi128_si32(_mm_xor_si128(value, product));
+}
+
+/*
+ *  Function to update the CRC register with carry-less multiply folding (PCLMULQDQ).
+ *
+ *  NOTE : Only call this if hasCLMUL() is true.
+ *         genFoldConstants() and genSliceTables() must be called before use.
+ */
+CLMUL_TARGET
+uint32_t updateCRCClmul(uint32_t crc, const uint8_t *data, size_t byteLen)
+{
+    const __m128i byteSwap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k1 = _mm_set_epi64x((long long)foldConst.fold1[0], (long long)foldConst.fold1[1]);
+    const __m128i k4 = _mm_set_epi64x((long long)foldConst.fold4[0], (long long)foldConst.fold4[1]);
+    const __m128i crcInit = _mm_set_epi32((int)crc, 0, 0, 0);
+    __m128i acc;
+
+    if (byteLen < FOLD_BLOCK) {
+        return updateCRCSlice16(crc, data, byteLen);
+    }
+
+    if (byteLen >= FOLD_LANES * FOLD_BLOCK) {
+        __m128i lane0 = _mm_xor_si128(loadBlockClmul(data, byteSwap), crcInit);
+        __m128i lane1 = loadBlockClmul(data + FOLD_BLOCK, byteSwap);
+        __m128i lane2 = loadBlockClmul(data + 2 * FOLD_BLOCK, byteSwap);
+        __m128i lane3 = loadBlockClmul(data + 3 * FOLD_BLOCK, byteSwap);
+        data += FOLD_LANES * FOLD_BLOCK;
+        byteLen -= FOLD_LANES * FOLD_BLOCK;
+
+        // Fold each lane by 4 blocks.
+        for (; byteLen >= FOLD_LANES * FOLD_BLOCK; data += FOLD_LANES * FOLD_BLOCK, byteLen -= FOLD_LANES * FOLD_BLOCK) {
+            lane0 = foldClmul(lane0, k4, loadBlockClmul(data, byteSwap));
+            lane1 = foldClmul(lane1, k4, loadBlockClmul(data + FOLD_BLOCK, byteSwap));
+            lane2 = foldClmul(lane2, k4, loadBlockClmul(data + 2 * FOLD_BLOCK, byteSwap));
+            lane3 = foldClmul(lane3, k4, loadBlockClmul(data + 3 * FOLD_BLOCK, byteSwap));
+        }
+
+        // Merge lanes into a single accumulator.
+        acc = foldClmul(lane0, k1, lane1);
+        acc = foldClmul(acc, k1, lane2);
+        acc = foldClmul(acc, k1, lane3);
+    }
+    else {
+        acc = _mm_xor_si128(loadBlockClmul(data, byteSwap), crcInit);
+        data += FOLD_BLOCK;
+        byteLen -= FOLD_BLOCK;
+    }
+
+    for (; byteLen >= FOLD_BLOCK; data += FOLD_BLOCK, byteLen -= FOLD_BLOCK) {
+        acc = foldClmul(acc, k1, loadBlockClmul(data, byteSwap));
+    }
+
+    return updateCRCSlice16(reduceClmul(acc), data, byteLen);
+}
+
+/*
+ *  Function to fold a line of a multiple of 4 blocks into a 128-bit accumulator.
+ *  The 4 lanes are merged with independent multiplies by x^384, x^256 and x^128.
+ */
+CLMUL_TARGET __attribute__((always_inline))
+static inline __m128i foldLineClmul(const uint8_t *data, size_t byteLen, __m128i crcInit, __m128i byteSwap,
+    const __m128i k[4])
+{
+    __m128i lane0 = _mm_xor_si128(loadBlockClmul(data, byteSwap), crcInit);
+    __m128i lane1 = loadBlockClmul(data + FOLD_BLOCK, byteSwap);
+    __m128i lane2 = loadBlockClmul(data + 2 * FOLD_BLOCK, byteSwap);
+    __m128i lane3 = loadBlockClmul(data + 3 * FOLD_BLOCK, byteSwap);
+
+    for (size_t offset = FOLD_LANES * FOLD_BLOCK; offset < byteLen; offset += FOLD_LANES * FOLD_BLOCK) {
+        lane0 = foldClmul(lane0, k[3], loadBlockClmul(data + offset, byteSwap));
+        lane1 = foldClmul(lane1, k[3], loadBlockClmul(data + offset + FOLD_BLOCK, byteSwap));
+        lane2 = foldClmul(lane2, k[3], loadBlockClmul(data + offset + 2 * FOLD_BLOCK, byteSwap));
+        lane3 = foldClmul(lane3, k[3], loadBlockClmul(data + offset + 3 * FOLD_BLOCK, byteSwap));
+    }
+
+    return foldClmul(lane0, k[2], foldClmul(lane1, k[1], foldClmul(lane2, k[0], lane3)));
+}
+
+/*
+ *  Function to update the CRC registers of consecutive lines, starting each from 'crc'.
+ *
+ *  NOTE : Lines are processed in groups of FOLD_LANES with no dependency between them,
+ *         so the multiplies and reductions of different lines overlap in the pipeline.
+ *         Lines that are not a multiple of 4 blocks are processed one at a time.
+ */
+CLMUL_TARGET
+void updateCRCBatchClmul(uint32_t crc, const uint8_t *lines, size_t lineLen, size_t numLine, uint32_t *crcs)
+{
+    const __m128i byteSwap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i crcInit = _mm_set_epi32((int)crc, 0, 0, 0);
+    const __m128i k[4] = {
+        _mm_set_epi64x((long long)foldConst.fold1[0], (long long)foldConst.fold1[1]),
+        _mm_set_epi64x((long long)foldConst.fold2[0], (long long)foldConst.fold2[1]),
+        _mm_set_epi64x((long long)foldConst.fold3[0], (long long)foldConst.fold3[1]),
+        _mm_set_epi64x((long long)foldConst.fold4[0], (long long)foldConst.fold4[1])
+    };
+    size_t lineIdx = 0;
+
+    if (lineLen == 0 || lineLen % (FOLD_LANES * FOLD_BLOCK) != 0) {
+        for (; lineIdx < numLine; ++lineIdx) {
+            crcs[lineIdx] = updateCRCClmul(crc, lines + lineIdx * lineLen, lineLen);
+        }
+        return;
+    }
+
+    for (; lineIdx + FOLD_LANES <= numLine; lineIdx += FOLD_LANES) {
+        const uint8_t *data = lines + lineIdx * lineLen;
+        __m128i acc0 = foldLineClmul(data, lineLen, crcInit, byteSwap, k);
+        __m128i acc1 = foldLineClmul(data + lineLen, lineLen, crcInit, byteSwap, k);
+        __m128i acc2 = foldLineClmul(data + 2 * lineLen, lineLen, crcInit, byteSwap, k);
+        __m128i acc3 = foldLineClmul(data + 3 * lineLen, lineLen, crcInit, byteSwap, k);
+
+        crcs[lineIdx]     = reduceClmul(acc0);
+        crcs[lineIdx + 1] = reduceClmul(acc1);
+        crcs[lineIdx + 2] = reduceClmul(acc2);
+        crcs[lineIdx + 3] = reduceClmul(acc3);
+    }
+
+    for (; lineIdx < numLine; ++lineIdx) {
+        crcs[lineIdx] = reduceClmul(foldLineClmul(lines + lineIdx * lineLen, lineLen, crcInit, byteSwap, k));
+    }
+}
+
+#else
+
+/*
+ *  Function to update the CRC register with carry-less multiply folding.
+ *  Carry-less multiply instruction is not available on this target.
+ */
+uint32_t updateCRCClmul(uint32_t crc, const uint8_t *data, size_t byteLen)
+{
+    return updateCRCFold(crc, data, byteLen);
+}
+
+/*
+ *  Function to update the CRC registers of consecutive lines, starting each from 'crc'.
+ *  Carry-less multiply instruction is not available on this target.
+ */
+void updateCRCBatchClmul(uint32_t crc, const uint8_t *lines, size_t lineLen, size_t numLine, uint32_t *crcs)
+{
+    for (size_t lineIdx = 0; lineIdx < numLine; ++lineIdx) {
+        crcs[lineIdx] = updateCRCFold(crc, lines + lineIdx * lineLen, lineLen);
+    }
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __FOLD_H__
+#define __FOLD_H__
+
+#define FOLD_BLOCK 16           // size of a fold block in bytes (128 bits)
+#define FOLD_LANES 4            // number of blocks folded in parallel
+
+/*
+ *  Constants for carry-less multiply folding.
+ *  All constants are derived from GEN_POLY by genFoldConstants().
+ *
+ *  NOTE : P is the generator polynomial including the x^32 term.
+ *         A fold pair {x^(D+64) mod P, x^D mod P} moves a 128-bit block
+ *         forward by D bits.
+ */
+typedef struct {
+    uint64_t fold1[2];          // fold distance of 1 block  (D = 128)
+    uint64_t fold2[2];          // fold distance of 2 blocks (D = 256)
+    uint64_t fold3[2];          // fold distance of 3 blocks (D = 384)
+    uint64_t fold4[2];          // fold distance of 4 blocks (D = 512)
+    uint64_t reduce[2];         // {x^96 mod P, x^64 mod P} : 128 -> 64 bit reduction
+    uint64_t mu;                // floor(x^64 / P) : Barrett reduction constant
+    uint64_t poly;              // P
+} FoldConstants;
+
+extern FoldConstants foldConst;
+
+void genFoldConstants();
+uint32_t xPowMod(unsigned int n);
+bool hasCLMUL();
+uint32_t updateCRCFold(uint32_t crc, const uint8_t *data, size_t byteLen);
+uint32_t updateCRCClmul(uint32_t crc, const uint8_t *data, size_t byteLen);
+void updateCRCBatchClmul(uint32_t crc, const uint8_t *lines, size_t lineLen, size_t numLine, uint32_t *crcs);
+
+#endif
@@ -0,0 +1,761 @@
+/*
+ *  Importance sampling of rare undetected errors.
+ *
+ *  An error is undetected only if its syndrome is zero, which happens to about
+ *  2^-32 of random patterns, so plain Monte Carlo never observes it. The undetected
+ *  probability is estimated instead as
+ *
+ *    P(undetected) = sum over weights w of P(weight = w) * P(undetected | weight = w)
+ *
+ *  where P(weight = w) is binomial and exact, and each conditional probability is
+ *  a stratum estimated with a biased error generator:
+ *
+ *    1) Draw w - 2 distinct bits of the error support uniformly.
+ *    2) Complete them with a pair of bits whose syndromes XOR to the syndrome of
+ *       the drawn bits (sorted pair syndrome table), chosen uniformly among the
+ *       valid pairs. The completed pattern is always undetected.
+ *    3) Weight the pattern by its likelihood ratio (uniform density of weight-w
+ *       patterns over the density of the biased generator).
+ *
+ *  Trials are run in rounds. After a pilot round over all strata, each round
+ *  allocates its trials to the strata in proportion to P(weight = w) times the
+ *  standard deviation of the stratum (Neyman allocation), and the simulation
+ *  stops when the confidence interval meets the requested relative error or
+ *  upper bound.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "sim.h"
+#include "search.h"
+#include "importance.h"
+
+#define SUPPORT_WORDS ((CW_BITS + 63) / 64)    // 64-bit words of a support bitmap
+#define MAX_SUPPORT (DATA_SIZE > DQ_SIZE ? DATA_SIZE : DQ_SIZE)  // burst positions or DRAM fault regions
+
+/*
+ *  Pair of bits of a support with the XOR of their syndromes.
+ */
+typedef struct {
+    uint32_t syndrome;
+    uint16_t first;
+    uint16_t second;
+} PairEntry;
+
+/*
+ *  Nominal error distribution of the error model.
+ *
+ *  NOTE : A support of supportLen bits (a burst window or a DRAM fault region)
+ *         is chosen uniformly out of numSupport, and each of its bits flips with
+ *         the flip rate.
+ *         Weights 1 and 2 are evaluated exactly from the pair table, and
+ *         weights minWeight..maxWeight are sampled.
+ */
+typedef struct {
+    unsigned int numSupport;
+    unsigned int supportLen;
+    unsigned int *supportPos;                   // codeword bit positions of each support
+    uint32_t *bitSyndrome;                      // syndromes of the bits of each support
+    uint32_t supportSyndrome[MAX_SUPPORT];      // syndrome of all bits of each support
+    size_t numPair;                             // pairs per support
+    PairEntry *pairs;                           // pairs of each support, sorted by syndrome
+    double pmf[CW_BITS + 1];                    // P(weight = w)
+    unsigned int minWeight;
+    unsigned int maxWeight;
+    double tailMass;                            // P(weight) of truncated strata
+    bool exact;                                 // every error pattern is detected
+    double exactUndet[NUM_IS_CATEGORY];         // P(undetected) of weights 1 and 2
+    double category[NUM_IS_CATEGORY];           // P(error in category)
+} ISModel;
+
+/*
+ *  Trials of a stratum with their own random number stream.
+ */
+typedef struct {
+    unsigned int weight;
+    uint64_t numIter;
+    uint64_t streamIdx;
+    ISStratum result;
+} ISChunk;
+
+typedef struct {
+    const SimConfig *config;
+    const ISModel *model;
+    ISChunk *chunks;
+    size_t numChunk;
+    size_t nextChunk;           // shared work counter (atomic)
+} ISContext;
+
+static const char *categoryName[NUM_IS_CATEGORY] = {
+    "Total error               ",
+    "Odd error                 ",
+    "Double error              ",
+    "Burst error (length <= 32)"
+};
+
+static int comparePairEntry(const void *lhs, const void *rhs)
+{
+    const PairEntry *a = (const PairEntry *)lhs;
+    const PairEntry *b = (const PairEntry *)rhs;
+
+    return (a->syndrome > b->syndrome) - (a->syndrome < b->syndrome);
+}
+
+/*
+ *  Function to get the log of the binomial coefficient C(n, k).
+ */
+static double logChoose(unsigned int n, unsigned int k)
+{
+    return lgamma(n + 1.0) - lgamma(k + 1.0) - lgamma(n - k + 1.0);
+}
+
+/*
+ *  Function to get the fraction of weight-w patterns of a support with burst length <= CRC.
+ *
+ *  NOTE : positions must be sorted. A pattern whose first bit is positions[i]
+ *         fits in a burst if its other w - 1 bits are among the c bits within
+ *         CRC - 1 after it (C(c, w - 1) patterns).
+ */
+static double getBurstFraction(const unsigned int *positions, unsigned int supportLen, unsigned int weight)
+{
+    double count = 0.0;
+
+    if (weight <= 1) {
+        return 1.0;
+    }
+
+    for (unsigned int i = 0, end = 0; i < supportLen; ++i) {
+        while (end < supportLen && positions[end] - positions[i] < CRC) {
+            ++end;
+        }
+        if (end - i - 1 >= weight - 1) {
+            count += exp(logChoose(end - i - 1, weight - 1));
+        }
+    }
+
+    return count / exp(logChoose(supportLen, weight));
+}
+
+static int compareUint(const void *lhs, const void *rhs)
+{
+    unsigned int a = *(const unsigned int *)lhs;
+    unsigned int b = *(const unsigned int *)rhs;
+
+    return (a > b) - (a < b);
+}
+
+/*
+ *  Function to find the pairs of a support with the given syndrome.
+ *  Returns the first pair and stores the number of pairs to numFound.
+ */
+static const PairEntry *findPairs(const PairEntry *pairs, size_t numPair, uint32_t syndrome, size_t *numFound)
+{
+    size_t lower = 0;
+    size_t upper = numPair;
+
+    while (lower < upper) {
+        size_t middle = (lower + upper) / 2;
+
+        if (pairs[middle].syndrome < syndrome) {
+            lower = middle + 1;
+        }
+        else {
+            upper = middle;
+        }
+    }
+
+    size_t end = lower;
+    while (end < numPair && pairs[end].syndrome == syndrome) {
+        ++end;
+    }
+
+    *numFound = end - lower;
+    return &pairs[lower];
+}
+
+static inline bool testBit(const uint64_t *bitmap, unsigned int pos)
+{
+    return (bitmap[pos / 64] >> (pos % 64)) & 1;
+}
+
+static inline void flipBit(uint64_t *bitmap, unsigned int pos)
+{
+    bitmap[pos / 64] ^= (uint64_t)1 << (pos % 64);
+}
+
+/*
+ *  Function to build the nominal error distribution of the error model.
+ */
+static void initISModel(const SimConfig *config, ISModel *model)
+{
+    double flipRate = config->flipRate;
+
+    if (!(flipRate > 0.0 && flipRate < 1.0)) {
+        printf("Importance sampling needs a flip rate in (0, 1): %g\n", flipRate);
+        exit(EXIT_FAILURE);
+    }
+
+    if (config->model == ERROR_ADJ_PIN) {
+        printf("Importance sampling needs independent bit flips, which an adjacent-pin short does not have\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(model, 0, sizeof(ISModel));
+
+    // Supports of the error generators: the whole codeword, CHECK_SIZE bytes
+    // starting at byte 1..DATA_SIZE (genBurstError()), or the DRAM fault regions.
+    if (config->model == ERROR_RANDOM) {
+        model->numSupport = 1;
+        model->supportLen = CW_BITS;
+    }
+    else if (config->model == ERROR_BURST) {
+        model->numSupport = DATA_SIZE;
+        model->supportLen = CHECK_SIZE * BYTE;
+    }
+    else {
+        unsigned int regionPos[MAX_FAULT_BITS];
+
+        model->numSupport = getNumFaultRegion(config->model);
+        model->supportLen = getFaultRegion(config->model, 0, regionPos);
+    }
+
+    unsigned int supportLen = model->supportLen;
+    model->numPair = (size_t)supportLen * (supportLen - 1) / 2;
+    model->pairs = (PairEntry *)malloc(model->numSupport * model->numPair * sizeof(PairEntry));
+    model->supportPos = (unsigned int *)malloc(model->numSupport * supportLen * sizeof(unsigned int));
+    model->bitSyndrome = (uint32_t *)malloc(model->numSupport * supportLen * sizeof(uint32_t));
+
+    if (model->pairs == NULL || model->supportPos == NULL || model->bitSyndrome == NULL) {
+        printf("Unable to allocate pair syndrome tables\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int sorted[CW_BITS];
+    uint64_t numZeroSingle = 0, numZeroPair = 0, numZeroPairBurst = 0;
+    double burstFraction[CRC + 1] = {0};
+    bool fullRank = true;
+
+    for (unsigned int supportIdx = 0; supportIdx < model->numSupport; ++supportIdx) {
+        unsigned int *positions = model->supportPos + supportIdx * supportLen;
+        uint32_t *syndrome = model->bitSyndrome + supportIdx * supportLen;
+        PairEntry *pairs = model->pairs + supportIdx * model->numPair;
+        size_t pairIdx = 0;
+
+        if (isFaultModel(config->model)) {
+            getFaultRegion(config->model, supportIdx, positions);
+        }
+        else {
+            unsigned int base = (config->model == ERROR_RANDOM) ? 0 : (supportIdx + 1) * BYTE;
+
+            for (unsigned int i = 0; i < supportLen; ++i) {
+                positions[i] = base + i;
+            }
+        }
+
+        for (unsigned int i = 0; i < supportLen; ++i) {
+            syndrome[i] = synTable.bitSyndrome[positions[i]];
+        }
+
+        for (unsigned int i = 0; i < supportLen; ++i) {
+            model->supportSyndrome[supportIdx] ^= syndrome[i];
+            numZeroSingle += (syndrome[i] == 0);
+
+            for (unsigned int j = i + 1; j < supportLen; ++j) {
+                pairs[pairIdx].syndrome = syndrome[i] ^ syndrome[j];
+                pairs[pairIdx].first = (uint16_t)i;
+                pairs[pairIdx].second = (uint16_t)j;
+
+                if (pairs[pairIdx].syndrome == 0) {
+                    numZeroPair++;
+                    numZeroPairBurst += (positions[j] > positions[i] ? positions[j] - positions[i]
+                                                                     : positions[i] - positions[j]) < CRC;
+                }
+                ++pairIdx;
+            }
+        }
+
+        qsort(pairs, model->numPair, sizeof(PairEntry), comparePairEntry);
+
+        memcpy(sorted, positions, supportLen * sizeof(unsigned int));
+        qsort(sorted, supportLen, sizeof(unsigned int), compareUint);
+        for (unsigned int weight = 1; weight <= supportLen && weight <= CRC; ++weight) {
+            burstFraction[weight] += getBurstFraction(sorted, supportLen, weight) / model->numSupport;
+        }
+
+        // Every pattern of a support is detected if its syndromes are independent.
+        fullRank = fullRank && getSyndromeRank(synTable.bitSyndrome, positions, supportLen) == supportLen;
+    }
+
+    // Nominal weight distribution and exact category probabilities.
+    for (unsigned int weight = 0; weight <= supportLen; ++weight) {
+        model->pmf[weight] = exp(logChoose(supportLen, weight) + weight * log(flipRate)
+                                 + (supportLen - weight) * log1p(-flipRate));
+    }
+
+    model->category[IS_TOTAL] = -expm1(supportLen * log1p(-flipRate));
+    model->category[IS_ODD] = (flipRate < 0.5) ? -0.5 * expm1(supportLen * log1p(-2.0 * flipRate))
+                                               : 0.5 * (1.0 - pow(1.0 - 2.0 * flipRate, supportLen));
+    model->category[IS_DOUBLE] = model->pmf[2];
+    for (unsigned int weight = 1; weight <= supportLen && weight <= CRC; ++weight) {
+        model->category[IS_BURST32] += model->pmf[weight] * burstFraction[weight];
+    }
+
+    // Weights 1 and 2 are counted exactly.
+    double single = model->pmf[1] * numZeroSingle / ((double)model->numSupport * supportLen);
+    double pair = model->pmf[2] * numZeroPair / ((double)model->numSupport * model->numPair);
+
+    model->exactUndet[IS_TOTAL] = single + pair;
+    model->exactUndet[IS_ODD] = single;
+    model->exactUndet[IS_DOUBLE] = pair;
+    model->exactUndet[IS_BURST32] = single + model->pmf[2] * numZeroPairBurst / ((double)model->numSupport * model->numPair);
+
+    // Trim the strata of least probability from both ends, up to IS_TAIL_MASS.
+    double sampledMass = 0.0;
+    for (unsigned int weight = 3; weight <= supportLen; ++weight) {
+        sampledMass += model->pmf[weight];
+    }
+
+    model->minWeight = 3;
+    model->maxWeight = supportLen;
+    while (model->minWeight <= model->maxWeight) {
+        bool trimLow = model->pmf[model->minWeight] <= model->pmf[model->maxWeight];
+        double mass = trimLow ? model->pmf[model->minWeight] : model->pmf[model->maxWeight];
+
+        if (model->tailMass + mass > IS_TAIL_MASS * sampledMass) {
+            break;
+        }
+
+        model->tailMass += mass;
+        if (trimLow) {
+            model->minWeight++;
+        }
+        else {
+            model->maxWeight--;
+        }
+    }
+
+    model->exact = fullRank || model->minWeight > model->maxWeight;
+}
+
+/*
+ *  Function to run the trials of a chunk.
+ *
+ *  NOTE : A weight-w pattern e is produced from each of its C(w, 2) subsets S of
+ *         w - 2 bits with probability 1 / C(m, w - 2) / k(S), where k(S) is the
+ *         number of pairs outside S completing S. Its likelihood ratio is
+ *         (1 / C(m, w)) over the sum of these probabilities.
+ */
+static void runISChunk(const ISModel *model, uint64_t seed, ISChunk *chunk)
+{
+    unsigned int supportLen = model->supportLen;
+    unsigned int weight = chunk->weight;
+    bool complement = 2 * (weight - 2) > supportLen;  // draw the bits not in S instead
+    unsigned int numDraw = complement ? supportLen - (weight - 2) : weight - 2;
+    double ratioBase = (double)weight * (weight - 1) / ((double)(supportLen - weight + 2) * (supportLen - weight + 1));
+    Rng rng;
+
+    seedRng(&rng, seed, chunk->streamIdx);
+
+    for (uint64_t i = 0; i < chunk->numIter; ++i) {
+        unsigned int supportIdx = (model->numSupport > 1) ? nextRng(&rng) % model->numSupport : 0;
+        const unsigned int *positions = model->supportPos + supportIdx * supportLen;
+        const uint32_t *syndrome = model->bitSyndrome + supportIdx * supportLen;
+        const PairEntry *pairs = model->pairs + supportIdx * model->numPair;
+        uint64_t member[SUPPORT_WORDS] = {0};
+        uint32_t drawnSyndrome = 0;
+
+        // 1) Draw S.
+        if (complement) {
+            for (unsigned int pos = 0; pos < supportLen; ++pos) {
+                flipBit(member, pos);
+            }
+            drawnSyndrome = model->supportSyndrome[supportIdx];
+        }
+
+        for (unsigned int numDrawn = 0; numDrawn < numDraw; ) {
+            unsigned int pos = nextRng(&rng) % supportLen;
+
+            if (testBit(member, pos) == complement) {
+                flipBit(member, pos);
+                drawnSyndrome ^= syndrome[pos];
+                ++numDrawn;
+            }
+        }
+
+        // 2) Complete S with a pair outside S.
+        size_t numFound;
+        const PairEntry *found = findPairs(pairs, model->numPair, drawnSyndrome, &numFound);
+        unsigned int numValid = 0;
+
+        for (size_t k = 0; k < numFound; ++k) {
+            numValid += !testBit(member, found[k].first) && !testBit(member, found[k].second);
+        }
+        chunk->result.numIter++;
+
+        if (numValid == 0) {
+            continue;
+        }
+
+        unsigned int choice = nextRng(&rng) % numValid;
+        for (size_t k = 0; k < numFound; ++k) {
+            if (!testBit(member, found[k].first) && !testBit(member, found[k].second) && choice-- == 0) {
+                flipBit(member, found[k].first);
+                flipBit(member, found[k].second);
+                break;
+            }
+        }
+
+        // 3) Likelihood ratio over all ways to produce the pattern.
+        unsigned int bits[CW_BITS];
+        unsigned int numBit = 0;
+
+        for (unsigned int wordIdx = 0; wordIdx < SUPPORT_WORDS; ++wordIdx) {
+            for (uint64_t word = member[wordIdx]; word; word &= word - 1) {
+                bits[numBit++] = wordIdx * 64 + __builtin_ctzll(word);
+            }
+        }
+
+        double sumInverse = 0.0;
+        for (unsigned int a = 0; a < numBit; ++a) {
+            for (unsigned int b = a + 1; b < numBit; ++b) {
+                const PairEntry *other = findPairs(pairs, model->numPair, syndrome[bits[a]] ^ syndrome[bits[b]], &numFound);
+                unsigned int numComplete = 0;
+
+                for (size_t k = 0; k < numFound; ++k) {
+                    unsigned int first = other[k].first, second = other[k].second;
+                    bool firstFree = !testBit(member, first) || first == bits[a] || first == bits[b];
+                    bool secondFree = !testBit(member, second) || second == bits[a] || second == bits[b];
+
+                    numComplete += firstFree && secondFree;
+                }
+                sumInverse += 1.0 / numComplete;
+            }
+        }
+
+        unsigned int firstPos = positions[bits[0]], lastPos = positions[bits[0]];
+        for (unsigned int k = 1; k < numBit; ++k) {
+            firstPos = positions[bits[k]] < firstPos ? positions[bits[k]] : firstPos;
+            lastPos = positions[bits[k]] > lastPos ? positions[bits[k]] : lastPos;
+        }
+
+        double ratio = ratioBase / sumInverse;
+        bool inCategory[NUM_IS_CATEGORY] = {
+            true,
+            (weight % 2) == 1,
+            weight == 2,
+            lastPos - firstPos + 1 <= CRC
+        };
+
+        chunk->result.numEvent++;
+        for (int category = 0; category < NUM_IS_CATEGORY; ++category) {
+            if (inCategory[category]) {
+                chunk->result.sum[category] += ratio;
+                chunk->result.sumSq[category] += ratio * ratio;
+            }
+        }
+    }
+}
+
+/*
+ *  Worker thread function. Chunks are taken from the shared counter.
+ */
+static void *importanceWorker(void *arg)
+{
+    ISContext *context = (ISContext *)arg;
+
+    while (true) {
+        size_t chunkIdx = __atomic_fetch_add(&context->nextChunk, 1, __ATOMIC_RELAXED);
+        if (chunkIdx >= context->numChunk) {
+            break;
+        }
+
+        runISChunk(context->model, context->config->seed, &context->chunks[chunkIdx]);
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to get the variance of the mean of a stratum for a category.
+ */
+static double getStratumVariance(const ISStratum *stratum, int category)
+{
+    double n = (double)stratum->numIter;
+
+    if (stratum->numIter < 2) {
+        return 0.0;
+    }
+
+    double variance = (stratum->sumSq[category] - stratum->sum[category] * stratum->sum[category] / n) / (n - 1);
+    return variance > 0.0 ? variance / n : 0.0;
+}
+
+/*
+ *  Function to estimate P(undetected) of a category and the variance of the estimate.
+ */
+static double estimateUndetected(const ISModel *model, const ISStratum *strata, int category, double *variance)
+{
+    double estimate = model->exactUndet[category];
+
+    *variance = 0.0;
+    for (unsigned int weight = model->minWeight; weight <= model->maxWeight; ++weight) {
+        const ISStratum *stratum = &strata[weight];
+
+        if (stratum->numIter > 0) {
+            estimate += model->pmf[weight] * stratum->sum[category] / stratum->numIter;
+            *variance += model->pmf[weight] * model->pmf[weight] * getStratumVariance(stratum, category);
+        }
+    }
+
+    return estimate;
+}
+
+/*
+ *  Function to allocate the trials of a round to the strata.
+ *  Returns the number of allocated trials, which is the budget unless no stratum has a score.
+ *
+ *  NOTE : A stratum without an undetected sample is given the deviation it would
+ *         have with one sample of likelihood ratio 2 / ((m - w + 2)(m - w + 1)).
+ *         Shares are rounded down, and the remainder goes to the stratum of the
+ *         highest score, so a small budget is never rounded away.
+ */
+static uint64_t allocateRound(const ISModel *model, const ISStratum *strata, uint64_t budget, uint64_t *alloc)
+{
+    double score[CW_BITS + 1] = {0};
+    double totScore = 0.0;
+    unsigned int supportLen = model->supportLen;
+
+    for (unsigned int weight = model->minWeight; weight <= model->maxWeight; ++weight) {
+        const ISStratum *stratum = &strata[weight];
+        double deviation;
+
+        if (stratum->numEvent > 0) {
+            deviation = sqrt(getStratumVariance(stratum, IS_TOTAL) * stratum->numIter);
+        }
+        else {
+            deviation = 2.0 / ((double)(supportLen - weight + 2) * (supportLen - weight + 1)) / sqrt((double)stratum->numIter);
+        }
+
+        score[weight] = model->pmf[weight] * deviation;
+        totScore += score[weight];
+    }
+
+    uint64_t numAlloc = 0;
+    unsigned int topWeight = model->minWeight;
+
+    for (unsigned int weight = model->minWeight; weight <= model->maxWeight; ++weight) {
+        alloc[weight] = (totScore > 0.0) ? (uint64_t)(budget * (score[weight] / totScore)) : 0;
+        alloc[weight] = alloc[weight] < budget - numAlloc ? alloc[weight] : budget - numAlloc;
+        numAlloc += alloc[weight];
+        topWeight = score[weight] > score[topWeight] ? weight : topWeight;
+    }
+    if (totScore > 0.0) {
+        alloc[topWeight] += budget - numAlloc;
+        numAlloc = budget;
+    }
+
+    return numAlloc;
+}
+
+/*
+ *  Function to run the allocated trials of a round with worker threads.
+ *
+ *  NOTE : Chunks are merged in order, and each chunk has its own random stream,
+ *         so the result does not depend on the number of threads.
+ */
+static void runRound(const SimConfig *config, const ISModel *model, const uint64_t *alloc,
+    uint64_t *streamIdx, ISStratum *strata)
+{
+    size_t numChunk = 0;
+
+    for (unsigned int weight = model->minWeight; weight <= model->maxWeight; ++weight) {
+        numChunk += (alloc[weight] + IS_CHUNK_ITER - 1) / IS_CHUNK_ITER;
+    }
+
+    ISChunk *chunks = (ISChunk *)calloc(numChunk ? numChunk : 1, sizeof(ISChunk));
+    pthread_t *threads = (pthread_t *)calloc(config->numThreads, sizeof(pthread_t));
+    ISContext context = { config, model, chunks, numChunk, 0 };
+
+    if (chunks == NULL || threads == NULL) {
+        printf("Unable to allocate %zu chunks\n", numChunk);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t chunkIdx = 0;
+    for (unsigned int weight = model->minWeight; weight <= model->maxWeight; ++weight) {
+        for (uint64_t first = 0; first < alloc[weight]; first += IS_CHUNK_ITER) {
+            chunks[chunkIdx].weight = weight;
+            chunks[chunkIdx].numIter = (alloc[weight] - first < IS_CHUNK_ITER) ? alloc[weight] - first : IS_CHUNK_ITER;
+            chunks[chunkIdx].streamIdx = (*streamIdx)++;
+            ++chunkIdx;
+        }
+    }
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        if (pthread_create(&threads[threadIdx], NULL, importanceWorker, &context) != 0) {
+            printf("Unable to create thread %u\n", threadIdx);
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        pthread_join(threads[threadIdx], NULL);
+    }
+
+    for (chunkIdx = 0; chunkIdx < numChunk; ++chunkIdx) {
+        ISStratum *stratum = &strata[chunks[chunkIdx].weight];
+        const ISStratum *result = &chunks[chunkIdx].result;
+
+        stratum->numIter += result->numIter;
+        stratum->numEvent += result->numEvent;
+        for (int category = 0; category < NUM_IS_CATEGORY; ++category) {
+            stratum->sum[category] += result->sum[category];
+            stratum->sumSq[category] += result->sumSq[category];
+        }
+    }
+
+    free(threads);
+    free(chunks);
+}
+
+/*
+ *  Function to print the estimate of every category with its confidence interval.
+ */
+static void printISResult(const ISModel *model, const ISStratum *strata, double z)
+{
+    printf("%s   %-12s %-12s %-27s %s\n", "Category                  ", "P(error)", "P(undet)", "Confidence interval",
+        "Undetected fraction");
+
+    for (int category = 0; category < NUM_IS_CATEGORY; ++category) {
+        double variance = 0.0;
+        double estimate = model->exact ? 0.0 : estimateUndetected(model, strata, category, &variance);
+        bool sampled = false;
+
+        printf("%s : %.5e  %.5e  ", categoryName[category], model->category[category], estimate);
+
+        for (unsigned int weight = model->minWeight; weight <= model->maxWeight && !model->exact; ++weight) {
+            sampled = sampled || strata[weight].sum[category] > 0.0;
+        }
+
+        if (model->exact || category == IS_DOUBLE) {
+            printf("%-27s ", "(exact)");
+        }
+        else if (!sampled) {
+            printf("%-27s ", "(no undetected sample)");
+        }
+        else {
+            double halfWidth = z * sqrt(variance);
+            char interval[64];
+
+            snprintf(interval, sizeof(interval), "[%.4e, %.4e]", estimate > halfWidth ? estimate - halfWidth : 0.0,
+                estimate + halfWidth + model->tailMass);
+            printf("%-27s ", interval);
+        }
+
+        printf("%.5e\n", model->category[category] > 0.0 ? estimate / model->category[category] : 0.0);
+    }
+}
+
+/*
+ *  Function for importance sampling of undetected errors with adaptive stopping.
+ *
+ *  NOTE : Runs until the relative half-width of the confidence interval of
+ *         P(undetected) is at most --rel-err, or its upper bound is below --bound,
+ *         after at least IS_MIN_EVENTS undetected samples; --iter caps the trials.
+ */
+void simulateImportance(const SimConfig *config)
+{
+    ISModel model;
+    double z = getNormalQuantile(0.5 + config->confLevel / 2);
+
+    initISModel(config, &model);
+
+    printf("Seed : %llu, Threads : %u\n", (unsigned long long)config->seed, config->numThreads);
+    printf("Model : %s (%u bits), Flip rate : %g, Confidence level : %g%%\n",
+        getErrorModelName(config->model), model.supportLen, config->flipRate, config->confLevel * 100);
+
+    if (model.exact) {
+        printf("##### Importance Sampling Result #####\n");
+        printf("Every error pattern of the model has a non-zero syndrome.\n");
+        printISResult(&model, NULL, z);
+        free(model.bitSyndrome);
+        free(model.supportPos);
+        free(model.pairs);
+        return;
+    }
+
+    ISStratum *strata = (ISStratum *)calloc(CW_BITS + 1, sizeof(ISStratum));
+    uint64_t alloc[CW_BITS + 1] = {0};
+    uint64_t numIter = 0, numEvent = 0, streamIdx = 0;
+    unsigned int numRound = 0;
+    double estimate, variance;
+
+    if (strata == NULL) {
+        printf("Unable to allocate strata\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (true) {
+        if (numRound == 0) {
+            for (unsigned int weight = model.minWeight; weight <= model.maxWeight; ++weight) {
+                alloc[weight] = IS_PILOT_ITER;
+            }
+        }
+        else {
+            uint64_t budget = numIter > IS_ROUND_ITER ? numIter : IS_ROUND_ITER;  // rounds double the trials
+            if (budget > config->numIter - numIter) {
+                budget = config->numIter - numIter;
+            }
+            if (allocateRound(&model, strata, budget, alloc) == 0) {
+                printf("Trial budget exhausted (--iter %llu)\n", (unsigned long long)config->numIter);
+                break;
+            }
+        }
+
+        runRound(config, &model, alloc, &streamIdx, strata);
+        ++numRound;
+
+        numIter = numEvent = 0;
+        for (unsigned int weight = model.minWeight; weight <= model.maxWeight; ++weight) {
+            numIter += strata[weight].numIter;
+            numEvent += strata[weight].numEvent;
+        }
+
+        estimate = estimateUndetected(&model, strata, IS_TOTAL, &variance);
+        double halfWidth = z * sqrt(variance);
+
+        printf("Round %u : %llu trials, %llu undetected samples, P(undetected) = %.4e +- %.4e\n", numRound,
+            (unsigned long long)numIter, (unsigned long long)numEvent, estimate, halfWidth);
+
+        bool converged = numEvent >= IS_MIN_EVENTS
+            && ((config->relErr > 0.0 && halfWidth <= config->relErr * estimate)
+             || (config->bound > 0.0 && estimate + halfWidth + model.tailMass < config->bound));
+
+        if (converged || numIter >= config->numIter) {
+            break;
+        }
+    }
+
+    printf("##### Importance Sampling Result #####\n");
+    printf("Trials : %llu in %u rounds, Undetected samples : %llu\n",
+        (unsigned long long)numIter, numRound, (unsigned long long)numEvent);
+    printf("Weight strata : %u..%u (exact below 3, truncated mass %.3e)\n", model.minWeight, model.maxWeight, model.tailMass);
+    printISResult(&model, strata, z);
+
+    if (estimate > 0.0 && variance > 0.0) {
+        // Plain Monte Carlo has a variance of P(1 - P) per trial.
+        printf("Relative error : %.2f%%, Variance reduction over plain Monte Carlo : %.3e\n",
+            100.0 * z * sqrt(variance) / estimate, estimate * (1.0 - estimate) / (variance * numIter));
+    }
+
+    free(strata);
+    free(model.bitSyndrome);
+    free(model.supportPos);
+    free(model.pairs);
+}
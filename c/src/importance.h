@@ -0,0 +1,33 @@
+#ifndef __IMPORTANCE_H__
+#define __IMPORTANCE_H__
+
+#define IS_PILOT_ITER 4096          // trials of every weight stratum in the first round
+#define IS_ROUND_ITER (1 << 20)     // minimum trials of a later round
+#define IS_CHUNK_ITER 16384         // trials per random number stream
+#define IS_MIN_EVENTS 10            // undetected samples needed before stopping
+#define IS_TAIL_MASS 1e-30          // weight strata are truncated up to this fraction of P(weight >= 3)
+#define NUM_IS_CATEGORY 4
+
+/*
+ *  Error categories reported by importance sampling (same as printSimResult()).
+ */
+typedef enum {
+    IS_TOTAL,                   // any non-zero error
+    IS_ODD,                     // odd number of bit errors
+    IS_DOUBLE,                  // two bit errors
+    IS_BURST32                  // burst length <= 32
+} ISCategory;
+
+/*
+ *  Likelihood ratio sums of the undetected samples of a weight stratum.
+ */
+typedef struct {
+    uint64_t numIter;
+    uint64_t numEvent;
+    double sum[NUM_IS_CATEGORY];
+    double sumSq[NUM_IS_CATEGORY];
+} ISStratum;
+
+void simulateImportance(const SimConfig *config);
+
+#endif
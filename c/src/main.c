@@ -0,0 +1,445 @@
+/*
+ *  This program performs CRC32 checksum generation and error detection
+ *  for a given set of data streams. There are ten modes available.
+ *  main.c and the mode files form the command line front end, linked with
+ *  the CRC library (libsait_crc) for the specs and contexts of sait_crc.h.
+ * 
+ *    1) Simulation mode:
+ *         Performs Monte Carlo simulation to evaluate the effectiveness of CRC32 
+ *         error detection. Simulates random errors in codewords and checks 
+ *         how well CRC32 can detect these errors. With --is, rare undetected
+ *         errors are estimated by importance sampling until a target is met.
+ *         With --correct, short bursts are corrected by syndrome lookup, and
+ *         corrected, miscorrected and retried errors are counted. With
+ *         --bitslice, 512 trials are evaluated together in bit-sliced words.
+ *         A campaign can be split with --shard i/N, saved with --checkpoint
+ *         and continued with --resume. --report writes a JSON report of the
+ *         run, with phase timers in builds with 'make PROFILE=1'.
+ *  
+ *    2) Table generation mode:
+ *         Generates a CRC32 lookup table based on the given polynomial and 
+ *         prints the table. Useful for precomputing CRC32 values for efficient 
+ *         checksum calculation. 'table rtl' prints the coefficient table of the
+ *         table-based RTL for any data width, polynomial and bit order, and
+ *         'table spec' checks the CRC-8/16/32/64 specs of the generic engine.
+ *  
+ *    3) Encoding mode:
+ *         Serializes a data stream and computes the CRC32 checksum for the 
+ *         serialized data. Outputs both the data and the corresponding checksum.
+ *         The checksum is computed with a library context of the crc32-sait spec,
+ *         or of another 32-bit spec with '--spec <name>'. A kernel of crc32.c can
+ *         be selected with '--kernel <name>' instead. The layout of the data
+ *         streams is set with '--dq', '--bl', '--group', '--order' and '--map'.
+ *
+ *    4) Exhaustive mode:
+ *         Enumerates every error pattern of low weight and every short burst,
+ *         and reports exact undetected counts and the minimum Hamming distance.
+ *
+ *    5) Search mode:
+ *         Evaluates candidate polynomials at the codeword length and ranks them by
+ *         Hamming distance, burst coverage and DRAM fault coverage.
+ *
+ *    6) Stream mode:
+ *         Serializes and encodes every burst of a binary capture file in batches,
+ *         and writes a binary (or hex) checksum stream.
+ *
+ *    7) Benchmark mode:
+ *         Measures the CRC kernels, batch methods, incremental update and
+ *         simulator throughput, cross-checked against the bitwise reference.
+ *
+ *    8) Analysis mode:
+ *         Enumerates the 2^32 codewords of the dual code, derives the exact
+ *         weight distribution by the MacWilliams identity, and prints the
+ *         undetected error probability over a range of bit error rates.
+ *
+ *    9) Merge mode:
+ *         Combines the result files of simulation shards into one report.
+ *
+ *   10) Sweep mode:
+ *         Evaluates a list of bit error rates on shared random draws (common
+ *         random numbers), and writes the detection curves as CSV.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+#include <string.h>
+#include "crc32.h"
+#include "fold.h"
+#include "syndrome.h"
+#include "sim.h"
+#include "importance.h"
+#include "exhaust.h"
+#include "analyze.h"
+#include "search.h"
+#include "stream.h"
+#include "serial.h"
+#include "batch.h"
+#include "bench.h"
+#include "combine.h"
+#include "rtltable.h"
+#include "correct.h"
+#include "bitslice.h"
+#include "shard.h"
+#include "sweep.h"
+#include "report.h"
+#include "sait_crc.h"
+
+static const char *getEncodeSpecName(int argc, char *argv[]);
+
+int main(int argc, char *argv[]) {
+
+    ProgramMode mode = getMode(argc, argv);
+
+    initCRCEngine();
+
+    switch (mode) {
+        // Simulation modes perform MonteCarlo simulation.
+        case MODE_SIMULATION : {
+            SimConfig config;
+            getSimConfig(argc, argv, &config);
+            if (config.importance) {
+                simulateImportance(&config);
+            }
+            else {
+                simulate(&config);
+            }
+            break;
+        }
+
+        // Table generation modes generates and prints CRC lookup table.
+        case MODE_TABLE_GENERATION : {
+            // 'table rtl' prints the coefficient table of the table-based RTL instead.
+            if (argc > 2 && strcmp(argv[2], "rtl") == 0) {
+                RTLTableConfig config;
+                getRTLTableConfig(argc, argv, &config);
+                printRTLTable(&config);
+                break;
+            }
+            // 'table spec' checks the specs of the generic engine.
+            if (argc > 2 && strcmp(argv[2], "spec") == 0) {
+                printCRCSpecs();
+                break;
+            }
+            uint32_t table[TABLE_SIZE];
+            genCRCTable(table);
+            if (memcmp(table, CRCTable, sizeof(table)) != 0) {
+                printf("Generated table does not match CRCTable\n");
+                exit(EXIT_FAILURE);
+            }
+            printCRCTable(table);
+            break;
+        }
+
+        // Encoding mode generate CRC checksum for the input data stream.
+        case MODE_ENCODING : {
+            // Get the layout of the data streams ('--dq', '--bl', '--group', '--order', '--map').
+            SerialLayout layout;
+            getSerialLayout(argc, argv, &layout);
+
+            if (!checkSerialLayout(&layout)) {
+                printf("Serial layout self-check failed\n");
+                exit(EXIT_FAILURE);
+            }
+
+            // Get input data chunk : read from 'data.txt'
+            uint32_t dataStream[MAX_SERIAL_BEATS];
+
+            FILE *inputFile = fopen("../src/data.txt", "r");
+            if (inputFile == NULL) {
+                printf("Unable to open data.txt\n");
+                return 1;
+            }
+            
+            for (unsigned int beat = 0; beat < layout.numBeats; ++beat) {
+                if (fscanf(inputFile, "%x", &dataStream[beat]) != 1) {
+                    printf("data.txt has fewer than %u words\n", layout.numBeats);
+                    return 1;
+                }
+            }
+
+            fclose(inputFile);
+
+            size_t dataLen = getSerialSize(&layout);
+            uint8_t data[MAX_SERIAL_BEATS * MAX_SERIAL_DQ / BYTE] = {0};
+
+            // Serialize data chunk into data
+            serializeLayout(&layout, dataStream, data);
+
+            // Now encoding with a library context of the spec ('--spec <name>', crc32-sait by default),
+            // or with the kernel selected by '--kernel <name>'.
+            uint32_t checksum;  // checksum for the received data
+            const char *specName = getEncodeSpecName(argc, argv);
+            if (specName != NULL) {
+                static CRCContext ctx;
+                if (!initCRCContext(&ctx, getCRCSpec(specName))) {
+                    printf("Unknown or unsupported spec: %s (32-bit specs of 'table spec')\n", specName);
+                    exit(EXIT_FAILURE);
+                }
+                checksum = calcCRCWithContext(&ctx, data, dataLen);
+            }
+            else {
+                checksum = calcCRCWithKernel(getKernel(argc, argv), data, dataLen);
+            }
+
+            // Show data and the calculated checksum.
+            printf("[Data] : ");
+            for (size_t byteIdx = 0; byteIdx < dataLen; ++byteIdx) {
+                printf("%02X", data[byteIdx]);
+                if (byteIdx % 4 == 3 && byteIdx != dataLen - 1) {
+                    printf("_");
+                }
+            }
+            printf("\n");
+            printf("[Checksum] : %08X\n", checksum);
+            break;
+        }
+
+        // Exhaustive mode enumerates low-weight and burst errors.
+        case MODE_EXHAUSTIVE : {
+            ExhaustConfig config;
+            getExhaustConfig(argc, argv, &config);
+            exhaust(&config);
+            break;
+        }
+
+        // Analysis mode computes the exact undetected error probability.
+        case MODE_ANALYZE : {
+            AnalyzeConfig config;
+            getAnalyzeConfig(argc, argv, &config);
+            analyze(&config);
+            break;
+        }
+
+        // Merge mode combines the result files of simulation shards.
+        case MODE_MERGE : {
+            mergeShards(argc, argv);
+            break;
+        }
+
+        // Sweep mode evaluates many bit error rates on common random numbers.
+        case MODE_SWEEP : {
+            SweepConfig config;
+            getSweepConfig(argc, argv, &config);
+            sweep(&config);
+            break;
+        }
+
+        // Search mode ranks candidate polynomials.
+        case MODE_SEARCH : {
+            SearchConfig config;
+            getSearchConfig(argc, argv, &config);
+            search(&config);
+            free(config.polys);
+            break;
+        }
+
+        // Stream mode encodes every burst of a binary capture file.
+        case MODE_STREAM : {
+            StreamConfig config;
+            getStreamConfig(argc, argv, &config);
+            encodeStream(&config);
+            break;
+        }
+
+        // Benchmark mode measures the CRC kernels and the simulator.
+        case MODE_BENCHMARK : {
+            BenchConfig config;
+            getBenchConfig(argc, argv, &config);
+            benchmark(&config);
+            break;
+        }
+
+        default : { // should not reach here
+            printf("Invalid program mode.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *  Function to get the spec of encoding mode from program input arguments ('--spec <name>').
+ *  Returns "crc32-sait" if not given, or NULL if a kernel is selected with '--kernel <name>'.
+ */
+static const char *getEncodeSpecName(int argc, char *argv[])
+{
+    bool kernelGiven = false;
+
+    for (int argIdx = 2; argIdx < argc - 1; ++argIdx) {
+        if (strcmp(argv[argIdx], "--spec") == 0) {
+            return argv[argIdx + 1];
+        }
+        kernelGiven |= strcmp(argv[argIdx], "--kernel") == 0;
+    }
+
+    return kernelGiven ? NULL : "crc32-sait";
+}
+
+/*
+ *  Function to print the modes and their options.
+ */
+static void printUsage(FILE *out, const char *program)
+{
+    fprintf(out, "Usage: %s <mode>\n\n", program);
+    fprintf(out, "Available modes: sim, table, enc, exhaust, search, stream, bench, analyze, merge, sweep\n");
+    fprintf(out, "  + sim: simulation mode\n");
+    fprintf(out, "  + table: table generation mode ('table rtl' for the RTL coefficient table,\n");
+    fprintf(out, "           'table spec' to check the CRC-8/16/32/64 specs of the generic engine)\n");
+    fprintf(out, "  + enc: encoding mode\n");
+    fprintf(out, "  + exhaust: exhaustive enumeration mode\n");
+    fprintf(out, "  + search: polynomial search mode\n");
+    fprintf(out, "  + stream: streaming batch encoding mode\n");
+    fprintf(out, "  + bench: benchmark mode\n");
+    fprintf(out, "  + analyze: exact weight distribution and undetected error probability\n");
+    fprintf(out, "  + merge: merge mode, combines shard result files ('merge <FILE>... [--conf <C>]')\n");
+    fprintf(out, "  + sweep: bit error rate sweep on common random numbers, CSV curves\n");
+    fprintf(out, "\nOptions for sim:\n");
+    fprintf(out, "  --iter <N>    : number of iterations (default: %d, limit of --is: %d)\n", NUM_ITER, SIM_MAX_ITER);
+    fprintf(out, "  --threads <N> : number of worker threads (default: 1)\n");
+    fprintf(out, "  --seed <S>    : random seed (default: current time)\n");
+    fprintf(out, "  --flip-rate <P> : bit flip rate within a burst (default: 0.5)\n");
+    fprintf(out, "  --ref         : use per-bit reference error generation\n");
+    fprintf(out, "  --model <NAME> : error model (default: burst)\n");
+    fprintf(out, "                   burst  : bits of %d bytes at a random position\n", CHECK_SIZE);
+    fprintf(out, "                   random : bits of the whole codeword\n");
+    fprintf(out, "                   pin, adj-pin, beat, x4, x8 : DRAM fault of a DQ, adjacent-DQ short,\n");
+    fprintf(out, "                   beat, or x4/x8 device, mapped through serialize()\n");
+    fprintf(out, "  --conf <C>    : confidence level of intervals (default: %g)\n", SIM_CONF_LEVEL);
+    fprintf(out, "  --is          : importance sampling of undetected errors until a target is met\n");
+    fprintf(out, "  --rel-err <E> : --is target relative error of P(undetected) (default: %g)\n", SIM_REL_ERR);
+    fprintf(out, "  --bound <B>   : --is stops once P(undetected) is below B (default: off)\n");
+    fprintf(out, "  --correct <L> : correct bursts up to L bits (up to %d) by syndrome lookup (default: off)\n", MAX_CORRECT_BURST);
+    fprintf(out, "  --bitslice    : bit-sliced engine, %d trials at a time (burst and random models)\n", BITSLICE_LANES);
+    fprintf(out, "  --shard <i/N> : run shard i of N of the campaign (default: 0/1)\n");
+    fprintf(out, "  --checkpoint <FILE> : save counters periodically and at the end (shard result file)\n");
+    fprintf(out, "  --checkpoint-every <S> : seconds between checkpoints (default: %g)\n", CHECKPOINT_SEC);
+    fprintf(out, "  --resume <FILE> : continue the campaign of a checkpoint\n");
+    fprintf(out, "  --report <FILE> : write a JSON report of the run, '-' for stdout (default: off)\n");
+    fprintf(out, "  --progress <S> : seconds between progress lines, 0 for none (PROFILE=1 builds, default: %g)\n", SIM_PROGRESS_SEC);
+    fprintf(out, "\nOptions for enc:\n");
+    fprintf(out, "  --kernel <bitwise|table|slice8|slice16|fold|clmul|auto> : encode with a CRC kernel instead of a context\n");
+    fprintf(out, "  --spec <NAME> : library context of a 32-bit spec of 'table spec' (default: crc32-sait)\n");
+    fprintf(out, "  --dq <N>      : number of DQs, multiple of 8 up to %d (default: %d)\n", MAX_SERIAL_DQ, DQ_SIZE);
+    fprintf(out, "  --bl <N>      : burst length (default: %d)\n", BL);
+    fprintf(out, "  --group <N>   : number of data streams in a group (default: %d)\n", GROUP_SIZE);
+    fprintf(out, "  --order <beat|pin> : a byte holds 8 DQs of a beat, or 8 beats of a DQ (default: beat)\n");
+    fprintf(out, "  --map <B0,B1,...>  : beat of each serialized slot (default: serialize() order)\n");
+    fprintf(out, "\nOptions for table rtl (coefficient table of CRC32_ENC.sv / CRC32_DEC.sv):\n");
+    fprintf(out, "  --width <W>   : data bits of the bus (default: %d)\n", RTL_DATA_WIDTH);
+    fprintf(out, "  --crc-width <N> : checksum bits, up to %d (default: %d)\n", MAX_RTL_CRC_WIDTH, RTL_CRC_WIDTH);
+    fprintf(out, "  --poly <P>    : generator polynomial without the highest 1 (default: 0x%08X)\n", RTL_POLY);
+    fprintf(out, "  --reflect     : bytes enter LSB first, and the checksum is reflected\n");
+    fprintf(out, "\nOptions for exhaust:\n");
+    fprintf(out, "  --weight <K>  : maximum error weight (default: %d)\n", EXHAUST_WEIGHT);
+    fprintf(out, "  --burst <L>   : maximum burst length (default: %d)\n", EXHAUST_BURST);
+    fprintf(out, "  --threads <N> : number of worker threads (default: 1)\n");
+    fprintf(out, "\nOptions for analyze:\n");
+    fprintf(out, "  --ber-from <P> : lowest bit error rate (default: %g)\n", ANALYZE_BER_FROM);
+    fprintf(out, "  --ber-to <P>  : highest bit error rate, up to 0.5 (default: %g)\n", ANALYZE_BER_TO);
+    fprintf(out, "  --points <N>  : number of bit error rates, log-spaced (default: %d)\n", ANALYZE_POINTS);
+    fprintf(out, "  --weights <N> : number of non-zero weights printed (default: %d)\n", ANALYZE_WEIGHTS);
+    fprintf(out, "  --threads <N> : number of worker threads (default: 1)\n");
+    fprintf(out, "\nOptions for sweep:\n");
+    fprintf(out, "  --ber <P1,P2,...> : bit error rates, 2^-32 to 0.5, up to %d (default: %d log-spaced from %g to %g)\n",
+        MAX_SWEEP_POINTS, SWEEP_POINTS, SWEEP_BER_FROM, SWEEP_BER_TO);
+    fprintf(out, "  --iter <N>    : number of trials (default: %d)\n", NUM_ITER);
+    fprintf(out, "  --threads <N> : number of worker threads (default: 1)\n");
+    fprintf(out, "  --seed <S>    : random seed (default: current time)\n");
+    fprintf(out, "  --model <NAME> : error model, any of sim but adj-pin (default: random)\n");
+    fprintf(out, "  --conf <C>    : confidence level of intervals (default: %g)\n", SIM_CONF_LEVEL);
+    fprintf(out, "  --out <FILE>  : CSV file (default: stdout)\n");
+    fprintf(out, "\nOptions for search:\n");
+    fprintf(out, "  --poly <P1,P2,...>   : candidate polynomials (default: C and RTL polynomials)\n");
+    fprintf(out, "  --range <A:B[:S]>    : candidate polynomials from A to B with step S\n");
+    fprintf(out, "  --min-hd <D>  : reject candidates with smaller Hamming distance (default: %d)\n", SEARCH_MIN_HD);
+    fprintf(out, "  --top <N>     : number of candidates to report (default: %d)\n", SEARCH_TOP);
+    fprintf(out, "  --threads <N> : number of worker threads (default: 1)\n");
+    fprintf(out, "\nOptions for stream:\n");
+    fprintf(out, "  --in <FILE>   : binary file of back-to-back bursts (required)\n");
+    fprintf(out, "  --out <FILE>  : checksum stream (default: <input>.crc)\n");
+    fprintf(out, "  --hex         : write hex lines instead of 4-byte big-endian records\n");
+    fprintf(out, "  --batch <N>   : number of bursts per batch (default: %d)\n", STREAM_BATCH);
+    fprintf(out, "  --threads <N> : number of worker threads (default: 1)\n");
+    fprintf(out, "\nOptions for bench:\n");
+    fprintf(out, "  --min-size <N> : smallest buffer in bytes (default: %d)\n", BENCH_MIN_SIZE);
+    fprintf(out, "  --max-size <N> : largest buffer in bytes (default: %llu)\n", BENCH_MAX_SIZE);
+    fprintf(out, "  --lines <N>   : largest batch of lines (default: %d)\n", BENCH_LINES);
+    fprintf(out, "  --iter <N>    : simulation trials per call (default: %d)\n", BENCH_SIM_ITER);
+    fprintf(out, "  --threads <N> : threads of calcCRCParallel() (default: number of CPUs)\n");
+    fprintf(out, "  --format <text|csv|json> : report format (default: text)\n");
+    fprintf(out, "  --out <FILE>  : report file (default: stdout)\n");
+}
+
+/*
+ *  Function to get the value of the option at argIdx, and move argIdx to the value.
+ *  Prints the usage on stderr and exits if the option is the last argument.
+ */
+char *getOptionValue(int argc, char *argv[], int *argIdx)
+{
+    if (*argIdx == argc - 1) {
+        fprintf(stderr, "Missing value of option %s\n\n", argv[*argIdx]);
+        printUsage(stderr, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    return argv[++*argIdx];
+}
+
+/*
+ *  Function to print the usage on stderr and exit, for an unknown option at argIdx.
+ */
+void exitUnknownOption(char *argv[], int argIdx)
+{
+    fprintf(stderr, "Unknown option of %s: %s\n\n", argv[1], argv[argIdx]);
+    printUsage(stderr, argv[0]);
+    exit(EXIT_FAILURE);
+}
+
+/*
+ *  Function to get mode from program input arguments.
+ */
+ProgramMode getMode(int argc, char *argv[]) {
+    if (argc < 2) {
+        printUsage(stdout, argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (strcmp(argv[1], "sim") == 0) {
+        return MODE_SIMULATION;
+    }
+    else if (strcmp(argv[1], "table") == 0) {
+        return MODE_TABLE_GENERATION;
+    }
+    else if (strcmp(argv[1], "enc") == 0) {
+        return MODE_ENCODING;
+    }
+    else if (strcmp(argv[1], "exhaust") == 0) {
+        return MODE_EXHAUSTIVE;
+    }
+    else if (strcmp(argv[1], "search") == 0) {
+        return MODE_SEARCH;
+    }
+    else if (strcmp(argv[1], "stream") == 0) {
+        return MODE_STREAM;
+    }
+    else if (strcmp(argv[1], "bench") == 0) {
+        return MODE_BENCHMARK;
+    }
+    else if (strcmp(argv[1], "analyze") == 0) {
+        return MODE_ANALYZE;
+    }
+    else if (strcmp(argv[1], "merge") == 0) {
+        return MODE_MERGE;
+    }
+    else if (strcmp(argv[1], "sweep") == 0) {
+        return MODE_SWEEP;
+    }
+    else {
+        printf("Unknown mode: %s\n", argv[1]);
+        exit(EXIT_FAILURE);
+    }
+}
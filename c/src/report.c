@@ -0,0 +1,211 @@
+/*
+ *  Structured run report of the simulation (see report.h).
+ *
+ *  'sim --report FILE' ends a run with a JSON report of:
+ *
+ *    1) config     : CRC spec, codeword size, seed, iterations and simulation settings
+ *    2) throughput : wall time and trials per second of this run
+ *    3) phases     : TSC cycles per trial of each phase of simulateChunk()
+ *    4) threads    : trials, chunks and cycles of each worker
+ *    5) results    : every detection counter, with its ratio and Wilson interval
+ *
+ *  NOTE : Phases and cycles are only measured in builds with SIM_PROFILE
+ *         ('make PROFILE=1'); otherwise "profile" is false and they are empty or 0.
+ *         The bit-sliced engine has no per-trial phases.
+ *         Phase cycles are net of the timer: the cost of an empty lap ("lapCycles")
+ *         is taken off every phase of every sampled trial.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "sim.h"
+#include "bitslice.h"
+#include "report.h"
+
+#if PROFILE_ENABLED
+#include <x86intrin.h>
+#endif
+
+/*
+ *  Function to get the name of a phase of simulateChunk().
+ */
+const char *getSimPhaseName(SimPhase phase)
+{
+    switch (phase) {
+        case SIM_PHASE_GEN    : return "gen";
+        case SIM_PHASE_DECODE : return "decode";
+        case SIM_PHASE_COUNT  : return "count";
+        case SIM_PHASE_BURST  : return "burst";
+        case SIM_PHASE_STATS  : return "stats";
+        default               : return "unknown";
+    }
+}
+
+/*
+ *  Function to measure the cycles of an empty lap of the phase timers.
+ *  Returns 0 in builds without SIM_PROFILE.
+ *
+ *  NOTE : Empty trials go through the same macros as simulateChunk(), so every
+ *         phase holds exactly one lap. Interrupts only add cycles, so the lowest
+ *         average of SIM_LAP_ROUNDS rounds is taken.
+ */
+double measureProfileLap()
+{
+    double lapCycles = 0.0;
+
+#if PROFILE_ENABLED
+    for (int round = 0; round < SIM_LAP_ROUNDS; ++round) {
+        SimProfile profile = {0};
+        uint64_t roundCycles = 0;
+
+        for (int trialIdx = 0; trialIdx < SIM_LAP_TRIALS; ++trialIdx) {
+            PROFILE_START(lap, 0);
+            PROFILE_LAP(&profile, SIM_PHASE_GEN, lap);
+            PROFILE_LAP(&profile, SIM_PHASE_DECODE, lap);
+            PROFILE_LAP(&profile, SIM_PHASE_COUNT, lap);
+            PROFILE_LAP(&profile, SIM_PHASE_BURST, lap);
+            PROFILE_END(&profile, lap);
+        }
+        for (int phase = 0; phase < NUM_SIM_PHASES; ++phase) {
+            roundCycles += profile.phaseCycles[phase];
+        }
+
+        double roundLap = (double)roundCycles / ((double)profile.numSampled * NUM_SIM_PHASES);
+        lapCycles = (round == 0 || roundLap < lapCycles) ? roundLap : lapCycles;
+    }
+#endif
+
+    return lapCycles;
+}
+
+/*
+ *  Function to print a detected ratio with its confidence interval as a JSON object.
+ */
+static void printRatioJSON(FILE *out, const char *name, uint64_t numDet, uint64_t numTot, double z, bool last)
+{
+    double lower, upper;
+
+    getWilsonInterval(numDet, numTot, z, &lower, &upper);
+    fprintf(out, "    \"%s\": {\"total\": %llu, \"detected\": %llu, \"ratio\": %.9f, \"lower\": %.9f, \"upper\": %.9f}%s\n",
+        name, (unsigned long long)numTot, (unsigned long long)numDet, numTot ? (double)numDet / numTot : 0.0,
+        lower, upper, last ? "" : ",");
+}
+
+/*
+ *  Function to write the JSON report of a simulation run ("-" for stdout).
+ *
+ *  NOTE : result holds the counters of the whole campaign (with a resumed checkpoint),
+ *         and profiles the counters of each worker in this run.
+ */
+void writeSimReport(const char *path, const SimConfig *config, const SimResult *result,
+    const SimProfile *profiles, double seconds, double tscHz, double lapCycles)
+{
+    SimProfile total = {0};
+    double z = getNormalQuantile(0.5 + config->confLevel / 2);
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        total.numTrial += profiles[threadIdx].numTrial;
+        total.numChunk += profiles[threadIdx].numChunk;
+        total.chunkCycles += profiles[threadIdx].chunkCycles;
+        total.numSampled += profiles[threadIdx].numSampled;
+        for (int phase = 0; phase < NUM_SIM_PHASES; ++phase) {
+            total.phaseCycles[phase] += profiles[threadIdx].phaseCycles[phase];
+        }
+    }
+
+    FILE *out = stdout;
+    if (strcmp(path, "-") != 0) {
+        out = fopen(path, "w");
+        if (out == NULL) {
+            printf("Unable to open the report file: %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const char *engine = config->bitSlice ? "bit-sliced" : (config->refGen ? "reference" : "per-trial");
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\n");
+    fprintf(out, "    \"genPoly\": \"0x%08X\",\n", GEN_POLY);
+    fprintf(out, "    \"initVal\": \"0x%08X\",\n", INIT_VAL);
+    fprintf(out, "    \"xorVal\": \"0x%08X\",\n", XOR_VAL);
+    fprintf(out, "    \"reflect\": %s,\n", REFLECT ? "true" : "false");
+    fprintf(out, "    \"dataSize\": %d,\n", DATA_SIZE);
+    fprintf(out, "    \"cwSize\": %d,\n", CW_SIZE);
+    fprintf(out, "    \"seed\": %llu,\n", (unsigned long long)config->seed);
+    fprintf(out, "    \"iterations\": %llu,\n", (unsigned long long)config->numIter);
+    fprintf(out, "    \"threads\": %u,\n", config->numThreads);
+    fprintf(out, "    \"model\": \"%s\",\n", getErrorModelName(config->model));
+    fprintf(out, "    \"flipRate\": %g,\n", config->flipRate);
+    fprintf(out, "    \"engine\": \"%s\",\n", engine);
+    if (config->bitSlice) {
+        fprintf(out, "    \"isa\": \"%s\",\n", getBitSliceISA());
+    }
+    fprintf(out, "    \"correctBurst\": %u,\n", config->correctBurst);
+    fprintf(out, "    \"shard\": {\"index\": %u, \"count\": %u},\n", config->shardIdx, config->numShard);
+    fprintf(out, "    \"confLevel\": %g,\n", config->confLevel);
+    fprintf(out, "    \"profile\": %s\n", PROFILE_ENABLED ? "true" : "false");
+    fprintf(out, "  },\n");
+
+    fprintf(out, "  \"throughput\": {\"seconds\": %.6f, \"trials\": %llu, \"chunks\": %llu, \"trialsPerSec\": %.6g, "
+        "\"tscHz\": %.6g, \"cyclesPerTrial\": %.2f},\n", seconds, (unsigned long long)total.numTrial,
+        (unsigned long long)total.numChunk, seconds > 0.0 ? total.numTrial / seconds : 0.0, tscHz,
+        total.numTrial ? (double)total.chunkCycles / total.numTrial : 0.0);
+
+    // Phases of the sampled trials, without the lap of each phase.
+    double phaseCycles[NUM_SIM_PHASES];
+    double sampledCycles = 0.0;
+    for (int phase = 0; phase < NUM_SIM_PHASES; ++phase) {
+        double netCycles = (double)total.phaseCycles[phase] - lapCycles * total.numSampled;
+
+        phaseCycles[phase] = netCycles > 0.0 ? netCycles : 0.0;
+        sampledCycles += phaseCycles[phase];
+    }
+
+    fprintf(out, "  \"phases\": {\"sampleEvery\": %d, \"sampledTrials\": %llu, \"lapCycles\": %.2f, \"list\": [",
+        SIM_PROFILE_SAMPLE, (unsigned long long)total.numSampled, lapCycles);
+    for (int phase = 0; phase < NUM_SIM_PHASES && total.numSampled > 0; ++phase) {
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"cycles\": %.0f, \"cyclesPerTrial\": %.2f, \"share\": %.4f}",
+            phase ? "," : "", getSimPhaseName((SimPhase)phase), phaseCycles[phase],
+            phaseCycles[phase] / total.numSampled, sampledCycles > 0.0 ? phaseCycles[phase] / sampledCycles : 0.0);
+    }
+    fprintf(out, "%s]},\n", total.numSampled > 0 ? "\n  " : "");
+
+    // Counters of each worker.
+    fprintf(out, "  \"threads\": [");
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        const SimProfile *profile = &profiles[threadIdx];
+
+        fprintf(out, "%s\n    {\"thread\": %u, \"trials\": %llu, \"chunks\": %llu, \"cycles\": %llu, "
+            "\"trialsPerSec\": %.6g}", threadIdx ? "," : "", threadIdx, (unsigned long long)profile->numTrial,
+            (unsigned long long)profile->numChunk, (unsigned long long)profile->chunkCycles,
+            profile->chunkCycles ? profile->numTrial * tscHz / profile->chunkCycles : 0.0);
+    }
+    fprintf(out, "\n  ],\n");
+
+    // Detection statistics of the campaign.
+    fprintf(out, "  \"results\": {\n");
+    fprintf(out, "    \"trials\": %llu,\n", (unsigned long long)result->numIter);
+    fprintf(out, "    \"errors\": %llu,\n", (unsigned long long)result->numError);
+    fprintf(out, "    \"undetected\": %llu,\n", (unsigned long long)(result->numError - result->totDetError));
+    printRatioJSON(out, "total", result->totDetError, result->numError, z, false);
+    printRatioJSON(out, "odd", result->detOddError, result->totOddError, z, false);
+    printRatioJSON(out, "double", result->detDoubleError, result->totDoubleError, z, false);
+    printRatioJSON(out, "burst32", result->detBurst32Error, result->totBurst32Error, z, !config->correctBurst);
+    if (config->correctBurst) {
+        fprintf(out, "    \"correction\": {\"maxBurst\": %u, \"corrected\": %llu, \"miscorrected\": %llu, "
+            "\"retried\": %llu}\n", config->correctBurst, (unsigned long long)result->numCorrected,
+            (unsigned long long)result->numMiscorrected,
+            (unsigned long long)(result->totDetError - result->numCorrected - result->numMiscorrected));
+    }
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+
+    if (out != stdout) {
+        fclose(out);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef __REPORT_H__
+#define __REPORT_H__
+
+#define SIM_PROFILE_SAMPLE 16       // one of this many trials is timed per phase (power of 2)
+#define SIM_PROGRESS_SEC 10.0       // default interval of progress lines in seconds
+#define SIM_LAP_ROUNDS 16           // rounds of empty trials measuring the cost of a lap
+#define SIM_LAP_TRIALS 1024         // empty trials per round
+
+/*
+ *  Phases of a trial of simulateChunk().
+ */
+typedef enum {
+    SIM_PHASE_GEN,              // error generation (genErrorVector, genFaultMask)
+    SIM_PHASE_DECODE,           // syndrome or decodeCRC, and correction lookup
+    SIM_PHASE_COUNT,            // error weight (countOne)
+    SIM_PHASE_BURST,            // burst length (getBurstLen)
+    SIM_PHASE_STATS,            // counter updates
+    NUM_SIM_PHASES
+} SimPhase;
+
+/*
+ *  Counters of a worker thread over a run.
+ *
+ *  NOTE : Trials and chunks are always counted. Cycles are counted only in builds
+ *         with SIM_PROFILE ('make PROFILE=1'), and phase cycles only for the trials
+ *         sampled by PROFILE_START(), one of SIM_PROFILE_SAMPLE.
+ */
+typedef struct {
+    uint64_t numTrial;
+    uint64_t numChunk;
+    uint64_t chunkCycles;                   // TSC cycles in chunks
+    uint64_t numSampled;                    // trials timed per phase
+    uint64_t phaseCycles[NUM_SIM_PHASES];   // TSC cycles of each phase over the sampled trials
+} __attribute__((aligned(64))) SimProfile;
+
+/*
+ *  Hot-path instrumentation. Without SIM_PROFILE every macro expands to nothing,
+ *  so the trial loop is the same as an uninstrumented build.
+ *
+ *    - PROFILE_START(lap, trialIdx)     : starts a trial, timed if it is sampled
+ *    - PROFILE_LAP(profile, phase, lap) : adds the cycles since the last lap to a phase
+ *    - PROFILE_END(profile, lap)        : ends a trial (the rest is SIM_PHASE_STATS)
+ *
+ *  NOTE : The time stamp counter is read with __rdtsc(), so <x86intrin.h> must be included.
+ *         A lap also counts the cost of its own read, which is measured by
+ *         measureProfileLap() and subtracted in the report.
+ */
+#ifdef SIM_PROFILE
+
+#if !defined(__x86_64__)
+#error "SIM_PROFILE needs the x86 time stamp counter"
+#endif
+
+#define PROFILE_ENABLED 1
+#define PROFILE_CYCLES() __rdtsc()
+#define PROFILE_START(lap, trialIdx) \
+    uint64_t lap = ((trialIdx) & (SIM_PROFILE_SAMPLE - 1)) ? 0 : __rdtsc()
+#define PROFILE_LAP(profile, phase, lap) do {                                       \
+        if (lap) {                                                                  \
+            uint64_t lapNow = __rdtsc();                                            \
+            (profile)->phaseCycles[phase] += lapNow - (lap);                        \
+            (lap) = lapNow;                                                         \
+        }                                                                           \
+    } while (0)
+#define PROFILE_END(profile, lap) do {                                              \
+        if (lap) {                                                                  \
+            (profile)->phaseCycles[SIM_PHASE_STATS] += __rdtsc() - (lap);           \
+            (profile)->numSampled++;                                                \
+        }                                                                           \
+    } while (0)
+
+#else
+
+#define PROFILE_ENABLED 0
+#define PROFILE_CYCLES() ((uint64_t)0)
+#define PROFILE_START(lap, trialIdx)
+#define PROFILE_LAP(profile, phase, lap)
+#define PROFILE_END(profile, lap)
+
+#endif
+
+const char *getSimPhaseName(SimPhase phase);
+double measureProfileLap();
+void writeSimReport(const char *path, const SimConfig *config, const SimResult *result,
+    const SimProfile *profiles, double seconds, double tscHz, double lapCycles);
+
+#endif
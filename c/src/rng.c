@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include "rng.h"
+
+/*
+ *  Function to get the next splitmix64 output.
+ */
+static uint64_t splitMix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*
+ *  Function to seed a random number stream.
+ *
+ *  NOTE : The same (seed, stream) pair always gives the same sequence,
+ *         and different streams are statistically independent.
+ */
+void seedRng(Rng *rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t mixer = seed;
+    uint64_t streamKey = splitMix64(&mixer) ^ stream;
+
+    mixer = streamKey * 0xD1B54A32D192ED03ULL + seed;
+    for (int i = 0; i < 4; ++i) {
+        rng->state[i] = splitMix64(&mixer);
+    }
+}
+
+/*
+ *  Function to convert a probability into the fixed-point form used by nextRngMask().
+ *
+ *  NOTE : Only RNG_PROB_BITS significant bits are kept, so that the number of
+ *         random words per mask stays small for any probability.
+ */
+uint64_t getRngProb(double prob)
+{
+    if (prob <= 0.0) {
+        return 0;
+    }
+    if (prob >= 1.0) {
+        return UINT64_MAX;
+    }
+
+    double scaled = ldexp(prob, 64);
+    uint64_t fixed = scaled >= 18446744073709551615.0 ? UINT64_MAX : (uint64_t)scaled;
+    int leadIdx = 63 - __builtin_clzll(fixed | 1);
+
+    if (leadIdx >= RNG_PROB_BITS) {
+        fixed &= ~(((uint64_t)1 << (leadIdx - RNG_PROB_BITS + 1)) - 1);
+    }
+
+    return fixed;
+}
@@ -0,0 +1,76 @@
+#ifndef __RNG_H__
+#define __RNG_H__
+
+/*
+ *  xoshiro256** pseudo random number generator.
+ *
+ *  Each generator is an independent stream, so it can be owned by a single thread
+ *  without locking. Streams are seeded deterministically from (seed, stream) with
+ *  splitmix64 by seedRng().
+ */
+typedef struct {
+    uint64_t state[4];
+} Rng;
+
+#define RNG_PROB_BITS 24        // significant bits kept in a fixed-point probability
+
+void seedRng(Rng *rng, uint64_t seed, uint64_t stream);
+uint64_t getRngProb(double prob);
+
+static inline uint64_t rotl64(uint64_t value, int shift)
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+/*
+ *  Function to get the next 64 random bits.
+ */
+static inline uint64_t nextRng(Rng *rng)
+{
+    uint64_t *s = rng->state;
+    uint64_t result = rotl64(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+
+    return result;
+}
+
+/*
+ *  Function to get a uniform random number in [0, 1).
+ */
+static inline double nextUniform(Rng *rng)
+{
+    return (double)(nextRng(rng) >> 11) * (1.0 / 9007199254740992.0);  // 53-bit mantissa
+}
+
+/*
+ *  Function to get 64 random bits, each of which is 1 with a probability of prob / 2^64.
+ *
+ *  NOTE : Bit-parallel Bernoulli sampling. The bits of prob are consumed from the LSB
+ *         to the MSB; a '1' ORs in a fresh random word and a '0' ANDs one in, so
+ *         each step maps the probability P of every bit to (1 + P) / 2 or P / 2.
+ *         prob = 2^63 (0.5) costs a single random word.
+ */
+static inline uint64_t nextRngMask(Rng *rng, uint64_t prob)
+{
+    uint64_t mask = 0;
+
+    if (prob == 0) {
+        return 0;
+    }
+
+    for (int bitIdx = __builtin_ctzll(prob); bitIdx < 64; ++bitIdx) {
+        uint64_t random = nextRng(rng);
+        mask = ((prob >> bitIdx) & 1) ? (mask | random) : (mask & random);
+    }
+
+    return mask;
+}
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ *  Coefficient table of the table-based RTL (CRC32_ENC.sv / CRC32_DEC.sv).
+ *
+ *  The RTL computes checksum bit i as the parity of the data bus ANDed with row i
+ *  of CRC_COEFF_TABLE. With a zero initial value, the CRC of the bus is the sum of
+ *  the CRCs of its set bits, and the CRC of a single bit that is followed by k
+ *  other bits is x^(k + CRC width) mod P. The table is thus filled column by
+ *  column from the last bit of the bus, multiplying the remainder by x each time,
+ *  instead of running a CRC over the whole bus for each bit (gen_table.py).
+ *
+ *  NOTE : As in gen_table.py, bit i of the checksum is the coefficient of
+ *         x^(CRC width - 1 - i), and the MSB of the bus enters first.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "rtltable.h"
+
+#define HEX_GROUP 4             // hex digits between '_' (16 bits, as gen_table.py)
+
+static const char *rtlModuleName[2] = { "CRC32_ENC.sv", "CRC32_DEC.sv" };
+
+/*
+ *  Function to get RTL coefficient table settings from program input arguments.
+ */
+void getRTLTableConfig(int argc, char *argv[], RTLTableConfig *config)
+{
+    config->dataWidth = RTL_DATA_WIDTH;
+    config->crcWidth = RTL_CRC_WIDTH;
+    config->poly = RTL_POLY;
+    config->reflect = false;
+
+    for (int argIdx = 3; argIdx < argc; ++argIdx) {
+        if (strcmp(argv[argIdx], "--reflect") == 0) {
+            config->reflect = true;
+        }
+        else if (strcmp(argv[argIdx], "--width") == 0) {
+            config->dataWidth = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--crc-width") == 0) {
+            config->crcWidth = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--poly") == 0) {
+            config->poly = (uint64_t)strtoull(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else {
+            exitUnknownOption(argv, argIdx);
+        }
+    }
+
+    if (config->dataWidth == 0 || config->dataWidth > MAX_RTL_DATA_WIDTH) {
+        printf("Data width must be 1 to %d bits\n", MAX_RTL_DATA_WIDTH);
+        exit(EXIT_FAILURE);
+    }
+    if (config->crcWidth == 0 || config->crcWidth > MAX_RTL_CRC_WIDTH) {
+        printf("CRC width must be 1 to %d bits\n", MAX_RTL_CRC_WIDTH);
+        exit(EXIT_FAILURE);
+    }
+    if (config->crcWidth < 64 && (config->poly >> config->crcWidth) != 0) {
+        printf("Polynomial 0x%llX does not fit in %u bits\n", (unsigned long long)config->poly, config->crcWidth);
+        exit(EXIT_FAILURE);
+    }
+    if (config->reflect && config->dataWidth % BYTE != 0) {
+        printf("Data width must be a multiple of %d bits with --reflect\n", BYTE);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ *  Function to get the bus bit of the k-th bit to enter the CRC.
+ */
+static inline unsigned int getBusBit(const RTLTableConfig *config, unsigned int order)
+{
+    if (config->reflect) {
+        unsigned int byteIdx = order / BYTE;
+
+        return config->dataWidth - BYTE * (byteIdx + 1) + order % BYTE;
+    }
+
+    return config->dataWidth - 1 - order;
+}
+
+/*
+ *  Function to generate the coefficient table.
+ *  Row i (checksum bit i) is stored in table[i * numWord ..], bus bit j in bit j % 64 of word j / 64.
+ */
+void genRTLTable(const RTLTableConfig *config, uint64_t *table)
+{
+    unsigned int numWord = (config->dataWidth + 63) / 64;
+    uint64_t topBit = (uint64_t)1 << (config->crcWidth - 1);
+    uint64_t mask = (topBit << 1) - 1;  // wraps to all ones for 64 bits
+    uint64_t remainder = 1;  // x^0
+
+    memset(table, 0, config->crcWidth * numWord * sizeof(uint64_t));
+
+    // x^N mod P for the last bit of the bus
+    for (unsigned int i = 0; i < config->crcWidth; ++i) {
+        remainder = (remainder & topBit) ? ((remainder << 1) & mask) ^ config->poly : (remainder << 1) & mask;
+    }
+
+    for (unsigned int order = config->dataWidth; order-- > 0; ) {
+        unsigned int busBit = getBusBit(config, order);
+
+        for (unsigned int row = 0; row < config->crcWidth; ++row) {
+            // Row i holds x^(N-1-i), or x^i of a reflected checksum.
+            unsigned int degree = config->reflect ? row : config->crcWidth - 1 - row;
+
+            table[row * numWord + busBit / 64] |= ((remainder >> degree) & 1) << (busBit % 64);
+        }
+
+        remainder = (remainder & topBit) ? ((remainder << 1) & mask) ^ config->poly : (remainder << 1) & mask;
+    }
+}
+
+/*
+ *  Function to print a row of the table as a SystemVerilog literal.
+ *  Digits are grouped from the LSB, so the groups match gen_table.py when the width is a multiple of 16.
+ */
+static void printRTLRow(const RTLTableConfig *config, const uint64_t *row)
+{
+    unsigned int numDigit = (config->dataWidth + 3) / 4;
+
+    printf("        %u'h", config->dataWidth);
+    for (unsigned int digit = numDigit; digit-- > 0; ) {
+        unsigned int bitIdx = 4 * digit;
+
+        printf("%X", (unsigned int)(row[bitIdx / 64] >> (bitIdx % 64)) & 0xF);
+        if (digit % HEX_GROUP == 0 && digit != 0) {
+            printf("_");
+        }
+    }
+}
+
+/*
+ *  Function to print the coefficient table as localparam blocks for the encoder and the decoder.
+ */
+void printRTLTable(const RTLTableConfig *config)
+{
+    unsigned int numWord = (config->dataWidth + 63) / 64;
+    uint64_t *table = (uint64_t *)malloc(config->crcWidth * numWord * sizeof(uint64_t));
+
+    if (table == NULL) {
+        printf("Unable to allocate the coefficient table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    genRTLTable(config, table);
+
+    printf("// CRC coefficient table : width %u, polynomial 0x%0*llX, %s, %u data bits\n", config->crcWidth,
+        (config->crcWidth + 3) / 4, (unsigned long long)config->poly, config->reflect ? "reflected" : "MSB-first",
+        config->dataWidth);
+
+    for (int moduleIdx = 0; moduleIdx < 2; ++moduleIdx) {
+        printf("\n// %s\n", rtlModuleName[moduleIdx]);
+        printf("    parameter   DATA_WIDTH              = %u,\n", config->dataWidth);
+        printf("    parameter   CRC_WIDTH               = %u\n", config->crcWidth);
+        printf("\n");
+        printf("    localparam [DATA_WIDTH-1:0] CRC_COEFF_TABLE[CRC_WIDTH-1:0] = '{\n");
+
+        // The first element of the array literal is the highest row.
+        for (unsigned int row = config->crcWidth; row-- > 0; ) {
+            printRTLRow(config, &table[row * numWord]);
+            printf("%s\n", row ? "," : "};");
+        }
+    }
+
+    free(table);
+}
@@ -0,0 +1,24 @@
+#ifndef __RTLTABLE_H__
+#define __RTLTABLE_H__
+
+#define RTL_POLY 0x814141AB             // polynomial of CRC32_GEN.sv and gen_table.py
+#define RTL_DATA_WIDTH 512              // default data width of the table-based RTL
+#define RTL_CRC_WIDTH 32                // default checksum width of the table-based RTL
+#define MAX_RTL_DATA_WIDTH 65536        // limit of --width
+#define MAX_RTL_CRC_WIDTH 64            // limit of --crc-width
+
+/*
+ *  RTL coefficient table settings given by program input arguments.
+ */
+typedef struct {
+    unsigned int dataWidth;     // data bits of the bus                                 (--width W)
+    unsigned int crcWidth;      // checksum bits                                        (--crc-width N)
+    uint64_t poly;              // generator polynomial without the highest "1"         (--poly P)
+    bool reflect;               // bytes enter LSB first, and the checksum is reflected (--reflect)
+} RTLTableConfig;
+
+void getRTLTableConfig(int argc, char *argv[], RTLTableConfig *config);
+void genRTLTable(const RTLTableConfig *config, uint64_t *table);
+void printRTLTable(const RTLTableConfig *config);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __SAIT_CRC_H__
+#define __SAIT_CRC_H__
+
+/*
+ *  Public header of the CRC library (libsait_crc).
+ *
+ *  The library holds the spec catalog of crcspec.c and the context API of crcctx.c.
+ *  It has no mutable state: a context holds a spec and its slicing-by-16 tables, is
+ *  filled once by initCRCContext() and only read afterwards, so one context can be
+ *  shared by any number of threads. No function allocates memory or exits: the
+ *  context and the data and codeword buffers are all provided by the caller.
+ *
+ *  A codeword is the data followed by its checksum, stored MSB-first as encodeCRC() does.
+ *
+ *  NOTE : This is the only header an application needs, so unlike the internal
+ *         headers it includes the standard headers it uses. Only the functions
+ *         marked SAIT_CRC_API are exported by the shared library.
+ *         If refIn, the tables and the register are in reflected (LSB-first) order.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SAIT_CRC_API __attribute__((visibility("default")))
+
+#define CRC_CONTEXT_SLICES 16       // tables of a context (slicing-by-16)
+#define CRC_CONTEXT_TABLE 256       // entries of a table
+
+/*
+ *  Parameters of a spec (Rocksoft model), with its generated checksum function.
+ */
+typedef struct {
+    const char *name;
+    unsigned int width;
+    uint64_t poly;
+    uint64_t init;
+    bool refIn;
+    bool refOut;
+    uint64_t xorOut;
+    uint64_t check;             // checksum of "123456789", 0 if not in the catalog
+    uint64_t (*calc)(const uint8_t *data, size_t byteLen);
+} CRCSpec;
+
+/*
+ *  CRC context of a 32-bit spec.
+ */
+typedef struct {
+    CRCSpec spec;                                               // spec of the context (width 32)
+    uint32_t init;                                              // initial register, reflected if refIn
+    uint32_t table[CRC_CONTEXT_SLICES][CRC_CONTEXT_TABLE];      // table[k][b] : register of byte 'b' followed by 'k' zero bytes
+} CRCContext;
+
+SAIT_CRC_API const CRCSpec *getCRCSpec(const char *name);
+SAIT_CRC_API uint64_t calcCRCSpecBitwise(const CRCSpec *spec, const uint8_t *data, size_t byteLen);
+SAIT_CRC_API bool initCRCContext(CRCContext *ctx, const CRCSpec *spec);
+SAIT_CRC_API uint32_t updateCRCWithContext(const CRCContext *ctx, uint32_t crc, const uint8_t *data, size_t byteLen);
+SAIT_CRC_API uint32_t finalizeCRCWithContext(const CRCContext *ctx, uint32_t crc);
+SAIT_CRC_API uint32_t calcCRCWithContext(const CRCContext *ctx, const uint8_t *data, size_t byteLen);
+SAIT_CRC_API void encodeCRCWithContext(const CRCContext *ctx, const uint8_t *data, size_t dataLen, uint8_t *codeword);
+SAIT_CRC_API bool checkCRCWithContext(const CRCContext *ctx, const uint8_t *codeword, size_t byteLen);
+
+#endif
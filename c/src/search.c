@@ -0,0 +1,498 @@
+/*
+ *  Parallel search and ranking of CRC32 polynomials.
+ *
+ *  Each candidate is evaluated at the real codeword length (DATA_SIZE data bytes
+ *  + 32-bit checksum) with its own syndrome table:
+ *
+ *    1) Hamming distance : weights 1..SEARCH_MAX_WEIGHT are checked in order with
+ *                          meet-in-the-middle lookups of single/pair syndromes.
+ *                          The search stops at the first weight with an undetected
+ *                          pattern, and candidates below --min-hd are rejected
+ *                          right there without further evaluation.
+ *    2) Burst coverage   : the longest L such that every window of L consecutive
+ *                          bits has linearly independent syndromes, i.e. all
+ *                          bursts up to L bits are detected.
+ *    3) DRAM coverage    : undetected fraction of all error patterns confined to a
+ *                          DQ pin, adjacent pins, a beat, or an x4/x8 device,
+ *                          mapped through serialize(). A region of m bits whose
+ *                          syndromes have rank r misses 2^(m-r) - 1 of its
+ *                          2^m - 1 error patterns.
+ *
+ *  Candidates are spread across worker threads, and the results are ranked by
+ *  Hamming distance, number of minimum-weight undetected patterns, burst coverage
+ *  and DRAM coverage.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "rng.h"
+#include "errmodel.h"
+#include "search.h"
+#include "rtltable.h"
+
+#define SINGLE_HASH_BITS 11             // hash size for CW_BITS single syndromes
+#define PAIR_HASH_BITS 19               // hash size for CW_BITS^2/2 pair syndromes
+#define MAX_CANDIDATE (1 << 26)         // limit on the number of candidates
+#define MAX_REGION_BITS (DQ_SIZE * GROUP_SIZE * BL)
+
+/*
+ *  Per-worker buffers.
+ */
+typedef struct {
+    SyndromeTable table;
+    uint32_t hashKey[1 << PAIR_HASH_BITS];
+    uint32_t hashCount[1 << PAIR_HASH_BITS];
+} SearchScratch;
+
+typedef struct {
+    const SearchConfig *config;
+    PolyScore *scores;
+    size_t nextPoly;            // shared work counter (atomic)
+} SearchContext;
+
+static const char *dramClassName[NUM_DRAM_CLASS] = { "Pin", "AdjPin", "Beat", "x4", "x8" };
+static const ErrorModel dramModel[NUM_DRAM_CLASS] = { ERROR_PIN, ERROR_ADJ_PIN, ERROR_BEAT, ERROR_X4, ERROR_X8 };
+
+/*
+ *  Function to append a candidate polynomial to the configuration.
+ */
+static void addCandidate(SearchConfig *config, size_t *capacity, uint32_t poly)
+{
+    if (config->numPoly == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 64;
+        if (*capacity > MAX_CANDIDATE) {
+            printf("Too many candidates (limit : %d)\n", MAX_CANDIDATE);
+            exit(EXIT_FAILURE);
+        }
+
+        config->polys = (uint32_t *)realloc(config->polys, *capacity * sizeof(uint32_t));
+        if (config->polys == NULL) {
+            printf("Unable to allocate candidate list\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    config->polys[config->numPoly++] = poly;
+}
+
+/*
+ *  Function to get search settings from program input arguments.
+ */
+void getSearchConfig(int argc, char *argv[], SearchConfig *config)
+{
+    size_t capacity = 0;
+
+    config->polys = NULL;
+    config->numPoly = 0;
+    config->minHD = SEARCH_MIN_HD;
+    config->numTop = SEARCH_TOP;
+    config->numThreads = 1;
+
+    for (int argIdx = 2; argIdx < argc - 1; ++argIdx) {
+        if (strcmp(argv[argIdx], "--poly") == 0) {
+            // Comma-separated list of polynomials.
+            char *cursor = argv[++argIdx];
+            while (*cursor != '\0') {
+                addCandidate(config, &capacity, (uint32_t)strtoul(cursor, &cursor, 0));
+                if (*cursor == ',') {
+                    ++cursor;
+                }
+                else if (*cursor != '\0') {
+                    printf("Invalid polynomial list: %s\n", argv[argIdx]);
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        else if (strcmp(argv[argIdx], "--range") == 0) {
+            // Inclusive range 'first:last[:step]'.
+            char *cursor = argv[++argIdx];
+            uint64_t first = strtoul(cursor, &cursor, 0);
+            uint64_t last = (*cursor == ':') ? strtoul(cursor + 1, &cursor, 0) : first;
+            uint64_t step = (*cursor == ':') ? strtoul(cursor + 1, &cursor, 0) : 1;
+
+            for (uint64_t poly = first; poly <= last && step > 0; poly += step) {
+                addCandidate(config, &capacity, (uint32_t)poly);
+            }
+        }
+        else if (strcmp(argv[argIdx], "--min-hd") == 0) {
+            config->minHD = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--top") == 0) {
+            config->numTop = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+    }
+
+    // Compare the C and the RTL polynomials by default.
+    if (config->numPoly == 0) {
+        addCandidate(config, &capacity, GEN_POLY);
+        addCandidate(config, &capacity, RTL_POLY);
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+}
+
+static inline uint32_t hashSlot(uint32_t key, unsigned int hashBits)
+{
+    return (key * 0x9E3779B1u) >> (32 - hashBits);
+}
+
+/*
+ *  Function to insert a syndrome into the hash table.
+ *  Returns how many times the syndrome was inserted before.
+ */
+static inline uint32_t insertSyndrome(SearchScratch *scratch, unsigned int hashBits, uint32_t key)
+{
+    uint32_t mask = ((uint32_t)1 << hashBits) - 1;
+    uint32_t slot = hashSlot(key, hashBits);
+
+    while (scratch->hashCount[slot] != 0 && scratch->hashKey[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+
+    scratch->hashKey[slot] = key;
+    return scratch->hashCount[slot]++;
+}
+
+/*
+ *  Function to find how many times a syndrome was inserted into the hash table.
+ */
+static inline uint32_t findSyndrome(const SearchScratch *scratch, unsigned int hashBits, uint32_t key)
+{
+    uint32_t mask = ((uint32_t)1 << hashBits) - 1;
+    uint32_t slot = hashSlot(key, hashBits);
+
+    while (scratch->hashCount[slot] != 0) {
+        if (scratch->hashKey[slot] == key) {
+            return scratch->hashCount[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return 0;
+}
+
+static void clearHash(SearchScratch *scratch, unsigned int hashBits)
+{
+    memset(scratch->hashCount, 0, ((size_t)1 << hashBits) * sizeof(uint32_t));
+}
+
+/*
+ *  Function to find the minimum Hamming distance of the code.
+ *
+ *  NOTE : Weight w is checked only after all lower weights are known to be detected,
+ *         so every match below is a genuine weight-w codeword:
+ *           - weight 3 : s_i ^ s_j == s_k      (counted 3 times per codeword)
+ *           - weight 4 : s_i ^ s_j == s_k ^ s_l (counted 3 times per codeword)
+ *           - weight 5 : s_i ^ s_j ^ s_k == s_l ^ s_m (counted 10 times per codeword)
+ *         Below minHD, the search stops at the first match without counting.
+ */
+static unsigned int findDistance(SearchScratch *scratch, unsigned int minHD, uint64_t *numMinWeight)
+{
+    const uint32_t *syn = scratch->table.bitSyndrome;
+    uint64_t hits = 0;
+
+    *numMinWeight = 0;
+
+    // Weight 1 : zero syndrome.
+    for (unsigned int i = 0; i < CW_BITS; ++i) {
+        hits += (syn[i] == 0);
+    }
+    if (hits > 0) {
+        *numMinWeight = hits;
+        return 1;
+    }
+
+    // Weight 2 : equal syndromes.
+    clearHash(scratch, SINGLE_HASH_BITS);
+    for (unsigned int i = 0; i < CW_BITS; ++i) {
+        hits += insertSyndrome(scratch, SINGLE_HASH_BITS, syn[i]);
+        if (hits > 0 && minHD > 2) {
+            return 2;
+        }
+    }
+    if (hits > 0) {
+        *numMinWeight = hits;
+        return 2;
+    }
+
+    // Weight 3 : a pair matches a single.
+    for (unsigned int i = 0; i < CW_BITS; ++i) {
+        for (unsigned int j = i + 1; j < CW_BITS; ++j) {
+            hits += findSyndrome(scratch, SINGLE_HASH_BITS, syn[i] ^ syn[j]);
+        }
+        if (hits > 0 && minHD > 3) {
+            return 3;
+        }
+    }
+    if (hits > 0) {
+        *numMinWeight = hits / 3;
+        return 3;
+    }
+
+    // Weight 4 : two pairs match.
+    clearHash(scratch, PAIR_HASH_BITS);
+    for (unsigned int i = 0; i < CW_BITS; ++i) {
+        for (unsigned int j = i + 1; j < CW_BITS; ++j) {
+            hits += insertSyndrome(scratch, PAIR_HASH_BITS, syn[i] ^ syn[j]);
+        }
+        if (hits > 0 && minHD > 4) {
+            return 4;
+        }
+    }
+    if (hits > 0) {
+        *numMinWeight = hits / 3;
+        return 4;
+    }
+
+    // Weight 5 : a triple matches a pair.
+    for (unsigned int i = 0; i < CW_BITS; ++i) {
+        for (unsigned int j = i + 1; j < CW_BITS; ++j) {
+            uint32_t prefix = syn[i] ^ syn[j];
+
+            for (unsigned int k = j + 1; k < CW_BITS; ++k) {
+                hits += findSyndrome(scratch, PAIR_HASH_BITS, prefix ^ syn[k]);
+            }
+        }
+        if (hits > 0 && minHD > 5) {
+            return 5;
+        }
+    }
+    if (hits > 0) {
+        *numMinWeight = hits / 10;
+        return 5;
+    }
+
+    return SEARCH_MAX_WEIGHT + 1;
+}
+
+/*
+ *  Function to get the rank of the syndromes at the given positions over GF(2).
+ */
+unsigned int getSyndromeRank(const uint32_t *bitSyndrome, const unsigned int *positions, unsigned int numPos)
+{
+    uint32_t basis[CRC] = {0};  // basis vector indexed by its leading bit
+    unsigned int rank = 0;
+
+    for (unsigned int i = 0; i < numPos && rank < CRC; ++i) {
+        uint32_t vector = bitSyndrome[positions[i]];
+
+        while (vector) {
+            unsigned int leadBit = 31 - __builtin_clz(vector);
+
+            if (basis[leadBit] == 0) {
+                basis[leadBit] = vector;
+                ++rank;
+                break;
+            }
+            vector ^= basis[leadBit];
+        }
+    }
+
+    return rank;
+}
+
+/*
+ *  Function to get the fraction of undetected errors among all non-zero
+ *  error patterns confined to the given positions.
+ */
+double getRegionUndetected(const uint32_t *bitSyndrome, const unsigned int *positions, unsigned int numPos)
+{
+    unsigned int rank = getSyndromeRank(bitSyndrome, positions, numPos);
+
+    return (ldexp(1.0, numPos - rank) - 1.0) / (ldexp(1.0, numPos) - 1.0);
+}
+
+/*
+ *  Function to get the longest L such that all bursts up to L bits are detected.
+ */
+static unsigned int getBurstCoverage(const uint32_t *bitSyndrome)
+{
+    unsigned int positions[CRC];
+
+    for (unsigned int burstLen = 1; burstLen <= CRC; ++burstLen) {
+        for (unsigned int startPos = 0; startPos + burstLen <= CW_BITS; ++startPos) {
+            for (unsigned int i = 0; i < burstLen; ++i) {
+                positions[i] = startPos + i;
+            }
+
+            if (getSyndromeRank(bitSyndrome, positions, burstLen) < burstLen) {
+                return burstLen - 1;
+            }
+        }
+    }
+
+    return CRC;  // a 33-bit burst equal to the polynomial is never detected
+}
+
+/*
+ *  Function to evaluate a candidate polynomial.
+ */
+static void evalPolynomial(uint32_t poly, unsigned int minHD, SearchScratch *scratch, PolyScore *score)
+{
+    unsigned int positions[MAX_REGION_BITS];
+
+    memset(score, 0, sizeof(PolyScore));
+    score->poly = poly;
+
+    genSyndromeTable(&scratch->table, poly);
+
+    score->distance = findDistance(scratch, minHD, &score->numMinWeight);
+    if (score->distance < minHD) {
+        score->rejected = true;  // early rejection
+        return;
+    }
+
+    score->burstLen = getBurstCoverage(scratch->table.bitSyndrome);
+
+    for (int dramClass = 0; dramClass < NUM_DRAM_CLASS; ++dramClass) {
+        unsigned int numRegion = getNumFaultRegion(dramModel[dramClass]);
+        double undetected = 0.0;
+
+        for (unsigned int regionIdx = 0; regionIdx < numRegion; ++regionIdx) {
+            unsigned int numPos = getFaultRegion(dramModel[dramClass], regionIdx, positions);
+            undetected += getRegionUndetected(scratch->table.bitSyndrome, positions, numPos);
+        }
+
+        score->dramUndet[dramClass] = undetected / numRegion;
+    }
+}
+
+/*
+ *  Worker thread function. Candidates are taken from the shared counter.
+ */
+static void *searchWorker(void *arg)
+{
+    SearchContext *context = (SearchContext *)arg;
+    SearchScratch *scratch = (SearchScratch *)malloc(sizeof(SearchScratch));
+
+    if (scratch == NULL) {
+        printf("Unable to allocate search buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while (true) {
+        size_t polyIdx = __atomic_fetch_add(&context->nextPoly, 1, __ATOMIC_RELAXED);
+        if (polyIdx >= context->config->numPoly) {
+            break;
+        }
+
+        evalPolynomial(context->config->polys[polyIdx], context->config->minHD, scratch, &context->scores[polyIdx]);
+    }
+
+    free(scratch);
+    return NULL;
+}
+
+/*
+ *  Function to compare candidates for ranking (better first).
+ */
+static int comparePolyScore(const void *lhs, const void *rhs)
+{
+    const PolyScore *a = (const PolyScore *)lhs;
+    const PolyScore *b = (const PolyScore *)rhs;
+
+    if (a->rejected != b->rejected) {
+        return a->rejected ? 1 : -1;
+    }
+    if (a->distance != b->distance) {
+        return a->distance > b->distance ? -1 : 1;
+    }
+    if (a->numMinWeight != b->numMinWeight) {
+        return a->numMinWeight < b->numMinWeight ? -1 : 1;
+    }
+    if (a->burstLen != b->burstLen) {
+        return a->burstLen > b->burstLen ? -1 : 1;
+    }
+
+    double dramA = 0.0;
+    double dramB = 0.0;
+    for (int dramClass = 0; dramClass < NUM_DRAM_CLASS; ++dramClass) {
+        dramA += a->dramUndet[dramClass];
+        dramB += b->dramUndet[dramClass];
+    }
+    if (dramA != dramB) {
+        return dramA < dramB ? -1 : 1;
+    }
+
+    return (a->poly > b->poly) - (a->poly < b->poly);
+}
+
+/*
+ *  Function to search and rank candidate polynomials.
+ */
+void search(const SearchConfig *config)
+{
+    PolyScore *scores = (PolyScore *)calloc(config->numPoly, sizeof(PolyScore));
+    pthread_t *threads = (pthread_t *)calloc(config->numThreads, sizeof(pthread_t));
+    SearchContext context = { config, scores, 0 };
+
+    if (scores == NULL || threads == NULL) {
+        printf("Unable to allocate %zu candidates\n", config->numPoly);
+        exit(EXIT_FAILURE);
+    }
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        if (pthread_create(&threads[threadIdx], NULL, searchWorker, &context) != 0) {
+            printf("Unable to create thread %u\n", threadIdx);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        pthread_join(threads[threadIdx], NULL);
+    }
+
+    qsort(scores, config->numPoly, sizeof(PolyScore), comparePolyScore);
+
+    size_t numRejected = 0;
+    for (size_t polyIdx = 0; polyIdx < config->numPoly; ++polyIdx) {
+        numRejected += scores[polyIdx].rejected;
+    }
+
+    // Print the ranked report.
+    printf("##### Polynomial Search Result #####\n");
+    printf("Codeword : %d bits (%d-bit data + %d-bit CRC), Candidates : %zu, Threads : %u\n",
+        CW_BITS, DATA_SIZE * BYTE, CRC, config->numPoly, config->numThreads);
+    printf("%-5s %-11s %4s %12s %6s", "Rank", "Polynomial", "HD", "A_HD", "Burst");
+    for (int dramClass = 0; dramClass < NUM_DRAM_CLASS; ++dramClass) {
+        printf(" %10s", dramClassName[dramClass]);
+    }
+    printf("\n");
+
+    for (size_t polyIdx = 0; polyIdx < config->numPoly - numRejected && polyIdx < config->numTop; ++polyIdx) {
+        const PolyScore *score = &scores[polyIdx];
+
+        printf("%-5zu 0x%08X  ", polyIdx + 1, score->poly);
+        if (score->distance > SEARCH_MAX_WEIGHT) {
+            printf(" >%d %12s", SEARCH_MAX_WEIGHT, "-");
+        }
+        else {
+            printf("%4u %12llu", score->distance, (unsigned long long)score->numMinWeight);
+        }
+        printf(" %6u", score->burstLen);
+        for (int dramClass = 0; dramClass < NUM_DRAM_CLASS; ++dramClass) {
+            printf(" %10.3e", score->dramUndet[dramClass]);
+        }
+        printf("\n");
+    }
+
+    printf("(HD : Hamming distance, A_HD : undetected patterns of weight HD, Burst : all bursts <= L detected,\n");
+    printf(" Pin/AdjPin/Beat/x4/x8 : undetected fraction of errors confined to the DRAM region)\n");
+    if (numRejected > 0) {
+        printf("Rejected : %zu candidates with HD < %u\n", numRejected, config->minHD);
+    }
+
+    free(threads);
+    free(scores);
+}
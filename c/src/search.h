@@ -0,0 +1,49 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#define SEARCH_MAX_WEIGHT 5     // Hamming distance is determined up to this weight
+#define SEARCH_MIN_HD 4         // default minimum Hamming distance to accept a candidate
+#define SEARCH_TOP 20           // default number of candidates in the report
+#define NUM_DRAM_CLASS 5        // number of DRAM fault classes
+
+/*
+ *  DRAM fault classes evaluated by the search.
+ *  Each class is a set of regions of the serialized data (see serialize()).
+ */
+typedef enum {
+    DRAM_PIN,                   // one DQ across all beats
+    DRAM_ADJ_PIN,               // two adjacent DQs across all beats
+    DRAM_BEAT,                  // all DQs in one beat
+    DRAM_X4,                    // one x4 device across all beats
+    DRAM_X8                     // one x8 device across all beats
+} DRAMClass;
+
+/*
+ *  Polynomial search settings given by program input arguments.
+ */
+typedef struct {
+    uint32_t *polys;            // candidate polynomials (--poly P1,P2,... / --range A:B[:S])
+    size_t numPoly;
+    unsigned int minHD;         // reject candidates below this distance (--min-hd D)
+    unsigned int numTop;        // number of candidates in the report    (--top N)
+    unsigned int numThreads;    // number of worker threads              (--threads N)
+} SearchConfig;
+
+/*
+ *  Evaluation result of a candidate polynomial.
+ */
+typedef struct {
+    uint32_t poly;
+    bool rejected;              // Hamming distance below minHD
+    unsigned int distance;      // minimum Hamming distance (SEARCH_MAX_WEIGHT + 1 if not found)
+    uint64_t numMinWeight;      // number of undetected patterns of weight 'distance'
+    unsigned int burstLen;      // all bursts up to this length are detected
+    double dramUndet[NUM_DRAM_CLASS];  // undetected fraction of each DRAM fault class
+} PolyScore;
+
+void getSearchConfig(int argc, char *argv[], SearchConfig *config);
+void search(const SearchConfig *config);
+unsigned int getSyndromeRank(const uint32_t *bitSyndrome, const unsigned int *positions, unsigned int numPos);
+double getRegionUndetected(const uint32_t *bitSyndrome, const unsigned int *positions, unsigned int numPos);
+
+#endif
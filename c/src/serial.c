@@ -0,0 +1,427 @@
+/*
+ *  Generalized serializer for arbitrary DQ / burst length / group layouts.
+ *
+ *  serialize() in crc32.c is fixed to two data streams of 8 ticks. This serializer
+ *  takes the DQ count, the burst length, the group size, the order of beats
+ *  (beatOrder) and the bit order (SerialOrder) from a SerialLayout:
+ *
+ *    1) Beats are gathered in slot order.
+ *    2) The DQ x beat reshuffle is a byte-matrix transpose of the beat words
+ *       (4 x 4 bytes per SSSE3 shuffle), which gives the beat-major layout.
+ *    3) The pin-major layout transposes each 8-DQ lane once more as a bit matrix
+ *       (16 beats x 8 DQs per round of SSE2 movemasks).
+ *
+ *  deserializeLayout() reverses the steps, and checkSerialLayout() validates a
+ *  layout bit by bit and against serialize() for the default configuration.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "rng.h"
+#include "serial.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_X86_SHUFFLE 1
+#else
+#define HAVE_X86_SHUFFLE 0
+#endif
+
+#define NUM_CHECK 64            // random bursts of the self-check
+
+static int useShuffle = -1;     // SSSE3 availability (-1 : not checked yet)
+
+/*
+ *  Function to parse a layout from program input arguments.
+ *  ('--dq N', '--bl N', '--group N', '--order beat|pin', '--map B0,B1,...')
+ */
+void getSerialLayout(int argc, char *argv[], SerialLayout *layout)
+{
+    unsigned int numDQ = DQ_SIZE;
+    unsigned int burstLen = BL;
+    unsigned int groupLen = GROUP_SIZE;
+    SerialOrder order = SERIAL_BEAT_MAJOR;
+    uint8_t beatOrder[MAX_SERIAL_BEATS];
+    unsigned int numMap = 0;
+
+    for (int argIdx = 2; argIdx < argc - 1; ++argIdx) {
+        if (strcmp(argv[argIdx], "--dq") == 0) {
+            numDQ = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--bl") == 0) {
+            burstLen = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--group") == 0) {
+            groupLen = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--order") == 0) {
+            const char *name = argv[++argIdx];
+
+            if (strcmp(name, "beat") == 0) {
+                order = SERIAL_BEAT_MAJOR;
+            }
+            else if (strcmp(name, "pin") == 0) {
+                order = SERIAL_PIN_MAJOR;
+            }
+            else {
+                printf("Unknown bit order: %s\n", name);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[argIdx], "--map") == 0) {
+            // Comma-separated beat of each slot.
+            char *cursor = argv[++argIdx];
+            while (*cursor != '\0' && numMap < MAX_SERIAL_BEATS) {
+                beatOrder[numMap++] = (uint8_t)strtoul(cursor, &cursor, 0);
+                if (*cursor == ',') {
+                    ++cursor;
+                }
+            }
+        }
+    }
+
+    if (numMap > 0 && numMap != groupLen * burstLen) {
+        printf("Beat map has %u entries, but the layout has %u beats\n", numMap, groupLen * burstLen);
+        exit(EXIT_FAILURE);
+    }
+
+    initSerialLayout(layout, numDQ, burstLen, groupLen, order, numMap > 0 ? beatOrder : NULL);
+}
+
+/*
+ *  Function to initialize a layout.
+ *
+ *  NOTE : Without beatOrder, beats follow serialize(): the first and the second halves
+ *         of the ticks are interleaved, and data streams alternate within each pair.
+ */
+void initSerialLayout(SerialLayout *layout, unsigned int numDQ, unsigned int burstLen, unsigned int groupLen,
+    SerialOrder order, const uint8_t *beatOrder)
+{
+    unsigned int numBeats = groupLen * burstLen;
+
+    if (numDQ == 0 || numDQ % BYTE != 0 || numDQ > MAX_SERIAL_DQ) {
+        printf("DQ count must be a multiple of 8 up to %d\n", MAX_SERIAL_DQ);
+        exit(EXIT_FAILURE);
+    }
+    if (numBeats == 0 || numBeats > MAX_SERIAL_BEATS) {
+        printf("Group size x burst length must be 1..%d\n", MAX_SERIAL_BEATS);
+        exit(EXIT_FAILURE);
+    }
+    if (order == SERIAL_PIN_MAJOR && numBeats % BYTE != 0) {
+        printf("Pin-major order needs a multiple of 8 beats\n");
+        exit(EXIT_FAILURE);
+    }
+
+    layout->numDQ = numDQ;
+    layout->burstLen = burstLen;
+    layout->groupLen = groupLen;
+    layout->numBeats = numBeats;
+    layout->order = order;
+
+    memset(layout->beatSlot, 0xFF, sizeof(layout->beatSlot));
+    for (unsigned int streamIdx = 0; streamIdx < groupLen; ++streamIdx) {
+        for (unsigned int tick = 0; tick < burstLen; ++tick) {
+            unsigned int beat = streamIdx * burstLen + tick;
+            unsigned int slot = beat;
+
+            if (burstLen % 2 == 0) {
+                unsigned int half = burstLen / 2;
+                slot = ((tick % half) * groupLen + streamIdx) * 2 + tick / half;
+            }
+
+            layout->beatOrder[slot] = (uint8_t)beat;
+        }
+    }
+
+    if (beatOrder != NULL) {
+        memcpy(layout->beatOrder, beatOrder, numBeats);
+    }
+
+    for (unsigned int slot = 0; slot < numBeats; ++slot) {
+        unsigned int beat = layout->beatOrder[slot];
+
+        if (beat >= numBeats || layout->beatSlot[beat] != 0xFF) {
+            printf("Beat map is not a permutation of 0..%u\n", numBeats - 1);
+            exit(EXIT_FAILURE);
+        }
+        layout->beatSlot[beat] = (uint8_t)slot;
+    }
+
+    if (useShuffle < 0) {
+#if HAVE_X86_SHUFFLE
+        __builtin_cpu_init();
+        useShuffle = __builtin_cpu_supports("ssse3");
+#else
+        useShuffle = 0;
+#endif
+    }
+}
+
+/*
+ *  Function to get the size of the serialized data in bytes.
+ */
+size_t getSerialSize(const SerialLayout *layout)
+{
+    return (size_t)layout->numDQ * layout->numBeats / BYTE;
+}
+
+/*
+ *  Function to get the bit position in the serialized data of a DQ at a tick of a data stream.
+ */
+unsigned int getLayoutBitPos(const SerialLayout *layout, unsigned int streamIdx, unsigned int tick, unsigned int dq)
+{
+    unsigned int slot = layout->beatSlot[streamIdx * layout->burstLen + tick];
+
+    if (layout->order == SERIAL_PIN_MAJOR) {
+        return dq * layout->numBeats + slot;
+    }
+
+    return ((dq / BYTE) * layout->numBeats + slot) * BYTE + dq % BYTE;
+}
+
+/*
+ *  Function to transpose an 8 x 8 bit matrix.
+ *  Row i is in[i * inStride] (MSB first), and row j of the result goes to out[j * outStride].
+ */
+static void transposeBits8(const uint8_t *in, size_t inStride, uint8_t *out, size_t outStride)
+{
+    uint64_t matrix = 0;
+    uint64_t temp;
+
+    for (int row = 0; row < BYTE; ++row) {
+        matrix = (matrix << BYTE) | in[row * inStride];
+    }
+
+    temp = (matrix ^ (matrix >> 7)) & 0x00AA00AA00AA00AAULL;
+    matrix ^= temp ^ (temp << 7);
+    temp = (matrix ^ (matrix >> 14)) & 0x0000CCCC0000CCCCULL;
+    matrix ^= temp ^ (temp << 14);
+    temp = (matrix ^ (matrix >> 28)) & 0x00000000F0F0F0F0ULL;
+    matrix ^= temp ^ (temp << 28);
+
+    for (int row = 0; row < BYTE; ++row) {
+        out[row * outStride] = (uint8_t)(matrix >> (56 - BYTE * row));
+    }
+}
+
+/*
+ *  Function to split slot words into byte rows (row 0 holds the first 8 DQs).
+ */
+static void transposeBytes(const uint32_t *slotWord, unsigned int numBeats, unsigned int numLane,
+    uint8_t *rows, size_t rowStride)
+{
+    for (unsigned int lane = 0; lane < numLane; ++lane) {
+        unsigned int shift = BYTE * (numLane - 1 - lane);
+
+        for (unsigned int slot = 0; slot < numBeats; ++slot) {
+            rows[lane * rowStride + slot] = (uint8_t)(slotWord[slot] >> shift);
+        }
+    }
+}
+
+#if HAVE_X86_SHUFFLE
+
+/*
+ *  Function to split slot words into byte rows with 4 x 4 byte transposes.
+ */
+__attribute__((target("ssse3")))
+static void transposeBytesShuffle(const uint32_t *slotWord, unsigned int numBeats, unsigned int numLane,
+    uint8_t *rows, size_t rowStride)
+{
+    // Lane k of the result holds byte (3 - k / 4) of word k % 4.
+    const __m128i mask = _mm_setr_epi8(3, 7, 11, 15, 2, 6, 10, 14, 1, 5, 9, 13, 0, 4, 8, 12);
+    unsigned int firstRow = 4 - numLane;  // rows above numDQ are empty
+    unsigned int slot = 0;
+
+    for (; slot + 4 <= numBeats; slot += 4) {
+        uint32_t block[4];
+        __m128i words = _mm_loadu_si128((const __m128i *)(slotWord + slot));
+
+        _mm_storeu_si128((__m128i *)block, _mm_shuffle_epi8(words, mask));
+        for (unsigned int row = firstRow; row < 4; ++row) {
+            memcpy(rows + (row - firstRow) * rowStride + slot, &block[row], sizeof(uint32_t));
+        }
+    }
+
+    if (slot < numBeats) {
+        transposeBytes(slotWord + slot, numBeats - slot, numLane, rows + slot, rowStride);
+    }
+}
+
+/*
+ *  Function to transpose a row of beats into DQ rows, 16 beats per round.
+ *  Byte k of the row is beat k, and DQ b of the row goes to out[b * outStride].
+ */
+__attribute__((target("ssse3")))
+static void transposeBitsShuffle(const uint8_t *row, unsigned int numBeats, uint8_t *out, size_t outStride)
+{
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    unsigned int slot = 0;
+
+    for (; slot + 16 <= numBeats; slot += 16) {
+        // Beat 0 goes to the top bit of the mask, so the mask is stored as is (MSB first).
+        __m128i bits = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(row + slot)), reverse);
+
+        for (unsigned int bit = 0; bit < BYTE; ++bit) {
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(bits);
+
+            out[bit * outStride + slot / BYTE] = (uint8_t)(mask >> BYTE);
+            out[bit * outStride + slot / BYTE + 1] = (uint8_t)mask;
+            bits = _mm_add_epi8(bits, bits);
+        }
+    }
+
+    if (slot < numBeats) {
+        transposeBits8(row + slot, 1, out + slot / BYTE, outStride);
+    }
+}
+
+#endif
+
+/*
+ *  Function to serialize a group of data streams.
+ *  dataStream holds groupLen x burstLen words, and DQ 'dq' is bit (numDQ - 1 - dq) of a word.
+ */
+void serializeLayout(const SerialLayout *layout, const uint32_t *dataStream, uint8_t *data)
+{
+    uint32_t slotWord[MAX_SERIAL_BEATS];
+    uint8_t rows[MAX_SERIAL_DQ / BYTE][MAX_SERIAL_BEATS];
+    unsigned int numBeats = layout->numBeats;
+    unsigned int numLane = layout->numDQ / BYTE;
+    bool beatMajor = (layout->order == SERIAL_BEAT_MAJOR);
+
+    for (unsigned int slot = 0; slot < numBeats; ++slot) {
+        slotWord[slot] = dataStream[layout->beatOrder[slot]];
+    }
+
+    // The beat-major layout is the byte rows themselves.
+    uint8_t *rowBase = beatMajor ? data : &rows[0][0];
+    size_t rowStride = beatMajor ? numBeats : MAX_SERIAL_BEATS;
+
+#if HAVE_X86_SHUFFLE
+    if (useShuffle) {
+        transposeBytesShuffle(slotWord, numBeats, numLane, rowBase, rowStride);
+
+        for (unsigned int lane = 0; !beatMajor && lane < numLane; ++lane) {
+            transposeBitsShuffle(rows[lane], numBeats, data + lane * numBeats, numBeats / BYTE);
+        }
+        return;
+    }
+#endif
+
+    transposeBytes(slotWord, numBeats, numLane, rowBase, rowStride);
+
+    for (unsigned int lane = 0; !beatMajor && lane < numLane; ++lane) {
+        for (unsigned int slot = 0; slot < numBeats; slot += BYTE) {
+            transposeBits8(rows[lane] + slot, 1, data + lane * numBeats + slot / BYTE, numBeats / BYTE);
+        }
+    }
+}
+
+/*
+ *  Function to deserialize data back into a group of data streams.
+ */
+void deserializeLayout(const SerialLayout *layout, const uint8_t *data, uint32_t *dataStream)
+{
+    uint8_t rows[MAX_SERIAL_DQ / BYTE][MAX_SERIAL_BEATS];
+    unsigned int numBeats = layout->numBeats;
+    unsigned int numLane = layout->numDQ / BYTE;
+
+    for (unsigned int lane = 0; lane < numLane; ++lane) {
+        if (layout->order == SERIAL_BEAT_MAJOR) {
+            memcpy(rows[lane], data + lane * numBeats, numBeats);
+        }
+        else {
+            // The bit transpose is its own inverse.
+            for (unsigned int slot = 0; slot < numBeats; slot += BYTE) {
+                transposeBits8(data + lane * numBeats + slot / BYTE, numBeats / BYTE, rows[lane] + slot, 1);
+            }
+        }
+    }
+
+    for (unsigned int slot = 0; slot < numBeats; ++slot) {
+        uint32_t word = 0;
+
+        for (unsigned int lane = 0; lane < numLane; ++lane) {
+            word = (word << BYTE) | rows[lane][slot];
+        }
+        dataStream[layout->beatOrder[slot]] = word;
+    }
+}
+
+/*
+ *  Function to check a layout.
+ *
+ *    1) Every single-bit burst lands on getLayoutBitPos().
+ *    2) Random bursts survive serialize + deserialize.
+ *    3) The default configuration matches serialize() in crc32.c.
+ */
+bool checkSerialLayout(const SerialLayout *layout)
+{
+    uint32_t dataStream[MAX_SERIAL_BEATS];
+    uint32_t restored[MAX_SERIAL_BEATS];
+    uint8_t data[MAX_SERIAL_DQ * MAX_SERIAL_BEATS / BYTE];
+    size_t serialSize = getSerialSize(layout);
+    uint32_t dqMask = (layout->numDQ == 32) ? 0xFFFFFFFF : (((uint32_t)1 << layout->numDQ) - 1);
+    Rng rng;
+
+    for (unsigned int beat = 0; beat < layout->numBeats; ++beat) {
+        for (unsigned int dq = 0; dq < layout->numDQ; ++dq) {
+            unsigned int bitPos = getLayoutBitPos(layout, beat / layout->burstLen, beat % layout->burstLen, dq);
+
+            memset(dataStream, 0, sizeof(dataStream));
+            dataStream[beat] = (uint32_t)1 << (layout->numDQ - 1 - dq);
+            serializeLayout(layout, dataStream, data);
+
+            for (size_t byteIdx = 0; byteIdx < serialSize; ++byteIdx) {
+                uint8_t expected = (byteIdx == bitPos / BYTE) ? (uint8_t)(0x80 >> (bitPos % BYTE)) : 0;
+                if (data[byteIdx] != expected) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    seedRng(&rng, 0, 0);
+    for (int checkIdx = 0; checkIdx < NUM_CHECK; ++checkIdx) {
+        for (unsigned int beat = 0; beat < layout->numBeats; ++beat) {
+            dataStream[beat] = (uint32_t)nextRng(&rng) & dqMask;
+        }
+
+        serializeLayout(layout, dataStream, data);
+        deserializeLayout(layout, data, restored);
+        if (memcmp(dataStream, restored, layout->numBeats * sizeof(uint32_t)) != 0) {
+            return false;
+        }
+    }
+
+    // Compare with serialize() if this is the layout it implements.
+    SerialLayout defaultLayout;
+    initSerialLayout(&defaultLayout, DQ_SIZE, BL, GROUP_SIZE, SERIAL_BEAT_MAJOR, NULL);
+
+    if (layout->numDQ == DQ_SIZE && layout->burstLen == BL && layout->groupLen == GROUP_SIZE
+        && layout->order == SERIAL_BEAT_MAJOR
+        && memcmp(layout->beatOrder, defaultLayout.beatOrder, layout->numBeats) == 0) {
+        uint32_t fixedStream[GROUP_SIZE][BL];
+        uint8_t fixedData[DATA_SIZE];
+
+        for (int checkIdx = 0; checkIdx < NUM_CHECK; ++checkIdx) {
+            for (unsigned int beat = 0; beat < layout->numBeats; ++beat) {
+                dataStream[beat] = (uint32_t)nextRng(&rng);
+            }
+
+            memcpy(fixedStream, dataStream, sizeof(fixedStream));
+            serialize(fixedStream, fixedData, DQ_SIZE, GROUP_SIZE);
+            serializeLayout(layout, dataStream, data);
+            if (memcmp(fixedData, data, DATA_SIZE) != 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef __SERIAL_H__
+#define __SERIAL_H__
+
+#define MAX_SERIAL_DQ 32        // DQs are held in a 32-bit word per tick
+#define MAX_SERIAL_BEATS 64     // limit of groupLen * burstLen
+
+/*
+ *  Bit order of the serialized data.
+ */
+typedef enum {
+    SERIAL_BEAT_MAJOR,          // a byte holds 8 DQs of one beat (serialize())
+    SERIAL_PIN_MAJOR            // a byte holds 8 beats of one DQ
+} SerialOrder;
+
+/*
+ *  Layout of a group of data streams in the serialized data.
+ *
+ *  A beat is a tick of a data stream (beat = streamIdx * burstLen + tick), and
+ *  DQ 'dq' is bit (numDQ - 1 - dq) of the word of a beat. Beats are placed in
+ *  serialized slots by beatOrder, and the bits of (DQ, slot) are laid out by order:
+ *
+ *    - SERIAL_BEAT_MAJOR : bit ((dq / 8) * numBeats + slot) * 8 + dq % 8
+ *    - SERIAL_PIN_MAJOR  : bit dq * numBeats + slot
+ *
+ *  Bit position 0 is the MSB of data[0].
+ */
+typedef struct {
+    unsigned int numDQ;         // DQs per tick (8, 16, 24 or 32)
+    unsigned int burstLen;      // ticks per data stream
+    unsigned int groupLen;      // data streams per group
+    unsigned int numBeats;      // groupLen * burstLen
+    SerialOrder order;
+    uint8_t beatOrder[MAX_SERIAL_BEATS];  // slot -> beat
+    uint8_t beatSlot[MAX_SERIAL_BEATS];   // beat -> slot
+} SerialLayout;
+
+void getSerialLayout(int argc, char *argv[], SerialLayout *layout);
+void initSerialLayout(SerialLayout *layout, unsigned int numDQ, unsigned int burstLen, unsigned int groupLen,
+    SerialOrder order, const uint8_t *beatOrder);
+size_t getSerialSize(const SerialLayout *layout);
+unsigned int getLayoutBitPos(const SerialLayout *layout, unsigned int streamIdx, unsigned int tick, unsigned int dq);
+void serializeLayout(const SerialLayout *layout, const uint32_t *dataStream, uint8_t *data);
+void deserializeLayout(const SerialLayout *layout, const uint8_t *data, uint32_t *dataStream);
+bool checkSerialLayout(const SerialLayout *layout);
+
+#endif
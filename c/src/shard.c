@@ -0,0 +1,245 @@
+/*
+ *  Sharded simulation with checkpoints, and merging of shard result files.
+ *
+ *  A campaign (seed, iterations, model, ...) is split into N shards that can
+ *  run as separate processes or on separate machines. The chunks of a campaign
+ *  have disjoint random streams, and shard i runs every chunk with
+ *  chunkIdx % N == i, so the merged counters of all shards are identical to
+ *  the counters of an unsharded run.
+ *
+ *    1) '--checkpoint FILE' writes the counters and the number of done chunks
+ *       periodically, and at the end, where the file is the shard result.
+ *    2) '--resume FILE' restores the campaign and continues after the done chunks.
+ *    3) 'merge FILE...' combines the result files of the shards into one report.
+ *
+ *  NOTE : A checkpoint is written to FILE.tmp and renamed over FILE, so a crash
+ *         leaves either the previous or the new checkpoint.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "sim.h"
+#include "correct.h"
+#include "shard.h"
+
+/*
+ *  Function to get the number of chunks of the shard of a campaign.
+ */
+uint64_t getShardChunks(const SimConfig *config)
+{
+    uint64_t numChunk = (config->numIter + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    if (config->shardIdx >= numChunk) {
+        return 0;
+    }
+
+    return (numChunk - config->shardIdx + config->numShard - 1) / config->numShard;
+}
+
+/*
+ *  Function to get the campaign chunk of the localIdx-th chunk of a shard.
+ */
+uint64_t getShardChunkIdx(const SimConfig *config, uint64_t localIdx)
+{
+    return localIdx * config->numShard + config->shardIdx;
+}
+
+void initSimCheckpoint(const SimConfig *config, SimCheckpoint *checkpoint)
+{
+    memset(checkpoint, 0, sizeof(SimCheckpoint));
+    memcpy(checkpoint->magic, CHECKPOINT_MAGIC, sizeof(checkpoint->magic));
+    checkpoint->genPoly = GEN_POLY;
+    checkpoint->cwBits = CW_BITS;
+    checkpoint->seed = config->seed;
+    checkpoint->numIter = config->numIter;
+    checkpoint->flipRate = config->flipRate;
+    checkpoint->model = (uint32_t)config->model;
+    checkpoint->correctBurst = config->correctBurst;
+    checkpoint->refGen = config->refGen;
+    checkpoint->bitSlice = config->bitSlice;
+    checkpoint->numShard = config->numShard;
+    checkpoint->shardIdx = config->shardIdx;
+    checkpoint->numChunk = getShardChunks(config);
+}
+
+/*
+ *  Function to write a checkpoint file atomically.
+ */
+void writeSimCheckpoint(const char *path, const SimCheckpoint *checkpoint)
+{
+    size_t pathLen = strlen(path);
+    char *tempPath = (char *)malloc(pathLen + 5);
+
+    if (tempPath == NULL) {
+        printf("Unable to allocate the checkpoint path\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(tempPath, path, pathLen);
+    memcpy(tempPath + pathLen, ".tmp", 5);
+
+    FILE *file = fopen(tempPath, "wb");
+    if (file == NULL) {
+        printf("Unable to open the checkpoint file: %s\n", tempPath);
+        exit(EXIT_FAILURE);
+    }
+
+    bool written = fwrite(checkpoint, sizeof(SimCheckpoint), 1, file) == 1 && fflush(file) == 0 &&
+                   fsync(fileno(file)) == 0;
+    if (fclose(file) != 0 || !written || rename(tempPath, path) != 0) {
+        printf("Unable to write the checkpoint file: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    free(tempPath);
+}
+
+/*
+ *  Function to read a checkpoint file written by writeSimCheckpoint().
+ */
+void readSimCheckpoint(const char *path, SimCheckpoint *checkpoint)
+{
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        printf("Unable to open the checkpoint file: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (fread(checkpoint, sizeof(SimCheckpoint), 1, file) != 1 ||
+        memcmp(checkpoint->magic, CHECKPOINT_MAGIC, sizeof(checkpoint->magic)) != 0) {
+        printf("Not a checkpoint file: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+
+    if (checkpoint->genPoly != GEN_POLY || checkpoint->cwBits != CW_BITS) {
+        printf("Checkpoint of polynomial 0x%08X over %u bits does not match this build: %s\n",
+            checkpoint->genPoly, checkpoint->cwBits, path);
+        exit(EXIT_FAILURE);
+    }
+    if (checkpoint->model >= NUM_ERROR_MODELS || checkpoint->numShard == 0 ||
+        checkpoint->shardIdx >= checkpoint->numShard || checkpoint->doneChunk > checkpoint->numChunk) {
+        printf("Corrupted checkpoint file: %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ *  Function to set the campaign of a checkpoint to simulation settings.
+ */
+void applySimCheckpoint(const SimCheckpoint *checkpoint, SimConfig *config)
+{
+    config->seed = checkpoint->seed;
+    config->numIter = checkpoint->numIter;
+    config->flipRate = checkpoint->flipRate;
+    config->model = (ErrorModel)checkpoint->model;
+    config->correctBurst = checkpoint->correctBurst;
+    config->refGen = checkpoint->refGen;
+    config->bitSlice = checkpoint->bitSlice;
+    config->numShard = checkpoint->numShard;
+    config->shardIdx = checkpoint->shardIdx;
+}
+
+/*
+ *  Function to check if two checkpoints belong to the same campaign.
+ */
+static bool isSameCampaign(const SimCheckpoint *checkpoint1, const SimCheckpoint *checkpoint2)
+{
+    return checkpoint1->seed == checkpoint2->seed && checkpoint1->numIter == checkpoint2->numIter &&
+           checkpoint1->flipRate == checkpoint2->flipRate && checkpoint1->model == checkpoint2->model &&
+           checkpoint1->correctBurst == checkpoint2->correctBurst && checkpoint1->refGen == checkpoint2->refGen &&
+           checkpoint1->bitSlice == checkpoint2->bitSlice && checkpoint1->numShard == checkpoint2->numShard;
+}
+
+/*
+ *  Function to merge shard result files and print the report of the campaign ('merge FILE... [--conf C]').
+ *
+ *  NOTE : Missing and unfinished shards are reported, and their done chunks are merged,
+ *         so the report covers result->numIter iterations.
+ */
+void mergeShards(int argc, char *argv[])
+{
+    SimCheckpoint first = {0};
+    SimCheckpoint checkpoint;
+    SimConfig config;
+    SimResult total = {0};
+    bool *merged = NULL;
+    unsigned int numFile = 0;
+    unsigned int numDone = 0;
+
+    memset(&config, 0, sizeof(SimConfig));
+    config.numThreads = 1;
+    config.confLevel = SIM_CONF_LEVEL;
+
+    for (int argIdx = 2; argIdx < argc; ++argIdx) {
+        if (strcmp(argv[argIdx], "--conf") == 0 && argIdx < argc - 1) {
+            config.confLevel = strtod(argv[++argIdx], NULL);
+            continue;
+        }
+
+        readSimCheckpoint(argv[argIdx], &checkpoint);
+        if (numFile == 0) {
+            first = checkpoint;
+            merged = (bool *)calloc(first.numShard, sizeof(bool));
+            if (merged == NULL) {
+                printf("Unable to allocate %u shards\n", first.numShard);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!isSameCampaign(&first, &checkpoint)) {
+            printf("Shard file of another campaign: %s\n", argv[argIdx]);
+            exit(EXIT_FAILURE);
+        }
+        if (merged[checkpoint.shardIdx]) {
+            printf("Shard %u/%u is given twice: %s\n", checkpoint.shardIdx, checkpoint.numShard, argv[argIdx]);
+            exit(EXIT_FAILURE);
+        }
+
+        merged[checkpoint.shardIdx] = true;
+        mergeSimResult(&total, &checkpoint.result);
+        numFile++;
+
+        if (checkpoint.doneChunk == checkpoint.numChunk) {
+            numDone++;
+        }
+        else {
+            printf("Shard %u/%u is unfinished: %llu / %llu chunks (%s)\n", checkpoint.shardIdx, checkpoint.numShard,
+                (unsigned long long)checkpoint.doneChunk, (unsigned long long)checkpoint.numChunk, argv[argIdx]);
+        }
+    }
+
+    if (numFile == 0) {
+        printf("Usage: %s merge <FILE>... [--conf <C>]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int shardIdx = 0; shardIdx < first.numShard; ++shardIdx) {
+        if (!merged[shardIdx]) {
+            printf("Shard %u/%u is missing\n", shardIdx, first.numShard);
+        }
+    }
+
+    applySimCheckpoint(&first, &config);
+    if (isFaultModel(config.model)) {
+        genFaultCache(&faultCache, config.model);
+    }
+    if (config.correctBurst) {
+        genCorrectTable(&correctTable, &synTable, config.correctBurst);
+    }
+
+    printf("Seed : %llu, Shards : %u of %u finished, Model : %s\n", (unsigned long long)config.seed, numDone,
+        first.numShard, getErrorModelName(config.model));
+    printSimReport(&config, &total);
+
+    if (config.correctBurst) {
+        freeCorrectTable(&correctTable);
+    }
+    if (isFaultModel(config.model)) {
+        freeFaultCache(&faultCache);
+    }
+    free(merged);
+}
@@ -0,0 +1,42 @@
+#ifndef __SHARD_H__
+#define __SHARD_H__
+
+#define CHECKPOINT_MAGIC "CRCSIM02"     // first 8 bytes of a checkpoint file
+#define CHECKPOINT_SEC 60.0             // default interval of periodic checkpoints in seconds
+#define CHECKPOINT_CHUNKS 16            // chunks per thread between checkpoint opportunities
+
+/*
+ *  Checkpoint of a simulation shard, which is also its result file.
+ *
+ *  NOTE : Every chunk draws from its own stream seeded by (seed, chunkIdx), so
+ *         the random state of a shard is fully described by its done chunks.
+ *         Shard i of N runs the chunks with chunkIdx % N == i, in order.
+ *         The file is a raw image of this struct, read back by the same build.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t genPoly;           // campaign: fields that must match to resume or merge
+    uint32_t cwBits;
+    uint64_t seed;
+    uint64_t numIter;           // iterations of all shards together
+    double flipRate;
+    uint32_t model;
+    uint32_t correctBurst;
+    uint32_t refGen;
+    uint32_t bitSlice;
+    uint32_t numShard;
+    uint32_t shardIdx;          // shard of the file
+    uint64_t numChunk;          // chunks of the shard
+    uint64_t doneChunk;         // chunks of the shard done, the first doneChunk in order
+    SimResult result;           // counters of the done chunks
+} SimCheckpoint;
+
+uint64_t getShardChunks(const SimConfig *config);
+uint64_t getShardChunkIdx(const SimConfig *config, uint64_t localIdx);
+void initSimCheckpoint(const SimConfig *config, SimCheckpoint *checkpoint);
+void writeSimCheckpoint(const char *path, const SimCheckpoint *checkpoint);
+void readSimCheckpoint(const char *path, SimCheckpoint *checkpoint);
+void applySimCheckpoint(const SimCheckpoint *checkpoint, SimConfig *config);
+void mergeShards(int argc, char *argv[]);
+
+#endif
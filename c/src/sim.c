@@ -4,83 +4,760 @@
 #include <stdbool.h>
 #include <time.h>
 #include <string.h>
+#include <math.h>
+#include <pthread.h>
 #include "crc32.h"
+#include "syndrome.h"
 #include "sim.h"
+#include "correct.h"
+#include "bitslice.h"
+#include "shard.h"
+#include "report.h"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 
 /*
- *  Function for Monte Carlo simulation.
+ *  Worker thread context.
+ *
+ *  NOTE : Each worker owns its result, so counters are updated without contention.
+ *         Aligned to a cache line to avoid false sharing between workers.
+ */
+typedef struct {
+    const SimConfig *config;
+    unsigned int threadIdx;
+    uint64_t firstChunk;        // chunks [firstChunk, endChunk) of the shard in this round
+    uint64_t endChunk;
+    SimResult result;
+    SimProfile *profile;        // counters of the thread over the run
+} __attribute__((aligned(64))) SimWorker;
+
+#if PROFILE_ENABLED
+static __thread SimProfile *threadProfile;     // profile of the worker running on this thread
+
+// Progress of the run, shared by the workers.
+static uint64_t progressIter;                   // trials done (atomic)
+static uint64_t progressTarget;                 // trials of the run
+static uint64_t progressNextNs;                 // time of the next progress line (atomic)
+static struct timespec progressStart;
+#endif
+
+static void printCorrectResult(const SimResult *result, double confLevel);
+
+/*
+ *  Function to get simulation settings from program input arguments.
  */
-void simulate(unsigned int numIter)
+void getSimConfig(int argc, char *argv[], SimConfig *config)
 {
-    srand((unsigned int)time(NULL));
+    config->numIter = NUM_ITER;
+    config->numThreads = 1;
+    config->seed = (uint64_t)time(NULL);
+    config->flipRate = 0.5;
+    config->refGen = false;
+    config->model = ERROR_BURST;
+    config->confLevel = SIM_CONF_LEVEL;
+    config->importance = false;
+    config->relErr = SIM_REL_ERR;
+    config->bound = 0.0;
+    config->correctBurst = 0;
+    config->bitSlice = false;
+    config->shardIdx = 0;
+    config->numShard = 1;
+    config->checkpointPath = NULL;
+    config->checkpointSec = CHECKPOINT_SEC;
+    config->resumePath = NULL;
+    config->reportPath = NULL;
+    config->progressSec = PROFILE_ENABLED ? SIM_PROGRESS_SEC : 0.0;
 
-    unsigned int totDetError = 0;
-    unsigned int totBurst32Error = 0;
-    unsigned int detBurst32Error = 0;
-    unsigned int totOddError = 0;
-    unsigned int detOddError = 0;
-    unsigned int totDoubleError = 0;
-    unsigned int detDoubleError = 0;
+    bool iterGiven = false;
 
-    for (unsigned int i = 0; i < numIter; ++i) {
-        // Generate codeword by concatnating data and checksum.
-        // The original codeword is all-zero.
-        uint8_t codeword[CW_SIZE] = {0};
+    for (int argIdx = 2; argIdx < argc; ++argIdx) {
+        if (strcmp(argv[argIdx], "--ref") == 0) {
+            config->refGen = true;
+        }
+        else if (strcmp(argv[argIdx], "--is") == 0) {
+            config->importance = true;
+        }
+        else if (strcmp(argv[argIdx], "--bitslice") == 0) {
+            config->bitSlice = true;
+        }
+        else if (strcmp(argv[argIdx], "--flip-rate") == 0) {
+            config->flipRate = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--iter") == 0) {
+            config->numIter = strtoull(getOptionValue(argc, argv, &argIdx), NULL, 0);
+            iterGiven = true;
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--seed") == 0) {
+            config->seed = strtoull(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--conf") == 0) {
+            config->confLevel = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--rel-err") == 0) {
+            config->relErr = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--bound") == 0) {
+            config->bound = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--correct") == 0) {
+            config->correctBurst = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--model") == 0) {
+            const char *name = getOptionValue(argc, argv, &argIdx);
+
+            config->model = getErrorModel(name);
+            if (config->model == NUM_ERROR_MODELS) {
+                printf("Unknown error model: %s\n", name);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[argIdx], "--shard") == 0) {
+            const char *shard = getOptionValue(argc, argv, &argIdx);
+
+            if (sscanf(shard, "%u/%u", &config->shardIdx, &config->numShard) != 2 ||
+                config->numShard == 0 || config->shardIdx >= config->numShard) {
+                printf("Shard must be i/N with i < N: %s\n", shard);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[argIdx], "--checkpoint") == 0) {
+            config->checkpointPath = getOptionValue(argc, argv, &argIdx);
+        }
+        else if (strcmp(argv[argIdx], "--checkpoint-every") == 0) {
+            config->checkpointSec = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--resume") == 0) {
+            config->resumePath = getOptionValue(argc, argv, &argIdx);
+        }
+        else if (strcmp(argv[argIdx], "--report") == 0) {
+            config->reportPath = getOptionValue(argc, argv, &argIdx);
+        }
+        else if (strcmp(argv[argIdx], "--progress") == 0) {
+            config->progressSec = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+            if (!PROFILE_ENABLED && config->progressSec > 0.0) {
+                printf("Progress lines need a build with instrumentation (make PROFILE=1)\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            exitUnknownOption(argv, argIdx);
+        }
+    }
 
-        // Generate an error vector and apply to the codeword.
-        uint8_t error[CW_SIZE] = {0};
-        genBurstError(error, CW_SIZE);
-        bitwiseXOR(codeword, error, CW_SIZE);
+    // A resumed run continues the campaign of its checkpoint, and keeps writing to it by default.
+    if (config->resumePath != NULL) {
+        SimCheckpoint checkpoint;
 
-        // Analyze the simulation result.
-        bool detected = decodeCRC(codeword, CW_SIZE);
+        readSimCheckpoint(config->resumePath, &checkpoint);
+        applySimCheckpoint(&checkpoint, config);
+        iterGiven = true;
+        if (config->checkpointPath == NULL) {
+            config->checkpointPath = config->resumePath;
+        }
+    }
 
-        unsigned int errorCount = countOne(error, CW_SIZE);  // # of error bits
+    if (config->importance && !iterGiven) {
+        config->numIter = SIM_MAX_ITER;  // importance sampling stops at its target
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+    if (config->confLevel <= 0.0 || config->confLevel >= 1.0) {
+        printf("Confidence level must be in (0, 1): %g\n", config->confLevel);
+        exit(EXIT_FAILURE);
+    }
+    if (config->correctBurst && config->importance) {
+        printf("Correction is not supported by importance sampling\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config->correctBurst > MAX_CORRECT_BURST) {
+        printf("Corrected burst length must be up to %d bits\n", MAX_CORRECT_BURST);
+        exit(EXIT_FAILURE);
+    }
+    if (config->bitSlice && (config->refGen || config->importance || config->correctBurst)) {
+        printf("The bit-sliced engine does not support --ref, --is or --correct\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config->bitSlice && !isBitSliceModel(config->model)) {
+        printf("The bit-sliced engine does not support the %s model\n", getErrorModelName(config->model));
+        exit(EXIT_FAILURE);
+    }
+    if (config->importance && (config->numShard > 1 || config->checkpointPath != NULL)) {
+        printf("Importance sampling does not support --shard, --checkpoint or --resume\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config->importance && config->reportPath != NULL) {
+        printf("Importance sampling does not support --report\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ *  Function to generate an error vector of the error model.
+ */
+static void genErrorVector(const SimConfig *config, Rng *rng, uint64_t flipProb, uint8_t *error)
+{
+    switch (config->model) {
+        case ERROR_RANDOM : {
+            if (config->refGen) {
+                genError(error, CW_SIZE, rng, config->flipRate);
+            }
+            else {
+                genErrorFast(error, CW_SIZE, rng, flipProb);
+            }
+            break;
+        }
+        case ERROR_BURST : {
+            if (config->refGen) {
+                genBurstError(error, CW_SIZE, rng, config->flipRate);
+            }
+            else {
+                genBurstErrorFast(error, CW_SIZE, rng, flipProb);
+            }
+            break;
+        }
+        default : {
+            uint64_t mask[FAULT_WORDS];
+            unsigned int regionIdx = genFaultMaskRef(&faultCache, rng, config->flipRate, mask);
+            getFaultError(&faultCache, regionIdx, mask, error);
+            break;
+        }
+    }
+}
+
+/*
+ *  Function to run a chunk of iterations.
+ *
+ *  NOTE : Every chunk has its own random stream seeded by (seed, chunkIdx),
+ *         so the result of a chunk does not depend on which thread runs it.
+ *         For a DRAM fault model, genFaultCache() must be called before use, and
+ *         with correction, genCorrectTable().
+ */
+void simulateChunk(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result)
+{
+    Rng rng;
+    seedRng(&rng, config->seed, chunkIdx);
+
+    uint64_t flipProb = getRngProb(config->flipRate);
+
+#if PROFILE_ENABLED
+    SimProfile unusedProfile = {0};
+    SimProfile *profile = threadProfile != NULL ? threadProfile : &unusedProfile;
+#endif
+
+    // Generate codeword by concatnating data and checksum.
+    // The original data is all-zero.
+    uint8_t original[CW_SIZE] = {0};
+    encodeCRC(original, DATA_SIZE);
+
+    for (uint64_t i = 0; i < numIter; ++i) {
+        bool detected;
+        unsigned int errorCount;  // # of error bits
+        unsigned int burstLen;
+        const CorrectEntry *entry = NULL;  // correctable pattern of the syndrome
+        bool corrected = false;
+
+        PROFILE_START(lap, i);
+
+        if (isFaultModel(config->model) && !config->refGen) {
+            // A DRAM fault is evaluated with the syndrome cache of its region.
+            uint64_t mask[FAULT_WORDS] = {0};
+            unsigned int regionIdx = genFaultMask(&faultCache, &rng, flipProb, mask);
+            PROFILE_LAP(profile, SIM_PHASE_GEN, lap);
+
+            uint32_t syndrome = getFaultSyndrome(&faultCache, regionIdx, mask);
+
+            detected = syndrome != 0;
+            if (config->correctBurst && detected) {
+                entry = findCorrection(&correctTable, syndrome);
+                if (entry != NULL) {
+                    uint8_t error[CW_SIZE] = {0};
+                    getFaultError(&faultCache, regionIdx, mask, error);
+                    corrected = matchCorrection(entry, error, CW_SIZE);
+                }
+            }
+            PROFILE_LAP(profile, SIM_PHASE_DECODE, lap);
+
+            errorCount = 0;
+            for (unsigned int wordIdx = 0; wordIdx < FAULT_WORDS; ++wordIdx) {
+                errorCount += __builtin_popcountll(mask[wordIdx]);
+            }
+            PROFILE_LAP(profile, SIM_PHASE_COUNT, lap);
+
+            burstLen = getFaultBurstLen(&faultCache, regionIdx, mask);
+            PROFILE_LAP(profile, SIM_PHASE_BURST, lap);
+        }
+        else {
+            // Generate an error vector.
+            uint8_t error[CW_SIZE] = {0};
+            genErrorVector(config, &rng, flipProb, error);
+            PROFILE_LAP(profile, SIM_PHASE_GEN, lap);
+
+            // Analyze the simulation result.
+            if (config->refGen) {
+                // Apply the error to the codeword and decode it.
+                uint8_t codeword[CW_SIZE];
+                memcpy(codeword, original, CW_SIZE);
+                bitwiseXOR(codeword, error, CW_SIZE);
+
+                if (config->correctBurst) {
+                    CorrectStatus status = correctCodeword(&correctTable, codeword, CW_SIZE);
+
+                    detected = status != CORRECT_CLEAN;
+                    if (status == CORRECT_FIXED) {
+                        entry = findCorrection(&correctTable, getSyndrome(&synTable, error, CW_SIZE));
+                        corrected = memcmp(codeword, original, CW_SIZE) == 0;
+                    }
+                }
+                else {
+                    detected = decodeCRC(codeword, CW_SIZE);
+                }
+            }
+            else {
+                // The syndrome only depends on the error vector, as CRC is linear.
+                uint32_t syndrome = getSyndrome(&synTable, error, CW_SIZE);
+
+                detected = syndrome != 0;
+                if (config->correctBurst && detected) {
+                    entry = findCorrection(&correctTable, syndrome);
+                    corrected = entry != NULL && matchCorrection(entry, error, CW_SIZE);
+                }
+            }
+            PROFILE_LAP(profile, SIM_PHASE_DECODE, lap);
+
+            errorCount = config->refGen ? countOne(error, CW_SIZE) : countOneFast(error, CW_SIZE);
+            PROFILE_LAP(profile, SIM_PHASE_COUNT, lap);
+
+            burstLen = config->refGen ? getBurstLen(error, CW_SIZE) : getBurstLenFast(error, CW_SIZE);
+            PROFILE_LAP(profile, SIM_PHASE_BURST, lap);
+        }
 
         // 1) Count detected error.
-        if (errorCount > 0 && detected) {
-            totDetError++;
+        if (errorCount > 0) {
+            result->numError++;
+
+            if (detected) {
+                result->totDetError++;
+            }
         }
 
         // 2) Count odd error.
         if (errorCount % 2) {
-            totOddError++;
+            result->totOddError++;
 
             if (detected) {
-                detOddError++;
+                result->detOddError++;
             }
         }
 
         // 3) Count double error.
         if (errorCount == 2) {
-            totDoubleError++;
+            result->totDoubleError++;
 
             if (detected) {
-                detDoubleError++;
+                result->detDoubleError++;
             }
         }
 
         // 4) Count burst error. (burst length <= 32)
-        unsigned int burstLen = getBurstLen(error, CW_SIZE);
-        if (burstLen <= 32) {
-            totBurst32Error++;
+        if (errorCount > 0 && burstLen <= 32) {
+            result->totBurst32Error++;
 
             if (detected) {
-                detBurst32Error++;
+                result->detBurst32Error++;
+            }
+        }
+
+        // 5) Count corrected error. A correction of another pattern is a miscorrection.
+        if (entry != NULL) {
+            if (corrected) {
+                result->numCorrected++;
+            }
+            else {
+                result->numMiscorrected++;
             }
         }
+
+        PROFILE_END(profile, lap);
+    }
+
+    result->numIter += numIter;
+}
+
+#if PROFILE_ENABLED
+/*
+ *  Function to get the nanoseconds since the start of the run.
+ */
+static uint64_t getProgressNs()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - progressStart.tv_sec) * 1000000000 + now.tv_nsec - progressStart.tv_nsec;
+}
+
+/*
+ *  Function to count the trials of a chunk, and print a progress line once the interval has passed.
+ *
+ *  NOTE : Called by every worker after each chunk. Only the worker that moves
+ *         progressNextNs forward prints, so each interval is printed once.
+ */
+static void reportSimProgress(const SimConfig *config, uint64_t numIter)
+{
+    uint64_t doneIter = __atomic_add_fetch(&progressIter, numIter, __ATOMIC_RELAXED);
+    uint64_t nextNs = __atomic_load_n(&progressNextNs, __ATOMIC_RELAXED);
+    uint64_t nowNs = getProgressNs();
+
+    if (config->progressSec <= 0.0 || nowNs < nextNs) {
+        return;
+    }
+    if (!__atomic_compare_exchange_n(&progressNextNs, &nextNs, nowNs + (uint64_t)(config->progressSec * 1e9),
+                                     false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    printf("Progress : %.1f s, %llu / %llu trials (%.1f%%), %.3f M trials/s\n", nowNs * 1e-9,
+        (unsigned long long)doneIter, (unsigned long long)progressTarget,
+        progressTarget ? (double)doneIter * 100 / progressTarget : 0.0, doneIter / (nowNs * 1e-9) * 1e-6);
+    fflush(stdout);
+}
+#endif
+
+/*
+ *  Worker thread function. Chunks of the round are distributed round-robin over workers.
+ */
+static void *simulateWorker(void *arg)
+{
+    SimWorker *worker = (SimWorker *)arg;
+    const SimConfig *config = worker->config;
+
+#if PROFILE_ENABLED
+    threadProfile = worker->profile;
+#endif
+
+    for (uint64_t localIdx = worker->firstChunk + worker->threadIdx; localIdx < worker->endChunk;
+         localIdx += config->numThreads) {
+        uint64_t chunkIdx = getShardChunkIdx(config, localIdx);
+        uint64_t firstIter = chunkIdx * CHUNK_SIZE;
+        uint64_t numIter = config->numIter - firstIter < CHUNK_SIZE ? config->numIter - firstIter : CHUNK_SIZE;
+        uint64_t startCycles = PROFILE_CYCLES();
+
+        if (config->bitSlice) {
+            simulateBitSliceChunk(config, chunkIdx, numIter, &worker->result);
+        }
+        else {
+            simulateChunk(config, chunkIdx, numIter, &worker->result);
+        }
+
+        worker->profile->chunkCycles += PROFILE_CYCLES() - startCycles;
+        worker->profile->numTrial += numIter;
+        worker->profile->numChunk++;
+
+#if PROFILE_ENABLED
+        reportSimProgress(config, numIter);
+#endif
+    }
+
+#if PROFILE_ENABLED
+    threadProfile = NULL;
+#endif
+
+    return NULL;
+}
+
+/*
+ *  Function to run chunks [firstChunk, endChunk) of the shard on all workers, and add their counters.
+ */
+static void runSimRound(const SimConfig *config, SimWorker *workers, pthread_t *threads, SimProfile *profiles,
+    uint64_t firstChunk, uint64_t endChunk, SimResult *total)
+{
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        memset(&workers[threadIdx], 0, sizeof(SimWorker));
+        workers[threadIdx].config = config;
+        workers[threadIdx].threadIdx = threadIdx;
+        workers[threadIdx].firstChunk = firstChunk;
+        workers[threadIdx].endChunk = endChunk;
+        workers[threadIdx].profile = &profiles[threadIdx];
+
+        if (pthread_create(&threads[threadIdx], NULL, simulateWorker, &workers[threadIdx]) != 0) {
+            printf("Unable to create thread %u\n", threadIdx);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Merge per-thread counters after all workers are done.
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        pthread_join(threads[threadIdx], NULL);
+        mergeSimResult(total, &workers[threadIdx].result);
+    }
+}
+
+/*
+ *  Function for Monte Carlo simulation.
+ *
+ *  NOTE : For a fixed seed, the result is identical for any number of threads,
+ *         and the merged result of all shards is identical to an unsharded run.
+ *         With a checkpoint file, chunks run in rounds of CHECKPOINT_CHUNKS per
+ *         thread, and the counters are saved after a round once checkpointSec
+ *         has passed, and after the last round. With --report, a JSON report
+ *         of the run is written at the end (see report.c).
+ */
+void simulate(const SimConfig *config)
+{
+    SimWorker *workers = (SimWorker *)aligned_alloc(64, config->numThreads * sizeof(SimWorker));
+    pthread_t *threads = (pthread_t *)calloc(config->numThreads, sizeof(pthread_t));
+    SimProfile *profiles = (SimProfile *)aligned_alloc(64, config->numThreads * sizeof(SimProfile));
+    SimCheckpoint checkpoint;
+    struct timespec startTime, lastTime, now;
+
+    if (workers == NULL || threads == NULL || profiles == NULL) {
+        printf("Unable to allocate %u workers\n", config->numThreads);
+        exit(EXIT_FAILURE);
+    }
+    memset(profiles, 0, config->numThreads * sizeof(SimProfile));
+
+    if (config->resumePath != NULL) {
+        readSimCheckpoint(config->resumePath, &checkpoint);
+        printf("Resuming %s : %llu / %llu chunks done\n", config->resumePath,
+            (unsigned long long)checkpoint.doneChunk, (unsigned long long)checkpoint.numChunk);
+    }
+    else {
+        initSimCheckpoint(config, &checkpoint);
+    }
+
+    if (isFaultModel(config->model)) {
+        genFaultCache(&faultCache, config->model);
+    }
+    if (config->correctBurst) {
+        genCorrectTable(&correctTable, &synTable, config->correctBurst);
+    }
+
+    // The cost of a phase timer lap, taken off the phases in the report.
+    double lapCycles = measureProfileLap();
+
+    // Without a checkpoint file, all chunks run in a single round.
+    uint64_t roundChunk = config->checkpointPath != NULL ? (uint64_t)CHECKPOINT_CHUNKS * config->numThreads :
+                                                           checkpoint.numChunk;
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    lastTime = startTime;
+    uint64_t startCycles = PROFILE_CYCLES();
+
+#if PROFILE_ENABLED
+    progressStart = startTime;
+    progressIter = 0;
+    progressNextNs = (uint64_t)(config->progressSec * 1e9);
+    progressTarget = 0;
+    for (uint64_t localIdx = checkpoint.doneChunk; localIdx < checkpoint.numChunk; ++localIdx) {
+        uint64_t firstIter = getShardChunkIdx(config, localIdx) * CHUNK_SIZE;
+        progressTarget += config->numIter - firstIter < CHUNK_SIZE ? config->numIter - firstIter : CHUNK_SIZE;
+    }
+#endif
+
+    while (checkpoint.doneChunk < checkpoint.numChunk) {
+        uint64_t endChunk = checkpoint.numChunk - checkpoint.doneChunk < roundChunk ? checkpoint.numChunk :
+                                                                                     checkpoint.doneChunk + roundChunk;
+
+        runSimRound(config, workers, threads, profiles, checkpoint.doneChunk, endChunk, &checkpoint.result);
+        checkpoint.doneChunk = endChunk;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (config->checkpointPath != NULL && (checkpoint.doneChunk == checkpoint.numChunk ||
+            (double)(now.tv_sec - lastTime.tv_sec) + (now.tv_nsec - lastTime.tv_nsec) * 1e-9 >= config->checkpointSec)) {
+            writeSimCheckpoint(config->checkpointPath, &checkpoint);
+            lastTime = now;
+        }
     }
+    if (config->checkpointPath != NULL && checkpoint.numChunk == 0) {
+        writeSimCheckpoint(config->checkpointPath, &checkpoint);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double seconds = (double)(now.tv_sec - startTime.tv_sec) + (now.tv_nsec - startTime.tv_nsec) * 1e-9;
+    double tscHz = PROFILE_ENABLED && seconds > 0.0 ? (PROFILE_CYCLES() - startCycles) / seconds : 0.0;
+
+    printf("Seed : %llu, Threads : %u, Model : %s\n", (unsigned long long)config->seed, config->numThreads,
+        getErrorModelName(config->model));
+    if (config->numShard > 1) {
+        printf("Shard : %u/%u, %llu of %llu iterations\n", config->shardIdx, config->numShard,
+            (unsigned long long)checkpoint.result.numIter, (unsigned long long)config->numIter);
+    }
+    if (config->bitSlice) {
+        printf("Engine : bit-sliced, %d lanes (%s)\n", BITSLICE_LANES, getBitSliceISA());
+    }
+    printSimReport(config, &checkpoint.result);
+
+    if (config->reportPath != NULL) {
+        writeSimReport(config->reportPath, config, &checkpoint.result, profiles, seconds, tscHz, lapCycles);
+    }
+
+    if (config->correctBurst) {
+        freeCorrectTable(&correctTable);
+    }
+    if (isFaultModel(config->model)) {
+        freeFaultCache(&faultCache);
+    }
+
+    free(profiles);
+    free(threads);
+    free(workers);
+}
+
+/*
+ *  Function to print the result of a simulation, with the details of its model and correction.
+ *
+ *  NOTE : The fault cache of a DRAM fault model and the correction table must be generated.
+ */
+void printSimReport(const SimConfig *config, const SimResult *result)
+{
+    printSimResult(result, config->confLevel);
+
+    // With a flip rate of 0.5, every error pattern of a region is equally likely.
+    if (isFaultModel(config->model) && config->model != ERROR_ADJ_PIN && config->flipRate == 0.5) {
+        printf("Expected undetected fraction (syndrome rank) : %.6e\n", getFaultUndetected(&faultCache));
+    }
+    if (config->correctBurst) {
+        printCorrectResult(result, config->confLevel);
+    }
+}
+
+/*
+ *  Function to add counters of a simulation result to another.
+ */
+void mergeSimResult(SimResult *dst, const SimResult *src)
+{
+    dst->numIter         += src->numIter;
+    dst->numError        += src->numError;
+    dst->totDetError     += src->totDetError;
+    dst->totOddError     += src->totOddError;
+    dst->detOddError     += src->detOddError;
+    dst->totDoubleError  += src->totDoubleError;
+    dst->detDoubleError  += src->detDoubleError;
+    dst->totBurst32Error += src->totBurst32Error;
+    dst->detBurst32Error += src->detBurst32Error;
+    dst->numCorrected    += src->numCorrected;
+    dst->numMiscorrected += src->numMiscorrected;
+}
+
+/*
+ *  Function to get x such that P(Z <= x) = prob for a standard normal Z.
+ */
+double getNormalQuantile(double prob)
+{
+    double lower = -40.0;
+    double upper = 40.0;
+
+    // The normal CDF is 0.5 * erfc(-x / sqrt(2)); bisect it to full precision.
+    for (int step = 0; step < 128; ++step) {
+        double middle = 0.5 * (lower + upper);
+
+        if (0.5 * erfc(-middle / sqrt(2.0)) < prob) {
+            lower = middle;
+        }
+        else {
+            upper = middle;
+        }
+    }
+
+    return 0.5 * (lower + upper);
+}
+
+/*
+ *  Function to get the Wilson score interval of a binomial proportion.
+ *
+ *  NOTE : Unlike the normal approximation, the interval stays inside [0, 1]
+ *         and is meaningful when numHit is 0 or numTrial.
+ */
+void getWilsonInterval(uint64_t numHit, uint64_t numTrial, double z, double *lower, double *upper)
+{
+    if (numTrial == 0) {
+        *lower = 0.0;
+        *upper = 1.0;
+        return;
+    }
+
+    double n = (double)numTrial;
+    double ratio = (double)numHit / n;
+    double denom = 1.0 + z * z / n;
+    double center = (ratio + z * z / (2.0 * n)) / denom;
+    double halfWidth = z * sqrt(ratio * (1.0 - ratio) / n + z * z / (4.0 * n * n)) / denom;
+
+    *lower = center - halfWidth > 0.0 ? center - halfWidth : 0.0;
+    *upper = center + halfWidth < 1.0 ? center + halfWidth : 1.0;
+}
+
+/*
+ *  Function to print a detected ratio with its confidence interval.
+ */
+static void printDetectRatio(const char *name, uint64_t numDet, uint64_t numTot, double z)
+{
+    double lower, upper;
+
+    getWilsonInterval(numDet, numTot, z, &lower, &upper);
+    printf("%s : %llu / %llu (%.2f%%, CI %.6f%% - %.6f%%)\n", name,
+        (unsigned long long)numDet, (unsigned long long)numTot,
+        numTot ? (double)numDet * 100 / numTot : 0.0, lower * 100, upper * 100);
+}
+
+/*
+ *  Function to print a simulation result.
+ *
+ *  NOTE : Every ratio comes with its Wilson score interval at confLevel.
+ *         Ratios are over the trials with an error, as an error-free trial
+ *         can be neither detected nor undetected.
+ */
+void printSimResult(const SimResult *result, double confLevel)
+{
+    double z = getNormalQuantile(0.5 + confLevel / 2);
 
-    // Print the result.
     printf("##### Result #####\n");
-    printf("Total detected error       : %d / %d (%.2f%%)\n", 
-        totDetError, numIter, (double)totDetError * 100 / numIter);
-    printf("Odd error                  : %d / %d (%.2f%%)\n", 
-        detOddError, totOddError, (double)detOddError * 100 / totOddError);
-    //printf("Double error              : %d / %d (%.2f%%)\n", 
-    //    detDoubleError, totDoubleError, (double)detDoubleError * 100 / totDoubleError);
-    printf("Burst error (length <= 32) : %d / %d (%.2f%%)\n", 
-        detBurst32Error, totBurst32Error, (double)detBurst32Error * 100 / totBurst32Error);
+    printf("Confidence level : %g%%\n", confLevel * 100);
+    printf("Erroneous trial            : %llu / %llu\n", (unsigned long long)result->numError, (unsigned long long)result->numIter);
+    printDetectRatio("Total detected error      ", result->totDetError, result->numError, z);
+    printDetectRatio("Undetected error          ", result->numError - result->totDetError, result->numError, z);
+    printDetectRatio("Odd error                 ", result->detOddError, result->totOddError, z);
+    //printDetectRatio("Double error              ", result->detDoubleError, result->totDoubleError, z);
+    printDetectRatio("Burst error (length <= 32)", result->detBurst32Error, result->totBurst32Error, z);
+}
+
+/*
+ *  Function to print the correction counters of a simulation result.
+ *
+ *  NOTE : Detected errors are corrected, miscorrected, or retried. An uncorrectable
+ *         error with a random syndrome is miscorrected with probability numPattern / 2^32.
+ */
+static void printCorrectResult(const SimResult *result, double confLevel)
+{
+    double z = getNormalQuantile(0.5 + confLevel / 2);
+    uint64_t numRetried = result->totDetError - result->numCorrected - result->numMiscorrected;
+
+    printf("##### Correction (bursts up to %u bits) #####\n", correctTable.maxBurst);
+    printf("Correction table : %llu patterns, %llu ambiguous syndromes, %zu KB\n",
+        (unsigned long long)correctTable.numPattern, (unsigned long long)correctTable.numAmbiguous,
+        (sizeof(CorrectEntry) << correctTable.hashBits) / 1024);
+    printDetectRatio("Corrected error           ", result->numCorrected, result->totDetError, z);
+    printDetectRatio("Miscorrected error        ", result->numMiscorrected, result->totDetError, z);
+    printDetectRatio("Retried error             ", numRetried, result->totDetError, z);
+    printf("Expected miscorrection of a random syndrome : %.6e\n", (double)correctTable.numPattern / 4294967296.0);
+}
+
+/*
+ *  Function to append the checksum of the data to make a codeword.
+ *
+ *  NOTE : The checksum is stored MSB-first right after the data,
+ *         so the codeword must have room for dataLen + CRC/BYTE bytes.
+ */
+void encodeCRC(uint8_t *codeword, size_t dataLen)
+{
+    uint32_t checksum = calcCRC(codeword, dataLen);
+
+    for (int byteIdx = 0; byteIdx < CRC / BYTE; ++byteIdx) {
+        codeword[dataLen + byteIdx] = (uint8_t)(checksum >> (CRC - BYTE * (byteIdx + 1)));
+    }
 }
 
 /*
@@ -88,28 +765,21 @@ void simulate(unsigned int numIter)
  */
 bool decodeCRC(uint8_t *data, size_t byteLen)
 {   
-    uint32_t checksum = calcCRC(data, byteLen);
+    size_t dataLen = byteLen - CRC / BYTE;
+    uint32_t checksum = calcCRC(data, dataLen);  // checksum for the received data
 
-    // Non-zero checksum indicates that an error is detected,
-    // as the original codeword was all-zero.
-    for (size_t byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
-        if (data[byteIdx] != 0x00) {
-            return true;
-        }
-    }
-    return false;
+    // Mismatch with the received checksum indicates that an error is detected.
+    return checksum != loadBE32(&data[dataLen]);
 }
 
 /*
  *  Function to randomly generate errors in the codeword.
  */
-void genError(uint8_t *data, size_t byteLen)
+void genError(uint8_t *data, size_t byteLen, Rng *rng, double flipRate)
 {
-    float flipRate = 0.5;
-
     for (size_t byteIdx = 0; byteIdx < byteLen; ++byteIdx) {
         for (int bitIdx = 0; bitIdx < BYTE; ++bitIdx) {
-            if (((float)rand() / (float)RAND_MAX) < flipRate) {
+            if (nextUniform(rng) < flipRate) {
                 data[byteIdx] |= (0x01 << bitIdx);  // flip each bit with a 
                                                     // probability of flipRate
             }
@@ -120,15 +790,13 @@ void genError(uint8_t *data, size_t byteLen)
 /*
  *  Function to randomly generate a burst error (length <= 32) in the codeword.
  */
-void genBurstError(uint8_t *data, size_t byteLen)
+void genBurstError(uint8_t *data, size_t byteLen, Rng *rng, double flipRate)
 {
-    float flipRate = 0.5;
-
-    unsigned int startByteIdx = rand() % DATA_SIZE + 1;
+    unsigned int startByteIdx = nextRng(rng) % DATA_SIZE + 1;
 
     for (size_t byteIdx = startByteIdx; byteIdx < startByteIdx + (CW_SIZE - DATA_SIZE); ++byteIdx) {
         for (int bitIdx = 0; bitIdx < BYTE; ++bitIdx) {
-            if (((float)rand() / (float)RAND_MAX) < flipRate) {
+            if (nextUniform(rng) < flipRate) {
                 data[byteIdx] |= (0x01 << bitIdx);  // flip each bit with a 
                                                     // probability of flipRate
             }
@@ -136,6 +804,54 @@ void genBurstError(uint8_t *data, size_t byteLen)
     }
 }
 
+/*
+ *  Function to load/store 8 bytes as a native 64-bit word.
+ */
+static inline uint64_t loadWord(const uint8_t *data)
+{
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+static inline void orWord(uint8_t *data, uint64_t word, size_t byteLen)
+{
+    uint64_t prev = 0;
+    memcpy(&prev, data, byteLen);
+    prev |= word;
+    memcpy(data, &prev, byteLen);
+}
+
+/*
+ *  Function to randomly generate errors in the codeword, a word at a time.
+ *
+ *  NOTE : flipProb is a fixed-point probability from getRngProb().
+ *         With flipRate 0.5, each random word is used as 64 error bits directly.
+ */
+void genErrorFast(uint8_t *data, size_t byteLen, Rng *rng, uint64_t flipProb)
+{
+    for (size_t byteIdx = 0; byteIdx < byteLen; byteIdx += sizeof(uint64_t)) {
+        size_t chunkLen = byteLen - byteIdx < sizeof(uint64_t) ? byteLen - byteIdx : sizeof(uint64_t);
+        orWord(&data[byteIdx], nextRngMask(rng, flipProb), chunkLen);
+    }
+}
+
+/*
+ *  Function to randomly generate a burst error (length <= 32) in the codeword, a word at a time.
+ *
+ *  NOTE : The burst is cut at byteLen, so a buffer shorter than CW_SIZE is never overrun.
+ */
+void genBurstErrorFast(uint8_t *data, size_t byteLen, Rng *rng, uint64_t flipProb)
+{
+    unsigned int startByteIdx = nextRng(rng) % DATA_SIZE + 1;
+    uint64_t error = nextRngMask(rng, flipProb);
+
+    if (startByteIdx < byteLen) {
+        size_t burstLen = byteLen - startByteIdx < CW_SIZE - DATA_SIZE ? byteLen - startByteIdx : CW_SIZE - DATA_SIZE;
+        orWord(&data[startByteIdx], error, burstLen);
+    }
+}
+
 /*
  *  Function to count the number of 1's in the data.
  */
@@ -154,6 +870,24 @@ unsigned int countOne(uint8_t *data, size_t byteLen)
     return errorCount;
 }
 
+/*
+ *  Function to count the number of 1's in the data with popcount.
+ */
+unsigned int countOneFast(const uint8_t *data, size_t byteLen)
+{
+    unsigned int errorCount = 0;
+    size_t byteIdx = 0;
+
+    for (; byteIdx + sizeof(uint64_t) <= byteLen; byteIdx += sizeof(uint64_t)) {
+        errorCount += __builtin_popcountll(loadWord(&data[byteIdx]));
+    }
+    for (; byteIdx < byteLen; ++byteIdx) {
+        errorCount += __builtin_popcount(data[byteIdx]);
+    }
+
+    return errorCount;
+}
+
 /*
  *  Function to perform bitwise XOR between arrays.
  *
@@ -205,4 +939,42 @@ unsigned int getBurstLen(uint8_t *data, size_t byteLen)
     // The burst length is the difference
     // between the positions of the leftmost 1 and the rightmost 1.
     return rightIdx - leftIdx + 1;
-}
\ No newline at end of file
+}
+/*
+ *  Function to get the burst length of an input error vector with clz/ctz.
+ *
+ *  NOTE : Zero words are skipped a word at a time, and the first/last '1' is
+ *         located within the boundary byte with a single clz/ctz.
+ */
+unsigned int getBurstLenFast(const uint8_t *data, size_t byteLen)
+{
+    size_t leftByte = 0;
+    size_t rightByte = byteLen;
+
+    // Find the first non-zero byte from the left.
+    while (leftByte + sizeof(uint64_t) <= byteLen && loadWord(&data[leftByte]) == 0) {
+        leftByte += sizeof(uint64_t);
+    }
+    while (leftByte < byteLen && data[leftByte] == 0x00) {
+        ++leftByte;
+    }
+
+    // No '1' found.
+    if (leftByte == byteLen) {
+        return 0;
+    }
+
+    // Find the first non-zero byte from the right.
+    while (rightByte >= leftByte + sizeof(uint64_t) && loadWord(&data[rightByte - sizeof(uint64_t)]) == 0) {
+        rightByte -= sizeof(uint64_t);
+    }
+    while (data[rightByte - 1] == 0x00) {
+        --rightByte;
+    }
+
+    // Bit position 0 is the MSB of the first byte.
+    unsigned int leftIdx = leftByte * BYTE + (__builtin_clz(data[leftByte]) - (32 - BYTE));
+    unsigned int rightIdx = (rightByte - 1) * BYTE + (BYTE - 1 - __builtin_ctz(data[rightByte - 1]));
+
+    return rightIdx - leftIdx + 1;
+}
@@ -1,14 +1,78 @@
 #ifndef __SIM_H__
 #define __SIM_H__
 
+#include "rng.h"
+#include "errmodel.h"
+
 #define NUM_ITER 10000000       // number of iterations for simulation
+#define CHUNK_SIZE 65536        // number of iterations per random number stream
+#define SIM_CONF_LEVEL 0.95     // default confidence level of intervals
+#define SIM_REL_ERR 0.1         // default target relative error of importance sampling
+#define SIM_MAX_ITER 1000000000 // default limit on the trials of importance sampling
+
+/*
+ *  Simulation settings given by program input arguments.
+ */
+typedef struct {
+    uint64_t numIter;           // number of iterations      (--iter N, limit with --is)
+    unsigned int numThreads;    // number of worker threads  (--threads N)
+    uint64_t seed;              // seed of random streams    (--seed S)
+    double flipRate;            // bit flip rate in an error (--flip-rate P)
+    bool refGen;                // use per-bit reference error generation (--ref)
+    ErrorModel model;           // error model               (--model NAME)         
+    double confLevel;           // confidence level          (--conf C)
+    bool importance;            // importance sampling until a target is met (--is)
+    double relErr;              // target relative error     (--rel-err E)
+    double bound;               // target upper bound        (--bound B)
+    unsigned int correctBurst;  // correct bursts up to L bits, 0 to detect only (--correct L)
+    bool bitSlice;              // bit-sliced engine, many trials per word (--bitslice)
+    unsigned int shardIdx;      // shard of this process      (--shard i/N)
+    unsigned int numShard;      // number of shards of the campaign
+    const char *checkpointPath; // checkpoint file, NULL for none (--checkpoint FILE)
+    double checkpointSec;       // interval of checkpoints    (--checkpoint-every S)
+    const char *resumePath;     // checkpoint to resume from  (--resume FILE)
+    const char *reportPath;     // JSON run report, NULL for none, "-" for stdout (--report FILE)
+    double progressSec;         // interval of progress lines, 0 for none (--progress S, profile builds)
+} SimConfig;
+
+/*
+ *  Simulation counters.
+ *
+ *  NOTE : Counters are only summed, so the merged result does not depend on
+ *         how iterations are distributed over threads.
+ */
+typedef struct {
+    uint64_t numIter;
+    uint64_t numError;          // trials with at least one flipped bit
+    uint64_t totDetError;
+    uint64_t totOddError;
+    uint64_t detOddError;
+    uint64_t totDoubleError;
+    uint64_t detDoubleError;
+    uint64_t totBurst32Error;
+    uint64_t detBurst32Error;
+    uint64_t numCorrected;      // detected errors fixed by the correction table
+    uint64_t numMiscorrected;   // detected errors turned into a different codeword
+} SimResult;
 
-void simulate(unsigned int numIter);
+void getSimConfig(int argc, char *argv[], SimConfig *config);
+void simulate(const SimConfig *config);
+void simulateChunk(const SimConfig *config, uint64_t chunkIdx, uint64_t numIter, SimResult *result);
+void mergeSimResult(SimResult *dst, const SimResult *src);
+void printSimResult(const SimResult *result, double confLevel);
+void printSimReport(const SimConfig *config, const SimResult *result);
+double getNormalQuantile(double prob);
+void getWilsonInterval(uint64_t numHit, uint64_t numTrial, double z, double *lower, double *upper);
+void encodeCRC(uint8_t *codeword, size_t dataLen);
 bool decodeCRC(uint8_t *data, size_t byteLen);
-void genError(uint8_t *data, size_t byteLen);
-void genBurstError(uint8_t *data, size_t byteLen);
+void genError(uint8_t *data, size_t byteLen, Rng *rng, double flipRate);
+void genBurstError(uint8_t *data, size_t byteLen, Rng *rng, double flipRate);
+void genErrorFast(uint8_t *data, size_t byteLen, Rng *rng, uint64_t flipProb);
+void genBurstErrorFast(uint8_t *data, size_t byteLen, Rng *rng, uint64_t flipProb);
 unsigned int countOne(uint8_t *data, size_t byteLen);
+unsigned int countOneFast(const uint8_t *data, size_t byteLen);
 void bitwiseXOR(uint8_t *data1, uint8_t *data2, size_t byteLen);
 unsigned int getBurstLen(uint8_t *data, size_t byteLen);
+unsigned int getBurstLenFast(const uint8_t *data, size_t byteLen);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,334 @@
+/*
+ *  Streaming batch encoder for captures of DRAM bursts.
+ *
+ *  The input is a binary file of back-to-back bursts. Each burst holds GROUP_SIZE
+ *  data streams of BL little-endian 32-bit words (DQ_SIZE bits per tick), in the
+ *  same order as data.txt. Each burst is serialized and encoded, and its checksum
+ *  is written to the output as a 4-byte big-endian record (or a hex line).
+ *
+ *    1) The input is memory-mapped and split into batches of bursts,
+ *       which are handed out to worker threads.
+ *    2) Each batch is processed in blocks that fit in L1: a block is serialized
+ *       first, then the CRC kernel runs over the serialized lines.
+ *       serialize() only moves whole bytes, so it is replayed as a precomputed
+ *       byte permutation (16-byte shuffles when SSSE3 is available).
+ *    3) Records have a fixed size, so the output is also memory-mapped and
+ *       every batch writes its checksums in place without ordering.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "crc32.h"
+#include "fold.h"
+#include "stream.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_X86_SHUFFLE 1
+#else
+#define HAVE_X86_SHUFFLE 0
+#endif
+
+#define SERIAL_BLOCK 64         // bursts serialized at a time (4KB of serialized data)
+#define NUM_VEC (DATA_SIZE / 16)  // 16-byte vectors of a burst
+
+typedef struct {
+    const StreamConfig *config;
+    const uint8_t *input;
+    uint8_t *output;
+    size_t numBurst;
+    size_t numBatch;
+    size_t nextBatch;           // shared work counter (atomic)
+} StreamContext;
+
+static const char hexDigit[] = "0123456789ABCDEF";
+
+// serialPerm[i] is the input byte that serialize() moves to serialized byte i.
+static uint8_t serialPerm[DATA_SIZE];
+
+// serialShuffle[o][i] picks the bytes of input vector i that go to output vector o (0x80 : none).
+static uint8_t serialShuffle[NUM_VEC][NUM_VEC][16] __attribute__((aligned(16)));
+
+static void serializeBurstPerm(const uint8_t *burst, uint8_t *serial);
+static void (*serializeBurst)(const uint8_t *burst, uint8_t *serial) = serializeBurstPerm;
+
+/*
+ *  Function to get streaming encoder settings from program input arguments.
+ */
+void getStreamConfig(int argc, char *argv[], StreamConfig *config)
+{
+    static char defaultOutPath[4096];
+
+    config->inPath = NULL;
+    config->outPath = NULL;
+    config->hexOutput = false;
+    config->batchSize = STREAM_BATCH;
+    config->numThreads = 1;
+
+    for (int argIdx = 2; argIdx < argc; ++argIdx) {
+        if (strcmp(argv[argIdx], "--hex") == 0) {
+            config->hexOutput = true;
+        }
+        else if (argIdx == argc - 1) {
+            break;  // remaining options take a value
+        }
+        else if (strcmp(argv[argIdx], "--in") == 0) {
+            config->inPath = argv[++argIdx];
+        }
+        else if (strcmp(argv[argIdx], "--out") == 0) {
+            config->outPath = argv[++argIdx];
+        }
+        else if (strcmp(argv[argIdx], "--batch") == 0) {
+            config->batchSize = (size_t)strtoull(argv[++argIdx], NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(argv[++argIdx], NULL, 0);
+        }
+    }
+
+    if (config->inPath == NULL) {
+        printf("Input file is required (--in FILE)\n");
+        exit(EXIT_FAILURE);
+    }
+    if (config->outPath == NULL) {
+        snprintf(defaultOutPath, sizeof(defaultOutPath), "%s.crc", config->inPath);
+        config->outPath = defaultOutPath;
+    }
+    if (config->batchSize == 0) {
+        config->batchSize = STREAM_BATCH;
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+}
+
+#if HAVE_X86_SHUFFLE
+
+/*
+ *  Function to serialize a burst with byte shuffles.
+ *  Each output vector gathers its bytes from all input vectors.
+ */
+__attribute__((target("ssse3")))
+static void serializeBurstShuffle(const uint8_t *burst, uint8_t *serial)
+{
+    __m128i input[NUM_VEC];
+
+    for (int vecIdx = 0; vecIdx < NUM_VEC; ++vecIdx) {
+        input[vecIdx] = _mm_loadu_si128((const __m128i *)(burst + 16 * vecIdx));
+    }
+
+    for (int outIdx = 0; outIdx < NUM_VEC; ++outIdx) {
+        __m128i output = _mm_setzero_si128();
+
+        for (int vecIdx = 0; vecIdx < NUM_VEC; ++vecIdx) {
+            __m128i mask = _mm_load_si128((const __m128i *)serialShuffle[outIdx][vecIdx]);
+            output = _mm_or_si128(output, _mm_shuffle_epi8(input[vecIdx], mask));
+        }
+
+        _mm_storeu_si128((__m128i *)(serial + 16 * outIdx), output);
+    }
+}
+
+#endif
+
+/*
+ *  Function to generate the byte permutation of serialize().
+ *
+ *  NOTE : serialize() only moves whole bytes of the little-endian input words,
+ *         so serializing a burst whose bytes hold their own offsets gives the source
+ *         offset of every serialized byte.
+ */
+void genSerialPerm()
+{
+    uint8_t burst[BURST_BYTES];
+    uint32_t dataStream[GROUP_SIZE][BL];
+
+    for (size_t byteIdx = 0; byteIdx < BURST_BYTES; ++byteIdx) {
+        burst[byteIdx] = (uint8_t)byteIdx;
+    }
+
+    memcpy(dataStream, burst, BURST_BYTES);
+    serialize(dataStream, serialPerm, DQ_SIZE, GROUP_SIZE);
+
+    memset(serialShuffle, 0x80, sizeof(serialShuffle));
+    for (size_t byteIdx = 0; byteIdx < DATA_SIZE; ++byteIdx) {
+        serialShuffle[byteIdx / 16][serialPerm[byteIdx] / 16][byteIdx % 16] = serialPerm[byteIdx] % 16;
+    }
+
+#if HAVE_X86_SHUFFLE
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) {
+        serializeBurst = serializeBurstShuffle;
+    }
+#endif
+}
+
+/*
+ *  Function to serialize a burst with the byte permutation of serialize().
+ */
+static void serializeBurstPerm(const uint8_t *burst, uint8_t *serial)
+{
+    for (size_t byteIdx = 0; byteIdx < DATA_SIZE; ++byteIdx) {
+        serial[byteIdx] = burst[serialPerm[byteIdx]];
+    }
+}
+
+/*
+ *  Function to write a checksum record to the output.
+ */
+static inline void writeRecord(uint8_t *output, uint32_t checksum, bool hexOutput)
+{
+    if (hexOutput) {
+        for (int nibble = 0; nibble < 8; ++nibble) {
+            output[nibble] = hexDigit[(checksum >> (28 - 4 * nibble)) & 0xF];
+        }
+        output[8] = '\n';
+    }
+    else {
+        output[0] = (uint8_t)(checksum >> 24);
+        output[1] = (uint8_t)(checksum >> 16);
+        output[2] = (uint8_t)(checksum >> 8);
+        output[3] = (uint8_t)checksum;
+    }
+}
+
+/*
+ *  Function to serialize and encode consecutive bursts, and write their checksum records.
+ */
+void encodeBatch(const uint8_t *bursts, size_t numBurst, uint8_t *output, bool hexOutput)
+{
+    uint8_t serial[SERIAL_BLOCK][DATA_SIZE];
+    size_t recordSize = hexOutput ? HEX_RECORD : sizeof(uint32_t);
+
+    for (size_t blockIdx = 0; blockIdx < numBurst; blockIdx += SERIAL_BLOCK) {
+        size_t blockLen = (numBurst - blockIdx < SERIAL_BLOCK) ? numBurst - blockIdx : SERIAL_BLOCK;
+
+        // Stage 1 : serialize the block.
+        for (size_t burstIdx = 0; burstIdx < blockLen; ++burstIdx) {
+            serializeBurst(bursts + (blockIdx + burstIdx) * BURST_BYTES, serial[burstIdx]);
+        }
+
+        // Stage 2 : encode the serialized lines.
+        for (size_t burstIdx = 0; burstIdx < blockLen; ++burstIdx) {
+            uint32_t checksum = finalizeCRC(CRCUpdate(INIT_VAL, serial[burstIdx], DATA_SIZE));
+            writeRecord(output + (blockIdx + burstIdx) * recordSize, checksum, hexOutput);
+        }
+    }
+}
+
+/*
+ *  Worker thread function. Batches are taken from the shared counter.
+ */
+static void *streamWorker(void *arg)
+{
+    StreamContext *context = (StreamContext *)arg;
+    size_t batchSize = context->config->batchSize;
+    size_t recordSize = context->config->hexOutput ? HEX_RECORD : sizeof(uint32_t);
+
+    while (true) {
+        size_t batchIdx = __atomic_fetch_add(&context->nextBatch, 1, __ATOMIC_RELAXED);
+        if (batchIdx >= context->numBatch) {
+            break;
+        }
+
+        size_t firstBurst = batchIdx * batchSize;
+        size_t numBurst = (context->numBurst - firstBurst < batchSize) ? context->numBurst - firstBurst : batchSize;
+
+        encodeBatch(context->input + firstBurst * BURST_BYTES, numBurst,
+            context->output + firstBurst * recordSize, context->config->hexOutput);
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to encode all bursts of the input file into the checksum stream.
+ */
+void encodeStream(const StreamConfig *config)
+{
+    struct stat inputStat;
+    struct timespec startTime, endTime;
+    size_t recordSize = config->hexOutput ? HEX_RECORD : sizeof(uint32_t);
+
+    genSerialPerm();
+
+    int inputFd = open(config->inPath, O_RDONLY);
+    if (inputFd < 0 || fstat(inputFd, &inputStat) != 0) {
+        printf("Unable to open %s\n", config->inPath);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t numBurst = (size_t)inputStat.st_size / BURST_BYTES;
+    if ((size_t)inputStat.st_size % BURST_BYTES != 0) {
+        printf("Ignoring %zu trailing bytes of a partial burst\n", (size_t)inputStat.st_size % BURST_BYTES);
+    }
+
+    int outputFd = open(config->outPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (outputFd < 0 || ftruncate(outputFd, (off_t)(numBurst * recordSize)) != 0) {
+        printf("Unable to create %s\n", config->outPath);
+        exit(EXIT_FAILURE);
+    }
+
+    StreamContext context = { config, NULL, NULL, numBurst, (numBurst + config->batchSize - 1) / config->batchSize, 0 };
+    pthread_t *threads = (pthread_t *)calloc(config->numThreads, sizeof(pthread_t));
+
+    if (threads == NULL) {
+        printf("Unable to allocate %u workers\n", config->numThreads);
+        exit(EXIT_FAILURE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    if (numBurst > 0) {
+        void *input = mmap(NULL, numBurst * BURST_BYTES, PROT_READ, MAP_PRIVATE, inputFd, 0);
+        void *output = mmap(NULL, numBurst * recordSize, PROT_READ | PROT_WRITE, MAP_SHARED, outputFd, 0);
+
+        if (input == MAP_FAILED || output == MAP_FAILED) {
+            printf("Unable to map %s or %s\n", config->inPath, config->outPath);
+            exit(EXIT_FAILURE);
+        }
+        madvise(input, numBurst * BURST_BYTES, MADV_SEQUENTIAL);
+        madvise(input, numBurst * BURST_BYTES, MADV_WILLNEED);
+
+        context.input = (const uint8_t *)input;
+        context.output = (uint8_t *)output;
+
+        for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+            if (pthread_create(&threads[threadIdx], NULL, streamWorker, &context) != 0) {
+                printf("Unable to create thread %u\n", threadIdx);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+            pthread_join(threads[threadIdx], NULL);
+        }
+
+        munmap(output, numBurst * recordSize);
+        munmap(input, numBurst * BURST_BYTES);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    close(outputFd);
+    close(inputFd);
+
+    double elapsed = (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) * 1e-9;
+
+    printf("##### Stream Result #####\n");
+    printf("Input  : %s (%zu bursts, %zu bytes)\n", config->inPath, numBurst, numBurst * BURST_BYTES);
+    printf("Output : %s (%s, %zu bytes)\n", config->outPath, config->hexOutput ? "hex" : "binary", numBurst * recordSize);
+    printf("Kernel : %s, Threads : %u, Batch : %zu bursts\n",
+        getKernelName(CRCUpdate == updateCRCClmul ? KERNEL_CLMUL : KERNEL_SLICE16), config->numThreads, config->batchSize);
+    printf("Time   : %.3f s (%.2f GB/s)\n", elapsed, elapsed > 0 ? numBurst * BURST_BYTES / elapsed * 1e-9 : 0.0);
+
+    free(threads);
+}
@@ -0,0 +1,25 @@
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+#define BURST_WORDS (GROUP_SIZE * BL)               // words of a burst in the input file
+#define BURST_BYTES (BURST_WORDS * sizeof(uint32_t))  // size of a burst in the input file
+#define STREAM_BATCH 16384      // default number of bursts per batch
+#define HEX_RECORD 9            // size of a hex checksum record ("XXXXXXXX\n")
+
+/*
+ *  Streaming encoder settings given by program input arguments.
+ */
+typedef struct {
+    const char *inPath;         // binary file of back-to-back bursts   (--in FILE)
+    const char *outPath;        // checksum stream (default: FILE.crc)  (--out FILE)
+    bool hexOutput;             // write hex lines instead of binary    (--hex)
+    size_t batchSize;           // number of bursts per batch           (--batch N)
+    unsigned int numThreads;    // number of worker threads             (--threads N)
+} StreamConfig;
+
+void getStreamConfig(int argc, char *argv[], StreamConfig *config);
+void encodeStream(const StreamConfig *config);
+void genSerialPerm();
+void encodeBatch(const uint8_t *bursts, size_t numBurst, uint8_t *output, bool hexOutput);
+
+#endif
@@ -0,0 +1,496 @@
+/*
+ *  Bit error rate sweep with common random numbers.
+ *
+ *  Every trial draws one uniform number u_i per bit position of its error region,
+ *  and bit i flips at a bit error rate p if u_i < p. All rates of the list are
+ *  evaluated on the same draws, so the error of a lower rate is a subset of the
+ *  error of a higher rate, and the curves are smooth and monotonic in the error
+ *  count without running the simulation once per rate.
+ *
+ *    1) Only the bits with u_i below the highest rate matter. Each goes to the
+ *       bucket of the lowest rate it flips at, and its syndrome (synTable) is
+ *       XORed into that bucket.
+ *    2) A prefix XOR over the buckets gives the syndrome of every rate, and the
+ *       prefix sums and min/max positions give its weight and burst length.
+ *
+ *  NOTE : Uniform numbers are 32-bit fixed point. Only their conditional law is
+ *         drawn: candidate bits flip at 2^-m, the lowest power of two not below
+ *         the highest rate (m random words per 64 bits), and each candidate gets
+ *         u_i uniform below 2^-m. If the highest rate is below SWEEP_SKIP_BER, the
+ *         bits below it are found by geometric skips instead.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "crc32.h"
+#include "syndrome.h"
+#include "sim.h"
+#include "sweep.h"
+
+/*
+ *  Error bits of a trial that flip from a bit error rate on.
+ */
+typedef struct {
+    uint32_t syndrome;
+    unsigned int numBit;
+    unsigned int firstPos;
+    unsigned int lastPos;
+} SweepBucket;
+
+typedef struct {
+    const SweepConfig *config;
+    unsigned int threadIdx;
+    SweepCounter counters[MAX_SWEEP_POINTS];
+} __attribute__((aligned(64))) SweepWorker;
+
+/*
+ *  Draw settings of a sweep, derived from the bit error rates.
+ */
+typedef struct {
+    unsigned int numPoint;
+    uint64_t thresholds[MAX_SWEEP_POINTS];  // 32-bit fixed-point rates: bit flips at rate k if u < thresholds[k]
+    unsigned int candidateBits;             // m: candidate bits flip at 2^-m >= the highest rate
+    uint64_t candidateProb;                 // 2^-m as a probability of nextRngMask()
+    bool skip;                              // geometric skips instead of candidate masks
+    double invLogKeep;                      // 1 / log(1 - p) of the highest rate
+    unsigned int lookupShift;
+    uint8_t lookup[SWEEP_LOOKUP_SIZE];      // lowest bucket of u >> lookupShift
+} SweepDraw;
+
+/*
+ *  Function to append a bit error rate to the sweep list, keeping it ascending.
+ */
+static void addSweepBer(SweepConfig *config, double ber)
+{
+    unsigned int pointIdx = config->numPoint;
+
+    if (!(ber >= 1.0 / 4294967296.0 && ber <= 0.5)) {
+        printf("Bit error rates must satisfy 2^-32 <= ber <= 0.5: %g\n", ber);
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int prevIdx = 0; prevIdx < config->numPoint; ++prevIdx) {
+        if (config->bers[prevIdx] == ber) {
+            return;  // repeated rate
+        }
+    }
+    if (config->numPoint == MAX_SWEEP_POINTS) {
+        printf("Too many bit error rates (limit : %d)\n", MAX_SWEEP_POINTS);
+        exit(EXIT_FAILURE);
+    }
+
+    for (; pointIdx > 0 && config->bers[pointIdx - 1] > ber; --pointIdx) {
+        config->bers[pointIdx] = config->bers[pointIdx - 1];
+    }
+
+    config->bers[pointIdx] = ber;
+    config->numPoint++;
+}
+
+/*
+ *  Function to get sweep settings from program input arguments.
+ */
+void getSweepConfig(int argc, char *argv[], SweepConfig *config)
+{
+    config->numPoint = 0;
+    config->numIter = NUM_ITER;
+    config->numThreads = 1;
+    config->seed = (uint64_t)time(NULL);
+    config->model = ERROR_RANDOM;
+    config->confLevel = SIM_CONF_LEVEL;
+    config->outPath = NULL;
+
+    for (int argIdx = 2; argIdx < argc; ++argIdx) {
+        if (strcmp(argv[argIdx], "--ber") == 0) {
+            // Comma-separated list of bit error rates.
+            char *cursor = getOptionValue(argc, argv, &argIdx);
+            while (*cursor != '\0') {
+                addSweepBer(config, strtod(cursor, &cursor));
+                if (*cursor == ',') {
+                    ++cursor;
+                }
+                else if (*cursor != '\0') {
+                    printf("Invalid bit error rate list: %s\n", argv[argIdx]);
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+        else if (strcmp(argv[argIdx], "--iter") == 0) {
+            config->numIter = strtoull(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--threads") == 0) {
+            config->numThreads = (unsigned int)strtoul(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--seed") == 0) {
+            config->seed = strtoull(getOptionValue(argc, argv, &argIdx), NULL, 0);
+        }
+        else if (strcmp(argv[argIdx], "--model") == 0) {
+            const char *name = getOptionValue(argc, argv, &argIdx);
+            config->model = getErrorModel(name);
+            if (config->model == NUM_ERROR_MODELS) {
+                printf("Unknown error model: %s\n", name);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[argIdx], "--conf") == 0) {
+            config->confLevel = strtod(getOptionValue(argc, argv, &argIdx), NULL);
+        }
+        else if (strcmp(argv[argIdx], "--out") == 0) {
+            config->outPath = getOptionValue(argc, argv, &argIdx);
+        }
+        else {
+            exitUnknownOption(argv, argIdx);
+        }
+    }
+
+    // Log-spaced default list.
+    if (config->numPoint == 0) {
+        for (unsigned int pointIdx = 0; pointIdx < SWEEP_POINTS; ++pointIdx) {
+            addSweepBer(config, SWEEP_BER_FROM * pow(SWEEP_BER_TO / SWEEP_BER_FROM,
+                (double)pointIdx / (SWEEP_POINTS - 1)));
+        }
+    }
+    if (config->model == ERROR_ADJ_PIN) {
+        printf("The sweep does not support the %s model (its bits do not flip independently)\n",
+            getErrorModelName(config->model));
+        exit(EXIT_FAILURE);
+    }
+    if (config->numThreads == 0) {
+        config->numThreads = 1;
+    }
+    if (config->confLevel <= 0.0 || config->confLevel >= 1.0) {
+        printf("Confidence level must be in (0, 1): %g\n", config->confLevel);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*
+ *  Function to prepare the draws of a sweep: fixed-point thresholds, candidate rate and bucket lookup.
+ */
+static void initSweepDraw(const SweepConfig *config, SweepDraw *draw)
+{
+    unsigned int numPoint = config->numPoint;
+
+    draw->numPoint = numPoint;
+    for (unsigned int pointIdx = 0; pointIdx < numPoint; ++pointIdx) {
+        draw->thresholds[pointIdx] = (uint64_t)llround(config->bers[pointIdx] * 4294967296.0);
+    }
+
+    // Candidates flip at 2^-m, the lowest power of two not below the highest rate.
+    // m stops at 31, so a rate near 2^-32 (threshold 1) keeps u in {0, 1}.
+    uint64_t maxThreshold = draw->thresholds[numPoint - 1];
+    draw->candidateBits = 0;
+    while (draw->candidateBits < 31 && ((uint64_t)1 << (31 - draw->candidateBits)) >= maxThreshold) {
+        draw->candidateBits++;
+    }
+    draw->candidateProb = (uint64_t)1 << (64 - draw->candidateBits);
+
+    draw->skip = config->bers[numPoint - 1] < SWEEP_SKIP_BER;
+    draw->invLogKeep = 1.0 / log1p(-config->bers[numPoint - 1]);
+
+    // Every u is below 2^(32 - m), so its top SWEEP_LOOKUP_BITS bits index the lookup.
+    unsigned int uBits = 32 - draw->candidateBits;
+    draw->lookupShift = uBits > SWEEP_LOOKUP_BITS ? uBits - SWEEP_LOOKUP_BITS : 0;
+
+    for (uint64_t cell = 0; cell < SWEEP_LOOKUP_SIZE; ++cell) {
+        unsigned int pointIdx = 0;
+
+        while (pointIdx < numPoint && (cell << draw->lookupShift) >= draw->thresholds[pointIdx]) {
+            pointIdx++;
+        }
+        draw->lookup[cell] = (uint8_t)pointIdx;
+    }
+}
+
+/*
+ *  Function to add an error bit to the bucket of the lowest rate whose threshold is above u.
+ *  A bit with u above the highest threshold goes to the discarded bucket numPoint.
+ */
+static inline void addSweepBit(SweepBucket *buckets, const SweepDraw *draw, uint64_t u, unsigned int pos)
+{
+    unsigned int pointIdx = draw->lookup[u >> draw->lookupShift];
+
+    while (pointIdx < draw->numPoint && u >= draw->thresholds[pointIdx]) {
+        pointIdx++;
+    }
+
+    SweepBucket *bucket = &buckets[pointIdx];
+    bucket->syndrome ^= synTable.bitSyndrome[pos];
+    bucket->numBit++;
+    bucket->firstPos = pos < bucket->firstPos ? pos : bucket->firstPos;
+    bucket->lastPos = pos > bucket->lastPos ? pos : bucket->lastPos;
+}
+
+/*
+ *  Function to run a chunk of trials on every bit error rate.
+ *
+ *  NOTE : Every chunk has its own random stream seeded by (seed, chunkIdx), as in simulateChunk().
+ *         For a DRAM fault model, genFaultCache() must be called before use.
+ */
+void sweepChunk(const SweepConfig *config, uint64_t chunkIdx, uint64_t numIter, SweepCounter *counters)
+{
+    Rng rng;
+    seedRng(&rng, config->seed, chunkIdx);
+
+    SweepDraw draw;
+    initSweepDraw(config, &draw);
+
+    unsigned int numPoint = draw.numPoint;
+    uint64_t maxThreshold = draw.thresholds[numPoint - 1];
+    SweepBucket buckets[MAX_SWEEP_POINTS + 1];
+
+    for (uint64_t i = 0; i < numIter; ++i) {
+        // Error region of the trial: positions[idx], or firstPos + idx.
+        const unsigned int *positions = NULL;
+        unsigned int firstPos = 0;
+        unsigned int regionLen;
+
+        switch (config->model) {
+            case ERROR_RANDOM : {
+                regionLen = CW_BITS;
+                break;
+            }
+            case ERROR_BURST : {
+                firstPos = (unsigned int)(nextRng(&rng) % DATA_SIZE + 1) * BYTE;  // as genBurstError()
+                regionLen = CHECK_SIZE * BYTE;
+                break;
+            }
+            default : {
+                unsigned int regionIdx = nextRng(&rng) % faultCache.numRegion;
+                positions = &faultCache.positions[regionIdx * faultCache.regionLen];
+                regionLen = faultCache.regionLen;
+                break;
+            }
+        }
+
+        // The discarded bucket numPoint is reset as well, as addSweepBit() writes to it without a branch.
+        for (unsigned int pointIdx = 0; pointIdx <= numPoint; ++pointIdx) {
+            buckets[pointIdx] = (SweepBucket){ 0, 0, CW_BITS, 0 };
+        }
+
+        if (draw.skip) {
+            // Bits below the highest rate, found by geometric gaps, with u_i uniform below it.
+            for (unsigned int idx = 0; ; ++idx) {
+                double uniform = (double)((nextRng(&rng) >> 11) + 1) * (1.0 / 9007199254740992.0);  // (0, 1]
+                double gap = log(uniform) * draw.invLogKeep;  // log(U) / log(1 - p)
+
+                if (gap >= (double)(regionLen - idx)) {
+                    break;
+                }
+                idx += (unsigned int)gap;
+
+                uint64_t u = ((nextRng(&rng) >> 32) * maxThreshold) >> 32;
+                addSweepBit(buckets, &draw, u, positions ? positions[idx] : firstPos + idx);
+            }
+        }
+        else {
+            // Candidate bits flip at 2^-m, a word at a time, with u_i uniform below 2^-m.
+            uint64_t random = 0;
+            bool spare = false;
+
+            for (unsigned int wordIdx = 0; wordIdx * 64 < regionLen; ++wordIdx) {
+                uint64_t mask = nextRngMask(&rng, draw.candidateProb);
+
+                if (regionLen - wordIdx * 64 < 64) {
+                    mask &= ((uint64_t)1 << (regionLen - wordIdx * 64)) - 1;
+                }
+
+                for (; mask != 0; mask &= mask - 1) {
+                    unsigned int idx = wordIdx * 64 + __builtin_ctzll(mask);
+                    uint64_t u;
+
+                    // Two 32-bit uniform numbers per random word.
+                    if (spare) {
+                        u = (random & 0xFFFFFFFF) >> draw.candidateBits;
+                    }
+                    else {
+                        random = nextRng(&rng);
+                        u = (random >> 32) >> draw.candidateBits;
+                    }
+                    spare = !spare;
+
+                    addSweepBit(buckets, &draw, u, positions ? positions[idx] : firstPos + idx);
+                }
+            }
+        }
+
+        // The error of each rate is the union of the buckets up to it.
+        uint32_t syndrome = 0;
+        unsigned int errorCount = 0;
+        unsigned int firstErr = CW_BITS;
+        unsigned int lastErr = 0;
+
+        for (unsigned int pointIdx = 0; pointIdx < numPoint; ++pointIdx) {
+            const SweepBucket *bucket = &buckets[pointIdx];
+            SweepCounter *counter = &counters[pointIdx];
+
+            syndrome ^= bucket->syndrome;
+            errorCount += bucket->numBit;
+            firstErr = bucket->firstPos < firstErr ? bucket->firstPos : firstErr;
+            lastErr = bucket->lastPos > lastErr ? bucket->lastPos : lastErr;
+
+            if (errorCount == 0) {
+                continue;
+            }
+
+            bool detected = syndrome != 0;
+
+            counter->numError++;
+            counter->numDetected += detected;
+            counter->numWeight += errorCount;
+
+            if (errorCount % 2) {
+                counter->totOddError++;
+                counter->detOddError += detected;
+            }
+            if (errorCount == 2) {
+                counter->totDoubleError++;
+                counter->detDoubleError += detected;
+            }
+            if (lastErr - firstErr + 1 <= 32) {
+                counter->totBurst32Error++;
+                counter->detBurst32Error += detected;
+            }
+        }
+    }
+}
+
+/*
+ *  Worker thread function. Chunks are distributed round-robin over workers.
+ */
+static void *sweepWorker(void *arg)
+{
+    SweepWorker *worker = (SweepWorker *)arg;
+    const SweepConfig *config = worker->config;
+    uint64_t numChunk = (config->numIter + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    for (uint64_t chunkIdx = worker->threadIdx; chunkIdx < numChunk; chunkIdx += config->numThreads) {
+        uint64_t firstIter = chunkIdx * CHUNK_SIZE;
+        uint64_t numIter = config->numIter - firstIter < CHUNK_SIZE ? config->numIter - firstIter : CHUNK_SIZE;
+
+        sweepChunk(config, chunkIdx, numIter, worker->counters);
+    }
+
+    return NULL;
+}
+
+/*
+ *  Function to print the curves of a sweep as CSV, one line per bit error rate.
+ */
+static void printSweepCSV(FILE *out, const SweepConfig *config, const SweepCounter *counters, double elapsed)
+{
+    double z = getNormalQuantile(0.5 + config->confLevel / 2);
+
+    fprintf(out, "# seed=%llu, model=%s, iter=%llu, threads=%u, conf=%g, draw=%s, sec=%.3f\n",
+        (unsigned long long)config->seed, getErrorModelName(config->model), (unsigned long long)config->numIter,
+        config->numThreads, config->confLevel, config->bers[config->numPoint - 1] < SWEEP_SKIP_BER ? "skip" : "mask",
+        elapsed);
+    fprintf(out, "ber,iter,error,detected,undetected,p_undetected,p_undetected_lo,p_undetected_hi,"
+        "detect_ratio,odd_total,odd_detected,double_total,double_detected,burst32_total,burst32_detected,mean_weight\n");
+
+    for (unsigned int pointIdx = 0; pointIdx < config->numPoint; ++pointIdx) {
+        const SweepCounter *counter = &counters[pointIdx];
+        uint64_t numUndetected = counter->numError - counter->numDetected;
+        double lower, upper;
+
+        getWilsonInterval(numUndetected, config->numIter, z, &lower, &upper);
+        fprintf(out, "%.6e,%llu,%llu,%llu,%llu,%.6e,%.6e,%.6e,%.9f,%llu,%llu,%llu,%llu,%llu,%llu,%.6f\n",
+            config->bers[pointIdx], (unsigned long long)config->numIter,
+            (unsigned long long)counter->numError, (unsigned long long)counter->numDetected,
+            (unsigned long long)numUndetected, config->numIter ? (double)numUndetected / config->numIter : 0.0,
+            lower, upper, counter->numError ? (double)counter->numDetected / counter->numError : 1.0,
+            (unsigned long long)counter->totOddError, (unsigned long long)counter->detOddError,
+            (unsigned long long)counter->totDoubleError, (unsigned long long)counter->detDoubleError,
+            (unsigned long long)counter->totBurst32Error, (unsigned long long)counter->detBurst32Error,
+            config->numIter ? (double)counter->numWeight / config->numIter : 0.0);
+    }
+}
+
+/*
+ *  Function to sweep the bit error rates and write the curves as CSV.
+ *
+ *  NOTE : For a fixed seed, the result is identical for any number of threads.
+ */
+void sweep(const SweepConfig *config)
+{
+    SweepWorker *workers = (SweepWorker *)aligned_alloc(64, config->numThreads * sizeof(SweepWorker));
+    pthread_t *threads = (pthread_t *)calloc(config->numThreads, sizeof(pthread_t));
+    SweepCounter total[MAX_SWEEP_POINTS] = {0};
+    struct timespec startTime, endTime;
+
+    if (workers == NULL || threads == NULL) {
+        printf("Unable to allocate %u workers\n", config->numThreads);
+        exit(EXIT_FAILURE);
+    }
+
+    if (isFaultModel(config->model)) {
+        genFaultCache(&faultCache, config->model);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        memset(&workers[threadIdx], 0, sizeof(SweepWorker));
+        workers[threadIdx].config = config;
+        workers[threadIdx].threadIdx = threadIdx;
+
+        if (pthread_create(&threads[threadIdx], NULL, sweepWorker, &workers[threadIdx]) != 0) {
+            printf("Unable to create thread %u\n", threadIdx);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Merge per-thread counters after all workers are done.
+    for (unsigned int threadIdx = 0; threadIdx < config->numThreads; ++threadIdx) {
+        pthread_join(threads[threadIdx], NULL);
+
+        for (unsigned int pointIdx = 0; pointIdx < config->numPoint; ++pointIdx) {
+            const SweepCounter *src = &workers[threadIdx].counters[pointIdx];
+            SweepCounter *dst = &total[pointIdx];
+
+            dst->numError += src->numError;
+            dst->numDetected += src->numDetected;
+            dst->numWeight += src->numWeight;
+            dst->totOddError += src->totOddError;
+            dst->detOddError += src->detOddError;
+            dst->totDoubleError += src->totDoubleError;
+            dst->detDoubleError += src->detDoubleError;
+            dst->totBurst32Error += src->totBurst32Error;
+            dst->detBurst32Error += src->detBurst32Error;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+    double elapsed = (double)(endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) * 1e-9;
+
+    FILE *out = stdout;
+    if (config->outPath != NULL) {
+        out = fopen(config->outPath, "w");
+        if (out == NULL) {
+            printf("Unable to open the output file: %s\n", config->outPath);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printSweepCSV(out, config, total, elapsed);
+
+    if (out != stdout) {
+        fclose(out);
+        printf("Seed : %llu, Threads : %u, Model : %s\n", (unsigned long long)config->seed, config->numThreads,
+            getErrorModelName(config->model));
+        printf("%u bit error rates x %llu trials in %.3f s (%.2f M trials/s), written to %s\n", config->numPoint,
+            (unsigned long long)config->numIter, elapsed, config->numIter / elapsed * 1e-6, config->outPath);
+    }
+
+    if (isFaultModel(config->model)) {
+        freeFaultCache(&faultCache);
+    }
+
+    free(threads);
+    free(workers);
+}
@@ -0,0 +1,50 @@
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include "errmodel.h"
+
+#define SWEEP_BER_FROM 1e-4         // lowest bit error rate of the default list
+#define SWEEP_BER_TO 0.5            // highest bit error rate of the default list
+#define SWEEP_POINTS 16             // number of bit error rates of the default list (log-spaced)
+#define MAX_SWEEP_POINTS 64         // limit of the bit error rate list
+#define SWEEP_SKIP_BER 0.015625     // below this highest rate (2^-6), error bits are drawn by geometric skips
+#define SWEEP_LOOKUP_BITS 10        // top bits of a uniform number indexing the bucket lookup
+#define SWEEP_LOOKUP_SIZE (1 << SWEEP_LOOKUP_BITS)
+
+/*
+ *  Sweep settings given by program input arguments.
+ */
+typedef struct {
+    double bers[MAX_SWEEP_POINTS];  // bit error rates, ascending    (--ber P1,P2,...)
+    unsigned int numPoint;          // number of bit error rates
+    uint64_t numIter;               // number of trials              (--iter N)
+    unsigned int numThreads;        // number of worker threads      (--threads N)
+    uint64_t seed;                  // seed of random streams        (--seed S)
+    ErrorModel model;               // error model                   (--model NAME)
+    double confLevel;               // confidence level of intervals (--conf C)
+    const char *outPath;            // CSV file, NULL for stdout     (--out FILE)
+} SweepConfig;
+
+/*
+ *  Counters of a bit error rate of the sweep.
+ *
+ *  NOTE : Counters are only summed, so the merged result does not depend on
+ *         how trials are distributed over threads.
+ */
+typedef struct {
+    uint64_t numError;          // trials with at least one flipped bit
+    uint64_t numDetected;       // trials with a non-zero syndrome
+    uint64_t numWeight;         // flipped bits of all trials
+    uint64_t totOddError;
+    uint64_t detOddError;
+    uint64_t totDoubleError;
+    uint64_t detDoubleError;
+    uint64_t totBurst32Error;
+    uint64_t detBurst32Error;
+} SweepCounter;
+
+void getSweepConfig(int argc, char *argv[], SweepConfig *config);
+void sweep(const SweepConfig *config);
+void sweepChunk(const SweepConfig *config, uint64_t chunkIdx, uint64_t numIter, SweepCounter *counters);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ *  Linear syndrome engine for error evaluation.
+ *
+ *  The syndrome of every bit position in the codeword is precomputed, so an error
+ *  vector is evaluated by XORing the syndromes of its set bits (or set bytes)
+ *  instead of running a CRC over the whole codeword.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "syndrome.h"
+
+SyndromeTable synTable;
+
+/*
+ *  Function to generate syndrome tables for the given polynomial.
+ *
+ *  NOTE : A data bit at position 'pos' contributes x^(n - 1 - pos) * x^32 mod P
+ *         to the CRC, where n is the number of data bits. Starting from the last
+ *         data bit (x^32 mod P = poly), each preceding bit is one more shift.
+ *         A checksum bit flips the corresponding bit of the received checksum.
+ */
+void genSyndromeTable(SyndromeTable *table, uint32_t poly)
+{
+    uint32_t remainder = poly;  // x^32 mod P
+
+    table->poly = poly;
+
+    for (int pos = DATA_SIZE * BYTE - 1; pos >= 0; --pos) {
+        table->bitSyndrome[pos] = REFLECT ? reflect(remainder) : remainder;
+
+        if (remainder & 0x80000000) {
+            remainder = (remainder << 1) ^ poly;
+        }
+        else {
+            remainder <<= 1;
+        }
+    }
+
+    for (unsigned int pos = DATA_SIZE * BYTE; pos < CW_BITS; ++pos) {
+        table->bitSyndrome[pos] = (uint32_t)0x80000000 >> (pos - DATA_SIZE * BYTE);
+    }
+
+    // Byte syndromes are built from the lowest set bit: bit 'b' of a byte is position 7 - b.
+    for (unsigned int byteIdx = 0; byteIdx < CW_SIZE; ++byteIdx) {
+        table->byteSyndrome[byteIdx][0] = 0;
+
+        for (unsigned int byteValue = 1; byteValue < TABLE_SIZE; ++byteValue) {
+            unsigned int lowBit = __builtin_ctz(byteValue);
+            unsigned int pos = byteIdx * BYTE + (BYTE - 1 - lowBit);
+
+            table->byteSyndrome[byteIdx][byteValue] =
+                table->byteSyndrome[byteIdx][byteValue & (byteValue - 1)] ^ table->bitSyndrome[pos];
+        }
+    }
+}
+
+/*
+ *  Function to get the syndrome of an error vector, a byte at a time.
+ *
+ *  NOTE : All-zero words are skipped, so the cost is O(number of non-zero bytes).
+ *         A zero syndrome means the error is not detected.
+ */
+uint32_t getSyndrome(const SyndromeTable *table, const uint8_t *error, size_t byteLen)
+{
+    uint32_t syndrome = 0;
+    size_t byteIdx = 0;
+
+    for (; byteIdx + sizeof(uint64_t) <= byteLen; byteIdx += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &error[byteIdx], sizeof(word));
+
+        if (word == 0) {
+            continue;
+        }
+
+        for (size_t i = byteIdx; i < byteIdx + sizeof(uint64_t); ++i) {
+            syndrome ^= table->byteSyndrome[i][error[i]];
+        }
+    }
+
+    for (; byteIdx < byteLen; ++byteIdx) {
+        syndrome ^= table->byteSyndrome[byteIdx][error[byteIdx]];
+    }
+
+    return syndrome;
+}
+
+/*
+ *  Function to get the syndrome of an error vector, a bit at a time.
+ *
+ *  NOTE : Words are read MSB-first, and only set bits are visited with clz,
+ *         so the cost is O(weight) for sparse errors.
+ */
+uint32_t getSyndromeSparse(const SyndromeTable *table, const uint8_t *error, size_t byteLen)
+{
+    uint32_t syndrome = 0;
+    size_t byteIdx = 0;
+
+    for (; byteIdx + sizeof(uint64_t) <= byteLen; byteIdx += sizeof(uint64_t)) {
+        uint64_t word = ((uint64_t)loadBE32(&error[byteIdx]) << 32) | loadBE32(&error[byteIdx + 4]);
+
+        while (word) {
+            unsigned int leadIdx = __builtin_clzll(word);
+            syndrome ^= table->bitSyndrome[byteIdx * BYTE + leadIdx];
+            word &= ~((uint64_t)0x8000000000000000 >> leadIdx);
+        }
+    }
+
+    for (; byteIdx < byteLen; ++byteIdx) {
+        syndrome ^= table->byteSyndrome[byteIdx][error[byteIdx]];
+    }
+
+    return syndrome;
+}
@@ -0,0 +1,30 @@
+#ifndef __SYNDROME_H__
+#define __SYNDROME_H__
+
+#define CW_BITS (CW_SIZE * BYTE)                // number of bits in a codeword
+#define CHECK_SIZE (CW_SIZE - DATA_SIZE)        // size of checksum in bytes
+
+/*
+ *  Syndrome tables of a CRC32 code over a CW_SIZE codeword (data + checksum).
+ *
+ *  NOTE : The syndrome of a received codeword is calcCRC(data) ^ checksum.
+ *         CRC is linear, so the syndrome of an error vector is the XOR of the
+ *         syndromes of its bits, regardless of the transmitted data.
+ *         This is the same idea as CRC_COEFF_TABLE in the table-based RTL:
+ *         bit i of bitSyndrome[pos] is the coefficient of bit 'pos' in row i.
+ *
+ *         Bit position 0 is the MSB of byte 0 of the codeword.
+ */
+typedef struct {
+    uint32_t poly;                                  // generator polynomial (x^32 term ignored)
+    uint32_t bitSyndrome[CW_BITS];                  // syndrome of each single-bit error
+    uint32_t byteSyndrome[CW_SIZE][TABLE_SIZE];     // syndrome of each byte error at each byte position
+} SyndromeTable;
+
+extern SyndromeTable synTable;  // syndrome tables for GEN_POLY
+
+void genSyndromeTable(SyndromeTable *table, uint32_t poly);
+uint32_t getSyndrome(const SyndromeTable *table, const uint8_t *error, size_t byteLen);
+uint32_t getSyndromeSparse(const SyndromeTable *table, const uint8_t *error, size_t byteLen);
+
+#endif